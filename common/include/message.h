@@ -46,6 +46,34 @@ enum class MessageType {
     MERCHANT_SET_DISCOUNT_REQUEST = 42,
     MERCHANT_SET_DISCOUNT_RESPONSE = 43,
 
+    // 商品筛选（按现价区间 / 可售库存，只返回商品ID）
+    PRODUCT_FILTER_REQUEST = 44,
+    PRODUCT_FILTER_RESPONSE = 45,
+
+    // 商品名称前缀补全（按成交热度排序）
+    PRODUCT_SUGGEST_REQUEST = 70,
+    PRODUCT_SUGGEST_RESPONSE = 71,
+
+    // 商家批量导入商品（数据为 CSV 文本，每行 类型,名称,原价,库存[,折扣]）
+    MERCHANT_IMPORT_PRODUCTS_REQUEST = 46,
+    MERCHANT_IMPORT_PRODUCTS_RESPONSE = 47,
+
+    // 商家批量修改商品（每项 商品ID;原价;库存;折扣，项之间以 | 分隔，-1 表示不修改）
+    MERCHANT_BATCH_MODIFY_REQUEST = 48,
+    MERCHANT_BATCH_MODIFY_RESPONSE = 49,
+
+    // 商家定时折扣（商品类型或 商品ID;商品ID;...|折扣|开始时间|结束时间，时间为 Unix 秒，+N 表示 N 秒后）
+    MERCHANT_SCHEDULE_DISCOUNT_REQUEST = 72,
+    MERCHANT_SCHEDULE_DISCOUNT_RESPONSE = 73,
+
+    // 商家批量下架商品（商品ID;商品ID;...）
+    MERCHANT_DELIST_PRODUCTS_REQUEST = 74,
+    MERCHANT_DELIST_PRODUCTS_RESPONSE = 75,
+
+    // 商家替换商品（商品ID|类型|名称|原价|库存|折扣，商品ID不变）
+    MERCHANT_REPLACE_PRODUCT_REQUEST = 76,
+    MERCHANT_REPLACE_PRODUCT_RESPONSE = 77,
+
     // 购物车相关
     CART_ADD_ITEM_REQUEST = 50,
     CART_ADD_ITEM_RESPONSE = 51,
@@ -73,8 +101,20 @@ enum class MessageType {
     ERROR_RESPONSE = 101
 };
 
+// 商品排序方式（商品列表/搜索请求中以整数传输）
+enum class ProductSortKey {
+    DEFAULT = 0,        // 上架顺序
+    PRICE_ASC = 1,      // 现价从低到高
+    PRICE_DESC = 2,     // 现价从高到低（同价时新商品在前）
+    DISCOUNT = 3,       // 折扣力度从大到小
+    NEWEST = 4          // 最新上架优先
+};
+
 // 网络消息结构
 struct NetworkMessage {
+    static const int HEADER_SIZE = 8;                       // 类型(4字节) + 数据长度(4字节)
+    static const int MAX_DATA_LENGTH = 64 * 1024 * 1024;    // 单条消息数据上限，超过视为非法连接
+
     MessageType type;
     int length;
     std::string data;
@@ -0,0 +1,62 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+/**
+ * @brief 金额（以分为单位的定点数）
+ * 内部只有一个 int64 的分值：加减、乘以数量、比较都是精确的整数运算，
+ * 只有乘以折扣时按四舍五入取整到分。文本格式固定为 "元.分"（如 "12.30"），
+ * 解析和格式化直接处理十进制数字，不经过浮点数。
+ */
+class Money {
+public:
+    constexpr Money() : cents(0) {}
+
+    static constexpr Money fromCents(int64_t cents) { return Money(cents); }
+    // 旧文件和旧协议中的浮点金额，四舍五入到分（只用于迁移）
+    static Money fromYuan(double yuan) { return Money(roundCents(yuan * 100.0)); }
+
+    // 解析 "12"、"12.3"、"-0.05" 这样的文本，最多两位小数；格式错误或超出范围时返回false
+    static bool parse(const std::string& text, Money& value);
+    // 先按 parse 解析，失败时再按浮点数解析后取整（读取旧版本写出的订单等文本），都失败返回false
+    static bool parseLenient(const std::string& text, Money& value);
+
+    // 以分为单位的浮点值四舍五入（远离零）到整分
+    static constexpr int64_t roundCents(double cents) {
+        return cents >= 0.0 ? static_cast<int64_t>(cents + 0.5) : -static_cast<int64_t>(0.5 - cents);
+    }
+
+    constexpr int64_t getCents() const { return cents; }
+    // 只用于显示比例等非记账场合
+    double toYuan() const { return static_cast<double>(cents) / 100.0; }
+    std::string toString() const;
+
+    // 乘以折扣等系数后四舍五入到分
+    constexpr Money scaled(double factor) const { return Money(roundCents(static_cast<double>(cents) * factor)); }
+
+    constexpr Money operator+(Money other) const { return Money(cents + other.cents); }
+    constexpr Money operator-(Money other) const { return Money(cents - other.cents); }
+    constexpr Money operator-() const { return Money(-cents); }
+    constexpr Money operator*(int64_t quantity) const { return Money(cents * quantity); }
+    Money& operator+=(Money other) { cents += other.cents; return *this; }
+    Money& operator-=(Money other) { cents -= other.cents; return *this; }
+
+    constexpr bool operator==(Money other) const { return cents == other.cents; }
+    constexpr bool operator!=(Money other) const { return cents != other.cents; }
+    constexpr bool operator<(Money other) const { return cents < other.cents; }
+    constexpr bool operator<=(Money other) const { return cents <= other.cents; }
+    constexpr bool operator>(Money other) const { return cents > other.cents; }
+    constexpr bool operator>=(Money other) const { return cents >= other.cents; }
+
+private:
+    explicit constexpr Money(int64_t cents) : cents(cents) {}
+
+    int64_t cents;
+};
+
+std::ostream& operator<<(std::ostream& out, Money amount);
+
+#endif
\ No newline at end of file
@@ -4,148 +4,212 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <cstdint>
+#include <atomic>
+#include "symbol_table.h"
+#include "money.h"
+
+// 商品类别标签，数值同时作为持久化的类别编号（0-食品 1-书籍 2-衣服）
+enum class ProductCategory : uint8_t {
+    FOOD = 0,
+    BOOK = 1,
+    CLOTHING = 2
+};
+
+/**
+ * @brief 类别定价策略
+ * 现价 = 原价 * 折扣 * priceFactor，四舍五入到分。定价规则在编译期按类别标签查表，
+ * 不再经过虚函数，批量计算时可以内联和向量化。
+ * 新增类别：在 ProductCategory 中加标签，并在 CATEGORY_POLICIES 对应位置加一行。
+ */
+struct CategoryPolicy {
+    const char* typeName;
+    double priceFactor;         // 品类附加系数，1.0 表示没有额外规则
+};
+
+inline constexpr CategoryPolicy CATEGORY_POLICIES[] = {
+    { "食品", 1.0 },           // FOOD
+    { "书籍", 1.0 },           // BOOK
+    { "衣服", 1.0 },           // CLOTHING
+};
+
+inline constexpr size_t CATEGORY_COUNT = sizeof(CATEGORY_POLICIES) / sizeof(CATEGORY_POLICIES[0]);
+
+constexpr const CategoryPolicy& categoryPolicy(ProductCategory category) {
+    return CATEGORY_POLICIES[static_cast<size_t>(category)];
+}
+
+// 按类别计算现价（分），先乘折扣再乘类别系数，与 ProductFilter 的向量化实现逐位一致
+constexpr Money categoryPrice(ProductCategory category, Money price, double discount) {
+    return Money::fromCents(Money::roundCents(
+        static_cast<double>(price.getCents()) * discount * categoryPolicy(category).priceFactor));
+}
+
+// 持久化记录中原价的编码：当前为 int64 分，更早版本的文件为 double 元
+enum class PriceEncoding : uint8_t {
+    CENTS,
+    LEGACY_YUAN
+};
+
+// 按类别名称查找标签，未知类别返回false
+bool categoryFromName(const std::string& typeName, ProductCategory& category);
+
+// 类别折扣与商品自身折扣的组合方式（数值用于持久化）
+enum class DiscountComposition : uint8_t {
+    MULTIPLY = 0,   // 叠加：商品折扣 * 类别折扣
+    MIN = 1         // 取低：商品折扣与类别折扣中较低的一个
+};
+
+/**
+ * @brief 运行时的类别折扣
+ * 全类别打折只修改这里的一项，读取现价时再与商品自身的折扣组合，不再逐个修改该类别的商品。
+ * 两种组合方式统一为 有效折扣 = min(商品折扣 * scale, cap)：
+ * 叠加时 scale = 类别折扣、cap = 1，取低时 scale = 1、cap = 类别折扣。
+ * 每个类别的折扣（百万分之一为单位）和组合方式打包在一个原子字中，读取不加锁。
+ */
+class CategoryDiscounts {
+public:
+    static void set(ProductCategory category, double discount, DiscountComposition composition);
+    static double getDiscount(ProductCategory category);
+    static DiscountComposition getComposition(ProductCategory category);
+
+    static void getTerms(ProductCategory category, double& scale, double& cap);
+    static double effectiveDiscount(ProductCategory category, double productDiscount) {
+        double scale, cap;
+        getTerms(category, scale, cap);
+        double discount = productDiscount * scale;
+        return discount < cap ? discount : cap;
+    }
+
+private:
+    static std::atomic<uint64_t>& entry(ProductCategory category);
+};
 
 /**
- * @brief Ʒࣩࣨ
- * ƷĻϢơ۸񡢿桢̼ҡۿ
+ * @brief 商品基类
+ * 包含商品的基本信息：名称、价格、库存、商家、折扣
+ * 具体类别由子类构造时传入的 ProductCategory 决定
  */
 class Product {
 protected:
     int productId;
     std::string name;
-    double price;              // ԭ
-    int stock;
-    std::string merchantName;
-    double discount;           // ۿ
-    int frozenStock;           // 棨ΪԤ
+    // 原价和折扣可能在读者不加锁持有商品对象（ProductRef）时被修改，因此都是原子变量。
+    // 修改方持有 productsMutex 依次写入，读者分别读取两个字段，看到的总是某个先后写入之间的状态
+    std::atomic<Money> price;  // 原价
+    uint32_t merchantId;       // 商家名在 SymbolTable::merchants() 中的编号
+    ProductCategory category;
+    std::atomic<double> discount; // 折扣
+    // 库存(高32位)与冻结库存(低32位)打包在一个原子字中，用CAS整体更新，
+    // 不同商品的扣减互不加锁，同一商品的并发扣减也不会超卖
+    std::atomic<uint64_t> stockState;
+
+    static uint64_t packStock(int stock, int frozenStock) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(stock)) << 32) | static_cast<uint32_t>(frozenStock);
+    }
+    static int unpackStock(uint64_t state) { return static_cast<int32_t>(state >> 32); }
+    static int unpackFrozen(uint64_t state) { return static_cast<int32_t>(state & 0xFFFFFFFFu); }
 
-public:
     /**
-     * @brief Ʒ๹캯
-     * @param id ƷID
-     * @param name Ʒ
-     * @param price Ʒ۸
-     * @param stock Ʒ
-     * @param merchant ̼
-     * @param discount ۿۣĬ1.0ۿۣ
+     * @brief 商品基类构造函数（只供子类调用）
+     * @param category 商品类别
+     * @param id 商品ID
+     * @param name 商品名称
+     * @param price 商品价格
+     * @param stock 商品库存
+     * @param merchant 出售商家
+     * @param discount 折扣（默认1.0无折扣）
      */
-    Product(int id, const std::string& name, double price, int stock,
+    Product(ProductCategory category, int id, const std::string& name, Money price, int stock,
         const std::string& merchant, double discount = 1.0);
 
+public:
     virtual ~Product() = default;
 
-    // Getter
+    // Getter方法
     int getProductId() const { return productId; }
-    std::string getName() const { return name; }
-    double getOriginalPrice() const { return price; }  // ȡԭ
-    virtual double getPrice() const;                   // ȡּۣۿۣ
-    int getStock() const { return stock; }
-    std::string getMerchantName() const { return merchantName; }
-    double getDiscount() const { return discount; }
-    int getFrozenStock() const { return frozenStock; } // ȡ
-    virtual std::string getProductType() const = 0;
-
-    // Setter
-    void setPrice(double newPrice) { price = newPrice; }
-    void setStock(int newStock) { stock = newStock; }
+    const std::string& getName() const { return name; }
+    Money getOriginalPrice() const { return price.load(); }  // 获取原价
+    Money getPrice() const { return categoryPrice(category, price.load(), getEffectiveDiscount()); }  // 获取现价（考虑折扣）
+    int getStock() const { return unpackStock(stockState.load()); }
+    const std::string& getMerchantName() const { return SymbolTable::merchants().lookup(merchantId); }
+    uint32_t getMerchantId() const { return merchantId; }
+    double getDiscount() const { return discount.load(); }     // 商品自身的折扣
+    // 与类别折扣组合后实际生效的折扣
+    double getEffectiveDiscount() const { return CategoryDiscounts::effectiveDiscount(category, discount.load()); }
+    int getFrozenStock() const { return unpackFrozen(stockState.load()); } // 获取冻结库存
+    ProductCategory getCategory() const { return category; }
+    const std::string& getProductType() const;
+
+    // Setter方法
+    void setPrice(Money newPrice);
+    void setStock(int newStock);
+    void setFrozenStock(int newFrozenStock);
     void setDiscount(double newDiscount);
 
-    // 
+    // 库存管理（均为无锁的CAS操作，可在不持有任何锁时调用）
     bool reduceStock(int quantity);
     bool increaseStock(int quantity);
 
-    // ΪԤ
+    // 冻结库存管理（为订单管理预留）
     bool freezeStock(int quantity);
     bool unfreezeStock(int quantity);
 
-    // л
+    // 序列化方法
     virtual void serialize(std::ofstream& out) const;
-    virtual void deserialize(std::ifstream& in);
+    // 旧版本日志中的原价为 double，按 encoding 读取后换算成分
+    virtual void deserialize(std::ifstream& in, PriceEncoding encoding = PriceEncoding::CENTS);
+    // 按 serialize 相同的布局追加到内存缓冲区（用于快照容器）
+    void appendRecord(std::string& out) const;
 
-    // ʽʾ
+    // 格式化显示
     std::string toString() const;
     std::string toDetailString() const;
 
-    // Ϊ׹ԤǷɹָ
+    // 为交易功能预留：检查是否可购买指定数量
     bool isAvailable(int quantity) const;
 
-    // Ƿۿ
-    bool hasDiscount() const { return discount < 1.0; }
+    // 检查是否有折扣
+    bool hasDiscount() const { return getEffectiveDiscount() < 1.0; }
 };
 
 /**
- * @brief ʳƷ
- * ̳Product
+ * @brief 食品类
+ * 继承自Product基类
  */
 class Food : public Product {
 public:
     /**
-     * @brief ʳƷ๹캯
+     * @brief 食品类构造函数
      */
-    Food(int id, const std::string& name, double price, int stock,
+    Food(int id, const std::string& name, Money price, int stock,
         const std::string& merchant, double discount = 1.0);
-
-    /**
-     * @brief ʵִ麯 - Ʒ
-     * @return "ʳƷ"
-     */
-    std::string getProductType() const override { return "ʳƷ"; }
-
-    /**
-     * @brief д۸㣨ʳƷۿ۹
-     * @return ʵʼ۸
-     */
-    double getPrice() const override;
 };
 
 /**
- * @brief 鼮
- * ̳Product
+ * @brief 书籍类
+ * 继承自Product基类
  */
 class Book : public Product {
 public:
     /**
-     * @brief 鼮๹캯
+     * @brief 书籍类构造函数
      */
-    Book(int id, const std::string& name, double price, int stock,
+    Book(int id, const std::string& name, Money price, int stock,
         const std::string& merchant, double discount = 1.0);
-
-    /**
-     * @brief ʵִ麯 - Ʒ
-     * @return "鼮"
-     */
-    std::string getProductType() const override { return "鼮"; }
-
-    /**
-     * @brief д۸㣨鼮нۿ۵ȣ
-     * @return ʵʼ۸
-     */
-    double getPrice() const override;
 };
 
 /**
- * @brief ·
- * ̳Product
+ * @brief 衣服类
+ * 继承自Product基类
  */
 class Clothing : public Product {
 public:
     /**
-     * @brief ·๹캯
+     * @brief 衣服类构造函数
      */
-    Clothing(int id, const std::string& name, double price, int stock,
+    Clothing(int id, const std::string& name, Money price, int stock,
         const std::string& merchant, double discount = 1.0);
-
-    /**
-     * @brief ʵִ麯 - Ʒ
-     * @return "·"
-     */
-    std::string getProductType() const override { return "·"; }
-
-    /**
-     * @brief д۸㣨·мۿ۵ȣ
-     * @return ʵʼ۸
-     */
-    double getPrice() const override;
 };
 
 #endif
\ No newline at end of file
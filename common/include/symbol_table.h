@@ -0,0 +1,44 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 字符串驻留表
+ * 相同的字符串只保存一份，对外用从0开始的整数编号表示。
+ * 编号一经分配不会改变，lookup 返回的引用在进程生命周期内一直有效。
+ * 字符串按编号存放在定长分块中，只追加不移动：写入方持锁写好字符串后再发布 count，
+ * lookup 只读 count 和分块，不加锁。
+ */
+class SymbolTable {
+private:
+    static const uint32_t CHUNK_BITS = 10;
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;   // 每块 1024 个字符串
+    static const uint32_t MAX_CHUNKS = 16384;              // 最多约 1600 万个字符串
+
+    std::unique_ptr<std::string[]> chunks[MAX_CHUNKS];     // 分块一旦分配就不再释放或移动
+    std::atomic<uint32_t> count{ 0 };                       // 已发布的字符串数，release 写 / acquire 读
+    std::unordered_map<std::string, uint32_t> ids;
+    mutable std::mutex tableMutex;                          // 只保护 intern 和 find
+
+public:
+    // 取得字符串的编号，不存在则新分配
+    uint32_t intern(const std::string& value);
+
+    // 只查找不分配，找到返回true
+    bool find(const std::string& value, uint32_t& id) const;
+
+    // 无锁读取
+    const std::string& lookup(uint32_t id) const;
+    size_t size() const;
+
+    // 全局的商家名表
+    static SymbolTable& merchants();
+};
+
+#endif
\ No newline at end of file
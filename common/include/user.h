@@ -4,77 +4,84 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include "money.h"
 
-// ûö
+// 用户类型枚举
 enum class UserType {
-    CONSUMER = 1,  // 
-    MERCHANT = 2   // ̼
+    CONSUMER = 1,  // 消费者
+    MERCHANT = 2   // 商家
 };
 
-// û
+// 抽象用户基类
 class User {
 protected:
-    std::string username;     // û
-    std::string password;     // 
-    double balance;          // ˻
-    UserType userType;       // û
+    std::string username;     // 用户名
+    std::string password;     // 密码
+    Money balance;           // 账户余额
+    UserType userType;       // 用户类型
 
 public:
-    // 캯
+    // 构造函数
     User(const std::string& username, const std::string& password, UserType type)
-        : username(username), password(password), balance(0.0), userType(type) {}
+        : username(username), password(password), balance(), userType(type) {}
 
-    // 
+    // 虚析构函数
     virtual ~User() = default;
 
-    // 
+    // 基本功能
     const std::string& getUsername() const { return username; }
     bool verifyPassword(const std::string& pwd) const { return password == pwd; }
-    double getBalance() const { return balance; }
-    void setBalance(double newBalance) { balance = newBalance; }
+    Money getBalance() const { return balance; }
+    void setBalance(Money newBalance) { balance = newBalance; }
     UserType getUserType() const { return userType; }
 
-    // 
+    // 密码管理
     bool changePassword(const std::string& oldPassword, const std::string& newPassword);
     void setPassword(const std::string& newPassword) { password = newPassword; }
 
-    // 麯
+    // 虚函数
     virtual void displayInfo() const = 0;
     virtual bool canSell() const = 0;
     virtual bool canBuy() const = 0;
 
-    // л - ʹöļ
+    // 序列化方法 - 使用二进制文件流（旧格式，长度为 size_t，只用于读取旧文件）
     void serialize(std::ofstream& out) const;
     void deserialize(std::ifstream& in);
 
-    // ̬
+    // 快照记录：类型(int32) | 用户名长度(uint32)+内容 | 密码长度(uint32)+内容 | 余额(int64 分)
+    void appendRecord(std::string& out) const;
+    // 从 [data, end) 解析一条记录并把 data 移到记录之后；格式错误时抛出 std::runtime_error。
+    // legacyBalance 为 true 时按第1版记录读取 double 元的余额并换算成分
+    static User* readRecord(const char*& data, const char* end, bool legacyBalance = false);
+
+    // 静态工厂方法
     static User* createUser(const std::string& username, const std::string& password, UserType type);
 };
 
-// 
+// 消费者类
 class Consumer : public User {
 public:
     Consumer(const std::string& username, const std::string& password)
         : User(username, password, UserType::CONSUMER) {}
 
-    // ʵִ麯
+    // 实现纯虚函数
     void displayInfo() const override {
-        std::cout << "û: \nû: " << username << "\n: " << balance << std::endl;
+        std::cout << "用户类型: 消费者\n用户名: " << username << "\n余额: " << balance << std::endl;
     }
 
     bool canSell() const override { return false; }
     bool canBuy() const override { return true; }
 };
 
-// ̼
+// 商家类
 class Merchant : public User {
 public:
     Merchant(const std::string& username, const std::string& password)
         : User(username, password, UserType::MERCHANT) {}
 
-    // ʵִ麯
+    // 实现纯虚函数
     void displayInfo() const override {
-        std::cout << "û: ̼\nû: " << username << "\n: " << balance << std::endl;
+        std::cout << "用户类型: 商家\n用户名: " << username << "\n余额: " << balance << std::endl;
     }
 
     bool canSell() const override { return true; }
@@ -4,32 +4,33 @@
 #define NOMINMAX
 #include <string>
 #include <limits>
+#include "money.h"
 
-// Windowsרùߺ
+// Windows专用工具函数
 class Utils {
 public:
-    // 
+    // 清屏函数
     static void clearScreen();
 
-    // ͣȴû
+    // 暂停等待用户输入
     static void pauseScreen();
 
-    // ʾָ
+    // 显示分隔线
     static void showSeparator(const std::string& title = "");
 
-    // ʽ
-    static std::string formatMoney(double amount);
+    // 格式化输出金额
+    static std::string formatMoney(Money amount);
 
-    // ȡû루ʾ
+    // 获取用户输入（带提示）
     static std::string getInput(const std::string& prompt);
 
-    // ʾɹϢ
+    // 显示成功消息
     static void showSuccess(const std::string& message);
 
-    // ʾϢ
+    // 显示错误消息
     static void showError(const std::string& message);
 
-    // ʾϢϢ
+    // 显示信息消息
     static void showInfo(const std::string& message);
 };
 
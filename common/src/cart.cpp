@@ -6,8 +6,7 @@
 std::string CartItem::serialize() const {
     std::ostringstream oss;
     oss << productId << ";" << productName << ";" << productType << ";"
-        << std::fixed << std::setprecision(2) << originalPrice << ";"
-        << std::fixed << std::setprecision(2) << currentPrice << ";"
+        << originalPrice << ";" << currentPrice << ";"
         << quantity << ";" << merchantName << ";"
         << std::fixed << std::setprecision(2) << discount;
     return oss.str();
@@ -27,17 +26,22 @@ CartItem CartItem::deserialize(const std::string& data) {
         std::getline(iss, discountStr)) {
 
         try {
+            // 金额按 "元.分" 文本精确解析，与旧版本 setprecision(2) 写出的格式相同
+            Money originalPrice, currentPrice;
+            if (!Money::parse(origPriceStr, originalPrice) || !Money::parse(currPriceStr, currentPrice)) {
+                return CartItem();
+            }
             return CartItem(std::stoi(idStr), name, type,
-                std::stod(origPriceStr), std::stod(currPriceStr),
+                originalPrice, currentPrice,
                 std::stoi(qtyStr), merchant, std::stod(discountStr));
         }
         catch (const std::exception& e) {
-            // תʧܣؿյCartItem
+            // 转换失败，返回空的CartItem
             return CartItem();
         }
     }
 
-    return CartItem(); // ؿյCartItem
+    return CartItem(); // 返回空的CartItem
 }
 
 bool Cart::addItem(const CartItem& item) {
@@ -47,11 +51,11 @@ bool Cart::addItem(const CartItem& item) {
 
     auto it = items.find(item.productId);
     if (it != items.end()) {
-        // ƷѴڣ
+        // 商品已存在，增加数量
         it->second.quantity += item.quantity;
     }
     else {
-        // Ʒֱ
+        // 新商品，直接添加
         items[item.productId] = item;
     }
 
@@ -104,8 +108,8 @@ int Cart::getTotalItemCount() const {
     return total;
 }
 
-double Cart::getTotalPrice() const {
-    double total = 0.0;
+Money Cart::getTotalPrice() const {
+    Money total;
     for (const auto& pair : items) {
         total += pair.second.getTotalPrice();
     }
@@ -132,7 +136,7 @@ Cart Cart::deserialize(const std::string& data) {
     std::string username, countStr;
 
     if (!std::getline(iss, username, '|') || !std::getline(iss, countStr, '|')) {
-        return Cart(); // ؿչﳵ
+        return Cart(); // 返回空购物车
     }
 
     Cart cart(username);
@@ -151,7 +155,7 @@ Cart Cart::deserialize(const std::string& data) {
         }
     }
     catch (const std::exception& e) {
-        // ʧܣؿչﳵ
+        // 解析失败，返回空购物车
         return Cart(username);
     }
 
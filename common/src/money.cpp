@@ -0,0 +1,91 @@
+#include "money.h"
+#include <cstdlib>
+
+namespace {
+
+// 整数部分最多的位数，保证换算成分之后不会溢出 int64
+const size_t MAX_INTEGER_DIGITS = 15;
+
+}
+
+bool Money::parse(const std::string& text, Money& value) {
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+        negative = text[pos] == '-';
+        pos++;
+    }
+
+    int64_t yuan = 0;
+    size_t integerDigits = 0;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        if (++integerDigits > MAX_INTEGER_DIGITS) {
+            return false;
+        }
+        yuan = yuan * 10 + (text[pos] - '0');
+        pos++;
+    }
+
+    int64_t fraction = 0;
+    size_t fractionDigits = 0;
+    if (pos < text.size() && text[pos] == '.') {
+        pos++;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            if (++fractionDigits > 2) {
+                return false;
+            }
+            fraction = fraction * 10 + (text[pos] - '0');
+            pos++;
+        }
+    }
+    if (pos != text.size() || integerDigits + fractionDigits == 0) {
+        return false;
+    }
+    if (fractionDigits == 1) {
+        fraction *= 10;
+    }
+
+    int64_t cents = yuan * 100 + fraction;
+    value = Money(negative ? -cents : cents);
+    return true;
+}
+
+bool Money::parseLenient(const std::string& text, Money& value) {
+    if (parse(text, value)) {
+        return true;
+    }
+    // 旧版本按默认精度输出 double，可能是 "12.345" 或 "1.23457e+06"
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    double yuan = std::strtod(begin, &end);
+    if (end == begin || *end != '\0' || !(yuan > -1e13 && yuan < 1e13)) {
+        return false;
+    }
+    value = fromYuan(yuan);
+    return true;
+}
+
+std::string Money::toString() const {
+    // 从低位往高位填数字，至少保留 "0.00"
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    uint64_t magnitude = cents < 0 ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+    *--p = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+    *--p = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+    *--p = '.';
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (cents < 0) {
+        *--p = '-';
+    }
+    return std::string(p, end);
+}
+
+std::ostream& operator<<(std::ostream& out, Money amount) {
+    return out << amount.toString();
+}
\ No newline at end of file
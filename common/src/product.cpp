@@ -1,41 +1,147 @@
 #include "product.h"
 #include <sstream>
-#include <iomanip>
 #include <stdexcept>
 
-// ==================== Productʵ ====================
+// ==================== 类别定价策略 ====================
 
-Product::Product(int id, const std::string& name, double price, int stock,
+namespace {
+
+// 与 CATEGORY_POLICIES 一一对应的类别名称，getProductType 直接返回其引用
+const std::string& categoryName(ProductCategory category) {
+    static const std::string names[] = {
+        CATEGORY_POLICIES[0].typeName,
+        CATEGORY_POLICIES[1].typeName,
+        CATEGORY_POLICIES[2].typeName,
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == CATEGORY_COUNT, "类别名称表与定价策略表不一致");
+    return names[static_cast<size_t>(category)];
+}
+
+}
+
+bool categoryFromName(const std::string& typeName, ProductCategory& category) {
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i) {
+        if (typeName == CATEGORY_POLICIES[i].typeName) {
+            category = static_cast<ProductCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ==================== 类别折扣 ====================
+
+namespace {
+
+const double DISCOUNT_UNITS = 1000000.0;
+
+uint64_t packCategoryDiscount(double discount, DiscountComposition composition) {
+    uint64_t units = static_cast<uint64_t>(discount * DISCOUNT_UNITS + 0.5);
+    return (static_cast<uint64_t>(composition) << 32) | units;
+}
+
+}
+
+std::atomic<uint64_t>& CategoryDiscounts::entry(ProductCategory category) {
+    // 默认无类别折扣：叠加 1.0
+    static std::atomic<uint64_t> entries[CATEGORY_COUNT] = {
+        { packCategoryDiscount(1.0, DiscountComposition::MULTIPLY) },
+        { packCategoryDiscount(1.0, DiscountComposition::MULTIPLY) },
+        { packCategoryDiscount(1.0, DiscountComposition::MULTIPLY) },
+    };
+    static_assert(sizeof(entries) / sizeof(entries[0]) == CATEGORY_COUNT, "类别折扣表与定价策略表不一致");
+    return entries[static_cast<size_t>(category)];
+}
+
+void CategoryDiscounts::set(ProductCategory category, double discount, DiscountComposition composition) {
+    if (discount <= 0.0 || discount > 1.0) {
+        throw std::invalid_argument("折扣必须在0.0到1.0之间");
+    }
+    entry(category).store(packCategoryDiscount(discount, composition), std::memory_order_release);
+}
+
+double CategoryDiscounts::getDiscount(ProductCategory category) {
+    uint64_t value = entry(category).load(std::memory_order_acquire);
+    return static_cast<double>(value & 0xFFFFFFFFu) / DISCOUNT_UNITS;
+}
+
+DiscountComposition CategoryDiscounts::getComposition(ProductCategory category) {
+    uint64_t value = entry(category).load(std::memory_order_acquire);
+    return static_cast<DiscountComposition>((value >> 32) & 0xFF);
+}
+
+void CategoryDiscounts::getTerms(ProductCategory category, double& scale, double& cap) {
+    uint64_t value = entry(category).load(std::memory_order_acquire);
+    double discount = static_cast<double>(value & 0xFFFFFFFFu) / DISCOUNT_UNITS;
+    if (static_cast<DiscountComposition>((value >> 32) & 0xFF) == DiscountComposition::MIN) {
+        scale = 1.0;
+        cap = discount;
+    }
+    else {
+        scale = discount;
+        cap = 1.0;
+    }
+}
+
+// ==================== Product基类实现 ====================
+
+Product::Product(ProductCategory category, int id, const std::string& name, Money price, int stock,
     const std::string& merchant, double discount)
-    : productId(id), name(name), price(price), stock(stock),
-    merchantName(merchant), discount(discount), frozenStock(0) {
-    if (price < 0) {
-        throw std::invalid_argument("Ʒ۸Ϊ");
+    : productId(id), name(name), price(price),
+    merchantId(SymbolTable::merchants().intern(merchant)), category(category),
+    discount(discount), stockState(packStock(stock, 0)) {
+    if (price < Money()) {
+        throw std::invalid_argument("商品价格不能为负数");
     }
     if (stock < 0) {
-        throw std::invalid_argument("Ʒ治Ϊ");
+        throw std::invalid_argument("商品库存不能为负数");
     }
     if (discount < 0.0 || discount > 1.0) {
-        throw std::invalid_argument("ۿ۱0.01.0֮");
+        throw std::invalid_argument("折扣必须在0.0到1.0之间");
     }
 }
 
-double Product::getPrice() const {
-    return price * discount;
+const std::string& Product::getProductType() const {
+    return categoryName(category);
+}
+
+void Product::setPrice(Money newPrice) {
+    if (newPrice < Money()) {
+        throw std::invalid_argument("商品价格不能为负数");
+    }
+    price.store(newPrice);
 }
 
 void Product::setDiscount(double newDiscount) {
     if (newDiscount < 0.0 || newDiscount > 1.0) {
-        throw std::invalid_argument("ۿ۱0.01.0֮");
+        throw std::invalid_argument("折扣必须在0.0到1.0之间");
+    }
+    discount.store(newDiscount);
+}
+
+void Product::setStock(int newStock) {
+    uint64_t state = stockState.load();
+    while (!stockState.compare_exchange_weak(state, packStock(newStock, unpackFrozen(state)))) {
+    }
+}
+
+void Product::setFrozenStock(int newFrozenStock) {
+    uint64_t state = stockState.load();
+    while (!stockState.compare_exchange_weak(state, packStock(unpackStock(state), newFrozenStock))) {
     }
-    discount = newDiscount;
 }
 
 bool Product::reduceStock(int quantity) {
-    if (quantity <= 0 || quantity > (stock - frozenStock)) {
+    if (quantity <= 0) {
         return false;
     }
-    stock -= quantity;
+    // CAS失败时 state 会被更新为最新值，重新检查可售库存
+    uint64_t state = stockState.load();
+    do {
+        if (quantity > unpackStock(state) - unpackFrozen(state)) {
+            return false;
+        }
+    } while (!stockState.compare_exchange_weak(state, packStock(unpackStock(state) - quantity, unpackFrozen(state))));
     return true;
 }
 
@@ -43,83 +149,129 @@ bool Product::increaseStock(int quantity) {
     if (quantity <= 0) {
         return false;
     }
-    stock += quantity;
+    uint64_t state = stockState.load();
+    while (!stockState.compare_exchange_weak(state, packStock(unpackStock(state) + quantity, unpackFrozen(state)))) {
+    }
     return true;
 }
 
 bool Product::isAvailable(int quantity) const {
-    return quantity > 0 && quantity <= (stock - frozenStock);
+    uint64_t state = stockState.load();
+    return quantity > 0 && quantity <= (unpackStock(state) - unpackFrozen(state));
 }
 
 bool Product::freezeStock(int quantity) {
-    if (quantity <= 0 || quantity > (stock - frozenStock)) {
+    if (quantity <= 0) {
         return false;
     }
-    frozenStock += quantity;
+    uint64_t state = stockState.load();
+    do {
+        if (quantity > unpackStock(state) - unpackFrozen(state)) {
+            return false;
+        }
+    } while (!stockState.compare_exchange_weak(state, packStock(unpackStock(state), unpackFrozen(state) + quantity)));
     return true;
 }
 
 bool Product::unfreezeStock(int quantity) {
-    if (quantity <= 0 || quantity > frozenStock) {
+    if (quantity <= 0) {
         return false;
     }
-    frozenStock -= quantity;
+    uint64_t state = stockState.load();
+    do {
+        if (quantity > unpackFrozen(state)) {
+            return false;
+        }
+    } while (!stockState.compare_exchange_weak(state, packStock(unpackStock(state), unpackFrozen(state) - quantity)));
     return true;
 }
 
 void Product::serialize(std::ofstream& out) const {
     if (!out.is_open()) {
-        throw std::runtime_error("ļδ");
+        throw std::runtime_error("文件未打开");
     }
 
-    // дƷͣڷлʱȷͣ
-    std::string type = getProductType();
+    // 写入商品类型（用于反序列化时确定具体类型）
+    const std::string& type = getProductType();
     uint32_t typeLen = static_cast<uint32_t>(type.length());
     out.write(reinterpret_cast<const char*>(&typeLen), sizeof(typeLen));
     if (typeLen > 0) {
         out.write(type.c_str(), typeLen);
     }
 
-    // дƷID
+    // 写入商品ID
     out.write(reinterpret_cast<const char*>(&productId), sizeof(productId));
 
-    // дƷ
+    // 写入商品名称
     uint32_t nameLen = static_cast<uint32_t>(name.length());
     out.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
     if (nameLen > 0) {
         out.write(name.c_str(), nameLen);
     }
 
-    // дƷ۸ԭۣ
-    out.write(reinterpret_cast<const char*>(&price), sizeof(price));
+    // 写入商品价格（原价，int64 分）
+    int64_t priceCents = price.load().getCents();
+    out.write(reinterpret_cast<const char*>(&priceCents), sizeof(priceCents));
 
-    // дƷ
+    // 写入商品库存（库存与冻结库存取同一时刻的快照）
+    uint64_t state = stockState.load();
+    int stock = unpackStock(state);
+    int frozenStock = unpackFrozen(state);
     out.write(reinterpret_cast<const char*>(&stock), sizeof(stock));
 
-    // д̼
+    // 写入出售商家
+    const std::string& merchantName = getMerchantName();
     uint32_t merchantLen = static_cast<uint32_t>(merchantName.length());
     out.write(reinterpret_cast<const char*>(&merchantLen), sizeof(merchantLen));
     if (merchantLen > 0) {
         out.write(merchantName.c_str(), merchantLen);
     }
 
-    // дۿ
-    out.write(reinterpret_cast<const char*>(&discount), sizeof(discount));
+    // 写入折扣
+    double discountValue = discount.load();
+    out.write(reinterpret_cast<const char*>(&discountValue), sizeof(discountValue));
 
-    // д붳棨ֶΣ
+    // 写入冻结库存（额外字段）
     out.write(reinterpret_cast<const char*>(&frozenStock), sizeof(frozenStock));
 }
 
-void Product::deserialize(std::ifstream& in) {
+namespace {
+
+template <typename T>
+void appendValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendText(std::string& out, const std::string& value) {
+    appendValue(out, static_cast<uint32_t>(value.length()));
+    out.append(value);
+}
+
+}
+
+void Product::appendRecord(std::string& out) const {
+    appendText(out, getProductType());
+    appendValue(out, productId);
+    appendText(out, name);
+    appendValue(out, price.load().getCents());
+    // 库存与冻结库存取同一时刻的快照
+    uint64_t state = stockState.load();
+    appendValue(out, unpackStock(state));
+    appendText(out, getMerchantName());
+    appendValue(out, discount.load());
+    appendValue(out, unpackFrozen(state));
+}
+
+void Product::deserialize(std::ifstream& in, PriceEncoding encoding) {
     if (!in.is_open()) {
-        throw std::runtime_error("ļδ");
+        throw std::runtime_error("文件未打开");
     }
 
-    // ȡƷ
+    // 读取商品类型
     uint32_t typeLen;
     in.read(reinterpret_cast<char*>(&typeLen), sizeof(typeLen));
     if (in.fail() || typeLen > 1000) {
-        throw std::runtime_error("ȡƷͳʧܻ򳤶쳣: " + std::to_string(typeLen));
+        throw std::runtime_error("读取商品类型长度失败或长度异常: " + std::to_string(typeLen));
     }
 
     std::string type;
@@ -127,145 +279,142 @@ void Product::deserialize(std::ifstream& in) {
         type.resize(typeLen);
         in.read(&type[0], typeLen);
         if (in.fail()) {
-            throw std::runtime_error("ȡƷʧ");
+            throw std::runtime_error("读取商品类型失败");
         }
     }
 
-    // ȡƷID
+    // 读取商品ID
     in.read(reinterpret_cast<char*>(&productId), sizeof(productId));
     if (in.fail()) {
-        throw std::runtime_error("ȡƷIDʧ");
+        throw std::runtime_error("读取商品ID失败");
     }
 
-    // ȡƷ
+    // 读取商品名称
     uint32_t nameLen;
     in.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
     if (in.fail() || nameLen > 1000) {
-        throw std::runtime_error("ȡƷƳʧܻ򳤶쳣: " + std::to_string(nameLen));
+        throw std::runtime_error("读取商品名称长度失败或长度异常: " + std::to_string(nameLen));
     }
     if (nameLen > 0) {
         name.resize(nameLen);
         in.read(&name[0], nameLen);
         if (in.fail()) {
-            throw std::runtime_error("ȡƷʧ");
+            throw std::runtime_error("读取商品名称失败");
         }
     }
     else {
         name.clear();
     }
 
-    // ȡƷ۸ԭۣ
-    in.read(reinterpret_cast<char*>(&price), sizeof(price));
-    if (in.fail()) {
-        throw std::runtime_error("ȡƷ۸ʧ");
+    // 读取商品价格（原价）
+    Money originalPrice;
+    if (encoding == PriceEncoding::LEGACY_YUAN) {
+        double yuan;
+        in.read(reinterpret_cast<char*>(&yuan), sizeof(yuan));
+        originalPrice = Money::fromYuan(yuan);
+    }
+    else {
+        int64_t priceCents;
+        in.read(reinterpret_cast<char*>(&priceCents), sizeof(priceCents));
+        originalPrice = Money::fromCents(priceCents);
+    }
+    if (in.fail() || originalPrice < Money()) {
+        throw std::runtime_error("读取商品价格失败");
     }
+    price.store(originalPrice);
 
-    // ȡƷ
+    // 读取商品库存
+    int stock;
     in.read(reinterpret_cast<char*>(&stock), sizeof(stock));
     if (in.fail()) {
-        throw std::runtime_error("ȡƷʧ");
+        throw std::runtime_error("读取商品库存失败");
     }
 
-    // ȡ̼
+    // 读取出售商家
     uint32_t merchantLen;
     in.read(reinterpret_cast<char*>(&merchantLen), sizeof(merchantLen));
     if (in.fail() || merchantLen > 1000) {
-        throw std::runtime_error("ȡ̼Ƴʧܻ򳤶쳣: " + std::to_string(merchantLen));
+        throw std::runtime_error("读取商家名称长度失败或长度异常: " + std::to_string(merchantLen));
     }
+    std::string merchantName;
     if (merchantLen > 0) {
         merchantName.resize(merchantLen);
         in.read(&merchantName[0], merchantLen);
         if (in.fail()) {
-            throw std::runtime_error("ȡ̼ʧ");
+            throw std::runtime_error("读取商家名称失败");
         }
     }
-    else {
-        merchantName.clear();
-    }
+    merchantId = SymbolTable::merchants().intern(merchantName);
 
-    // ȡۿ
-    in.read(reinterpret_cast<char*>(&discount), sizeof(discount));
+    // 读取折扣
+    double discountValue;
+    in.read(reinterpret_cast<char*>(&discountValue), sizeof(discountValue));
     if (in.fail()) {
-        throw std::runtime_error("ȡƷۿʧ");
+        throw std::runtime_error("读取商品折扣失败");
     }
+    discount.store(discountValue);
 
-    // ȡ棨ֶΣ
+    // 读取冻结库存（额外字段）
+    int frozenStock;
     in.read(reinterpret_cast<char*>(&frozenStock), sizeof(frozenStock));
     if (in.fail()) {
-        throw std::runtime_error("ȡʧ");
+        throw std::runtime_error("读取冻结库存失败");
     }
+    stockState.store(packStock(stock, frozenStock));
 }
 
 std::string Product::toString() const {
     std::ostringstream oss;
     oss << "[" << productId << "] " << name
-        << " - " << std::fixed << std::setprecision(2) << getPrice() << "Ԫ";
+        << " - " << getPrice() << "元";
 
-    // ֻۿʱʾۿϢ
+    // 只在有折扣时显示折扣信息
     if (hasDiscount()) {
-        oss << " (ԭ:" << price << "Ԫ, " << static_cast<int>(discount * 100) << ")";
+        oss << " (原价:" << price.load() << "元, " << static_cast<int>(getEffectiveDiscount() * 100) << "折)";
     }
 
-    oss << " (:" << stock << ") [" << merchantName << "] {" << getProductType() << "}";
+    oss << " (库存:" << getStock() << ") [" << getMerchantName() << "] {" << getProductType() << "}";
     return oss.str();
 }
 
 std::string Product::toDetailString() const {
     std::ostringstream oss;
-    oss << "ƷID: " << productId << "\n"
-        << "Ʒ: " << name << "\n"
-        << "Ʒ: " << getProductType() << "\n";
+    oss << "商品ID: " << productId << "\n"
+        << "商品名称: " << name << "\n"
+        << "商品类型: " << getProductType() << "\n";
 
     if (hasDiscount()) {
-        oss << "ԭ: " << std::fixed << std::setprecision(2) << price << " Ԫ\n"
-            << "ۿ: " << static_cast<int>(discount * 100) << "\n"
-            << "ּ: " << getPrice() << " Ԫ\n";
+        oss << "原价: " << price.load() << " 元\n"
+            << "折扣: " << static_cast<int>(getEffectiveDiscount() * 100) << "折\n"
+            << "现价: " << getPrice() << " 元\n";
     }
     else {
-        oss << "۸: " << std::fixed << std::setprecision(2) << getPrice() << " Ԫ\n";
+        oss << "价格: " << getPrice() << " 元\n";
     }
 
-    oss << ": " << stock << "\n"
-        << "̼: " << merchantName;
+    oss << "库存数量: " << getStock() << "\n"
+        << "出售商家: " << getMerchantName();
 
     return oss.str();
 }
 
-// ==================== Foodʵ ====================
+// ==================== Food类实现 ====================
 
-Food::Food(int id, const std::string& name, double price, int stock,
+Food::Food(int id, const std::string& name, Money price, int stock,
     const std::string& merchant, double discount)
-    : Product(id, name, price, stock, merchant, discount) {
-}
-
-double Food::getPrice() const {
-    // ʳƷʵļ۸
-    // 򵥵ûʵ
-    return Product::getPrice();
+    : Product(ProductCategory::FOOD, id, name, price, stock, merchant, discount) {
 }
 
-// ==================== Bookʵ ====================
+// ==================== Book类实现 ====================
 
-Book::Book(int id, const std::string& name, double price, int stock,
+Book::Book(int id, const std::string& name, Money price, int stock,
     const std::string& merchant, double discount)
-    : Product(id, name, price, stock, merchant, discount) {
+    : Product(ProductCategory::BOOK, id, name, price, stock, merchant, discount) {
 }
 
-double Book::getPrice() const {
-    // 鼮ʵļ۸
-    // 磺鼮жۿ
-    return Product::getPrice();
-}
-
-// ==================== Clothingʵ ====================
+// ==================== Clothing类实现 ====================
 
-Clothing::Clothing(int id, const std::string& name, double price, int stock,
+Clothing::Clothing(int id, const std::string& name, Money price, int stock,
     const std::string& merchant, double discount)
-    : Product(id, name, price, stock, merchant, discount) {
-}
-
-double Clothing::getPrice() const {
-    // ·ʵļ۸
-    // 磺ۿ
-    return Product::getPrice();
+    : Product(ProductCategory::CLOTHING, id, name, price, stock, merchant, discount) {
 }
\ No newline at end of file
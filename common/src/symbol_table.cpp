@@ -0,0 +1,51 @@
+#include "symbol_table.h"
+#include <stdexcept>
+
+uint32_t SymbolTable::intern(const std::string& value) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+
+    auto it = ids.find(value);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    uint32_t id = count.load(std::memory_order_relaxed);
+    uint32_t chunk = id >> CHUNK_BITS;
+    if (chunk >= MAX_CHUNKS) {
+        throw std::runtime_error("符号表已满");
+    }
+    if (!chunks[chunk]) {
+        chunks[chunk].reset(new std::string[CHUNK_SIZE]);
+    }
+    chunks[chunk][id & (CHUNK_SIZE - 1)] = value;
+    ids.emplace(value, id);
+    // 字符串写好之后才发布编号，读者看到新的 count 时一定能看到对应内容
+    count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+bool SymbolTable::find(const std::string& value, uint32_t& id) const {
+    std::lock_guard<std::mutex> lock(tableMutex);
+
+    auto it = ids.find(value);
+    if (it == ids.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+const std::string& SymbolTable::lookup(uint32_t id) const {
+    if (id >= count.load(std::memory_order_acquire)) {
+        throw std::out_of_range("无效的符号编号: " + std::to_string(id));
+    }
+    return chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+}
+
+size_t SymbolTable::size() const {
+    return count.load(std::memory_order_acquire);
+}
+
+SymbolTable& SymbolTable::merchants() {
+    static SymbolTable table;
+    return table;
+}
\ No newline at end of file
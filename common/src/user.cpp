@@ -1,5 +1,8 @@
 #include "user.h"
 #include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
 
 bool User::changePassword(const std::string& oldPassword, const std::string& newPassword) {
     if (password == oldPassword) {
@@ -24,8 +27,9 @@ void User::serialize(std::ofstream& out) const {
     out.write(reinterpret_cast<const char*>(&passwordLen), sizeof(passwordLen));
     out.write(password.c_str(), passwordLen);
 
-    // 写入余额
-    out.write(reinterpret_cast<const char*>(&balance), sizeof(balance));
+    // 写入余额（旧格式为 double 元）
+    double yuan = balance.toYuan();
+    out.write(reinterpret_cast<const char*>(&yuan), sizeof(yuan));
 }
 
 void User::deserialize(std::ifstream& in) {
@@ -46,8 +50,70 @@ void User::deserialize(std::ifstream& in) {
     password.resize(passwordLen);
     in.read(&password[0], passwordLen);
 
-    // 读取余额
-    in.read(reinterpret_cast<char*>(&balance), sizeof(balance));
+    // 读取余额（旧格式为 double 元）
+    double yuan = 0.0;
+    in.read(reinterpret_cast<char*>(&yuan), sizeof(yuan));
+    balance = Money::fromYuan(yuan);
+}
+
+namespace {
+
+// 用户名和密码长度上限，超过视为记录损坏
+const uint32_t MAX_TEXT_LENGTH = 4096;
+
+template <typename T>
+void appendValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendText(std::string& out, const std::string& value) {
+    appendValue(out, static_cast<uint32_t>(value.length()));
+    out.append(value);
+}
+
+template <typename T>
+T readValue(const char*& data, const char* end, const char* field) {
+    if (static_cast<size_t>(end - data) < sizeof(T)) {
+        throw std::runtime_error(std::string("读取") + field + "失败，记录不完整");
+    }
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+std::string readText(const char*& data, const char* end, const char* field) {
+    uint32_t length = readValue<uint32_t>(data, end, field);
+    if (length > MAX_TEXT_LENGTH || static_cast<size_t>(end - data) < length) {
+        throw std::runtime_error(std::string(field) + "长度异常: " + std::to_string(length));
+    }
+    std::string value(data, length);
+    data += length;
+    return value;
+}
+
+}
+
+void User::appendRecord(std::string& out) const {
+    appendValue(out, static_cast<int32_t>(userType));
+    appendText(out, username);
+    appendText(out, password);
+    appendValue(out, balance.getCents());
+}
+
+User* User::readRecord(const char*& data, const char* end, bool legacyBalance) {
+    int32_t type = readValue<int32_t>(data, end, "用户类型");
+    std::string name = readText(data, end, "用户名");
+    std::string pwd = readText(data, end, "密码");
+    Money userBalance = legacyBalance ? Money::fromYuan(readValue<double>(data, end, "余额"))
+        : Money::fromCents(readValue<int64_t>(data, end, "余额"));
+
+    User* user = createUser(name, pwd, static_cast<UserType>(type));
+    if (!user) {
+        throw std::runtime_error("未知的用户类型: " + std::to_string(type));
+    }
+    user->setBalance(userBalance);
+    return user;
 }
 
 User* User::createUser(const std::string& username, const std::string& password, UserType type) {
@@ -1,8 +1,6 @@
 #include "utils.h"
 #include <iostream>
 #include <cstdlib>
-#include <iomanip>
-#include <sstream>
 #include <windows.h>
 #include <conio.h>
 
@@ -11,7 +9,7 @@ void Utils::clearScreen() {
 }
 
 void Utils::pauseScreen() {
-    std::cout << "\n...";
+    std::cout << "\n按任意键继续...";
     _getch();
     std::cout << std::endl;
 }
@@ -32,10 +30,8 @@ void Utils::showSeparator(const std::string& title) {
     std::cout << std::endl;
 }
 
-std::string Utils::formatMoney(double amount) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2) << amount;
-    return oss.str() + " Ԫ";
+std::string Utils::formatMoney(Money amount) {
+    return amount.toString() + " 元";
 }
 
 std::string Utils::getInput(const std::string& prompt) {
@@ -47,13 +43,13 @@ std::string Utils::getInput(const std::string& prompt) {
 }
 
 void Utils::showSuccess(const std::string& message) {
-    std::cout << "\n[ɹ] " << message << std::endl;
+    std::cout << "\n[成功] " << message << std::endl;
 }
 
 void Utils::showError(const std::string& message) {
-    std::cout << "\n[] " << message << std::endl;
+    std::cout << "\n[错误] " << message << std::endl;
 }
 
 void Utils::showInfo(const std::string& message) {
-    std::cout << "\n[Ϣ] " << message << std::endl;
+    std::cout << "\n[信息] " << message << std::endl;
 }
\ No newline at end of file
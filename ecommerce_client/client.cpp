@@ -3,11 +3,13 @@
 #include "utils.h"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include <windows.h>
 
-Client::Client() : clientSocket(INVALID_SOCKET), connected(false), userBalance(0.0),
-currentPage(1), totalPages(0), totalCount(0), waitingForResponse(false),
-cartTotalPrice(0.0), cartTotalCount(0) {
+Client::Client() : clientSocket(INVALID_SOCKET), connected(false), userBalance(),
+currentPage(1), totalPages(0), totalCount(0), currentSortKey(ProductSortKey::DEFAULT),
+waitingForResponse(false),
+cartTotalPrice(), cartTotalCount(0) {
     // 初始化Winsock
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
@@ -154,7 +156,9 @@ void Client::handleMessage(const NetworkMessage& message) {
                     std::getline(iss, balance)) {
 
                     userType = type;
-                    userBalance = std::stod(balance);
+                    if (!Money::parse(balance, userBalance)) {
+                        userBalance = Money();
+                    }
                     Utils::showSuccess(msg);
                     Utils::showInfo("用户类型: " + userType);
                     Utils::showInfo("账户余额: " + Utils::formatMoney(userBalance));
@@ -180,7 +184,7 @@ void Client::handleMessage(const NetworkMessage& message) {
                     Utils::showSuccess(msg);
                     currentUser.clear();
                     userType.clear();
-                    userBalance = 0.0;
+                    userBalance = Money();
                 }
                 else {
                     Utils::showError(msg);
@@ -225,15 +229,22 @@ void Client::handleMessage(const NetworkMessage& message) {
             std::istringstream iss(message.data);
             std::string totalPagesStr, totalCountStr, currentPageStr;
 
-            if (std::getline(iss, totalPagesStr, '|') &&
+            currentProducts.clear();
+            nextCursor.clear();
+
+            if (std::getline(iss, totalPagesStr, '|') && totalPagesStr != "ERROR" &&
                 std::getline(iss, totalCountStr, '|') &&
                 std::getline(iss, currentPageStr, '|')) {
 
-                totalPages = std::stoi(totalPagesStr);
-                totalCount = std::stoull(totalCountStr);
+                // 翻页请求不统计总数（返回-1），沿用第一页的统计
+                int pages = std::stoi(totalPagesStr);
+                long long count = std::stoll(totalCountStr);
+                if (pages >= 0 && count >= 0) {
+                    totalPages = pages;
+                    totalCount = static_cast<size_t>(count);
+                }
                 currentPage = std::stoi(currentPageStr);
-
-                currentProducts.clear();
+                std::getline(iss, nextCursor, '|');
 
                 std::string productData;
                 while (std::getline(iss, productData, '|')) {
@@ -252,8 +263,10 @@ void Client::handleMessage(const NetworkMessage& message) {
                         ProductInfo product;
                         product.id = std::stoi(idStr);
                         product.name = name;
-                        product.originalPrice = std::stod(originalPriceStr);
-                        product.price = std::stod(currentPriceStr);
+                        if (!Money::parse(originalPriceStr, product.originalPrice) ||
+                            !Money::parse(currentPriceStr, product.price)) {
+                            continue;
+                        }
                         product.stock = std::stoi(stockStr);
                         product.merchant = merchant;
                         product.productType = productType;
@@ -293,8 +306,10 @@ void Client::handleMessage(const NetworkMessage& message) {
                         ProductInfo product;
                         product.id = std::stoi(idStr);
                         product.name = name;
-                        product.originalPrice = std::stod(originalPriceStr);
-                        product.price = std::stod(currentPriceStr);
+                        if (!Money::parse(originalPriceStr, product.originalPrice) ||
+                            !Money::parse(currentPriceStr, product.price)) {
+                            continue;
+                        }
                         product.stock = std::stoi(stockStr);
                         product.merchant = merchant;
                         product.productType = productType;
@@ -310,6 +325,21 @@ void Client::handleMessage(const NetworkMessage& message) {
         }
         break;
 
+        case MessageType::PRODUCT_SUGGEST_RESPONSE:
+        {
+            // 格式: count|name1|name2|...
+            std::istringstream iss(message.data);
+            std::string countStr, name;
+            currentSuggestions.clear();
+            if (std::getline(iss, countStr, '|')) {
+                while (std::getline(iss, name, '|')) {
+                    currentSuggestions.push_back(name);
+                }
+            }
+            waitingForResponse = false;
+        }
+        break;
+
         case MessageType::PRODUCT_DETAIL_RESPONSE:
         {
             std::istringstream iss(message.data);
@@ -335,8 +365,9 @@ void Client::handleMessage(const NetworkMessage& message) {
                         std::cout << "商品类型: " << productType << std::endl;
 
                         double discount = std::stod(discountStr);
-                        double originalPrice = std::stod(originalPriceStr);
-                        double currentPrice = std::stod(currentPriceStr);
+                        Money originalPrice, currentPrice;
+                        Money::parse(originalPriceStr, originalPrice);
+                        Money::parse(currentPriceStr, currentPrice);
                         int stock = std::stoi(stockStr);
 
                         if (discount < 1.0) {
@@ -440,7 +471,9 @@ void Client::handleMessage(const NetworkMessage& message) {
                         std::getline(iss, totalPriceStr, '|')) {
 
                         cartTotalCount = std::stoi(totalCountStr);
-                        cartTotalPrice = std::stod(totalPriceStr);
+                        if (!Money::parse(totalPriceStr, cartTotalPrice)) {
+                            cartTotalPrice = Money();
+                        }
                         currentCartItems.clear();
 
                         std::string itemData;
@@ -461,8 +494,10 @@ void Client::handleMessage(const NetworkMessage& message) {
                                 item.id = std::stoi(idStr);
                                 item.name = name;
                                 item.type = type;
-                                item.originalPrice = std::stod(origPriceStr);
-                                item.currentPrice = std::stod(currPriceStr);
+                                if (!Money::parse(origPriceStr, item.originalPrice) ||
+                                    !Money::parse(currPriceStr, item.currentPrice)) {
+                                    continue;
+                                }
                                 item.quantity = std::stoi(qtyStr);
                                 item.merchant = merchant;
                                 item.discount = std::stod(discountStr);
@@ -895,12 +930,28 @@ void Client::handleProductBrowse() {
     }
 }
 
+const char* Client::sortKeyName(ProductSortKey sortKey) {
+    switch (sortKey) {
+    case ProductSortKey::PRICE_ASC: return "价格从低到高";
+    case ProductSortKey::PRICE_DESC: return "价格从高到低";
+    case ProductSortKey::DISCOUNT: return "折扣力度";
+    case ProductSortKey::NEWEST: return "最新上架";
+    default: return "默认";
+    }
+}
+
 void Client::handleProductList() {
     currentPage = 1;
+    // pageCursors[i] 是第 i+1 页的起始游标，第一页为空
+    std::vector<std::string> pageCursors(1);
 
     while (true) {
-        // 请求商品列表
-        std::string data = std::to_string(currentPage) + "|5"; // 每页5个商品
+        // 请求商品列表，第一页顺带取总数，之后按游标翻页
+        std::string data = std::to_string(currentPage) + "|5|" // 每页5个商品
+            + std::to_string(static_cast<int>(currentSortKey));
+        if (currentPage > 1) {
+            data += "|" + pageCursors[currentPage - 1] + "|0";
+        }
         NetworkMessage message(MessageType::PRODUCT_LIST_REQUEST, data);
 
         waitingForResponse = true;
@@ -914,6 +965,11 @@ void Client::handleProductList() {
 
             if (!connected) break;
 
+            if (!nextCursor.empty()) {
+                pageCursors.resize(std::max(pageCursors.size(), static_cast<size_t>(currentPage) + 1));
+                pageCursors[currentPage] = nextCursor;
+            }
+
             // 显示商品列表
             UIManager::showProductList();
 
@@ -923,7 +979,8 @@ void Client::handleProductList() {
                 break;
             }
 
-            std::cout << "第 " << currentPage << " 页，共 " << totalPages << " 页 (总共 " << totalCount << " 个商品)\n" << std::endl;
+            std::cout << "第 " << currentPage << " 页，共 " << totalPages << " 页 (总共 " << totalCount << " 个商品)"
+                << " 排序: " << sortKeyName(currentSortKey) << "\n" << std::endl;
 
             for (size_t i = 0; i < currentProducts.size(); ++i) {
                 const auto& product = currentProducts[i];
@@ -949,9 +1006,10 @@ void Client::handleProductList() {
             if (currentPage > 1) {
                 std::cout << "p. 上一页" << std::endl;
             }
-            if (currentPage < totalPages) {
+            if (!nextCursor.empty()) {
                 std::cout << "n. 下一页" << std::endl;
             }
+            std::cout << "s. 切换排序方式" << std::endl;
             std::cout << "b. 返回上级菜单" << std::endl;
 
             std::cout << "\n请选择操作: ";
@@ -961,13 +1019,20 @@ void Client::handleProductList() {
             if (choice == "b" || choice == "B") {
                 break;
             }
+            else if (choice == "s" || choice == "S") {
+                // 依次切换排序方式，并回到第一页
+                int next = (static_cast<int>(currentSortKey) + 1) % (static_cast<int>(ProductSortKey::NEWEST) + 1);
+                currentSortKey = static_cast<ProductSortKey>(next);
+                currentPage = 1;
+                pageCursors.assign(1, std::string());
+            }
             else if (choice == "p" || choice == "P") {
                 if (currentPage > 1) {
                     currentPage--;
                 }
             }
             else if (choice == "n" || choice == "N") {
-                if (currentPage < totalPages) {
+                if (!nextCursor.empty()) {
                     currentPage++;
                 }
             }
@@ -1013,7 +1078,37 @@ void Client::handleProductSearch() {
         return;
     }
 
-    NetworkMessage message(MessageType::PRODUCT_SEARCH_REQUEST, keyword);
+    // 先取搜索建议，用户可以直接选一个完整的商品名称，减少搜不到再重搜
+    currentSuggestions.clear();
+    waitingForResponse = true;
+    if (sendMessage(NetworkMessage(MessageType::PRODUCT_SUGGEST_REQUEST, keyword + "|8"))) {
+        while (waitingForResponse && connected) {
+            Sleep(10);
+        }
+    }
+    waitingForResponse = false;
+    if (!currentSuggestions.empty()) {
+        std::cout << "\n搜索建议：" << std::endl;
+        for (size_t i = 0; i < currentSuggestions.size(); ++i) {
+            std::cout << "  " << i + 1 << ". " << currentSuggestions[i] << std::endl;
+        }
+        std::cout << "输入序号使用建议，直接回车按原关键词搜索: ";
+        std::string pick;
+        std::getline(std::cin, pick);
+        try {
+            int index = pick.empty() ? 0 : std::stoi(pick);
+            if (index >= 1 && index <= static_cast<int>(currentSuggestions.size())) {
+                keyword = currentSuggestions[index - 1];
+            }
+        }
+        catch (const std::exception&) {
+            // 无效输入时按原关键词搜索
+        }
+    }
+
+    // 搜索结果沿用商品列表当前的排序方式，不限数量、不要分面，开启容错匹配
+    std::string data = keyword + "|" + std::to_string(static_cast<int>(currentSortKey)) + "|0|0|1";
+    NetworkMessage message(MessageType::PRODUCT_SEARCH_REQUEST, data);
 
     waitingForResponse = true;
     if (sendMessage(message)) {
@@ -1173,11 +1268,16 @@ void Client::handleMerchantAddProduct() {
     std::getline(std::cin, discountStr);
 
     try {
-        double price = std::stod(priceStr);
+        Money price;
         int stock = std::stoi(stockStr);
         double discount = std::stod(discountStr);
 
-        if (price <= 0) {
+        if (!Money::parse(priceStr, price)) {
+            Utils::showError("商品价格格式错误，最多两位小数！");
+            Utils::pauseScreen();
+            return;
+        }
+        if (price <= Money()) {
             Utils::showError("商品价格必须大于0！");
             Utils::pauseScreen();
             return;
@@ -1407,8 +1507,13 @@ void Client::handleMerchantModifyProduct() {
         // 验证输入
         try {
             if (priceStr != "-1") {
-                double price = std::stod(priceStr);
-                if (price <= 0) {
+                Money price;
+                if (!Money::parse(priceStr, price)) {
+                    Utils::showError("商品价格格式错误，最多两位小数！");
+                    Utils::pauseScreen();
+                    return;
+                }
+                if (price <= Money()) {
                     Utils::showError("商品价格必须大于0！");
                     Utils::pauseScreen();
                     return;
@@ -1869,7 +1974,7 @@ void Client::handleConfirmOrder() {
 
         // 清空本地购物车缓存（因为服务端会清空购物车）
         currentCartItems.clear();
-        cartTotalPrice = 0.0;
+        cartTotalPrice = Money();
         cartTotalCount = 0;
 
         // 更新本地余额（估算，实际以服务端为准）
@@ -2146,7 +2251,7 @@ void Client::handleClearCart() {
 
             // 清空本地购物车缓存
             currentCartItems.clear();
-            cartTotalPrice = 0.0;
+            cartTotalPrice = Money();
             cartTotalCount = 0;
         }
         else {
@@ -9,14 +9,15 @@
 #include <limits>
 #include <vector>
 #include "message.h"
+#include "money.h"
 
 #pragma comment(lib, "ws2_32.lib")
 
 struct ProductInfo {
     int id;
     std::string name;
-    double originalPrice;    // 原价
-    double price;           // 现价（考虑折扣）
+    Money originalPrice;     // 原价
+    Money price;            // 现价（考虑折扣）
     int stock;
     std::string merchant;
     std::string productType; // 商品种类
@@ -29,13 +30,13 @@ struct CartItemInfo {
     int id;
     std::string name;
     std::string type;
-    double originalPrice;
-    double currentPrice;
+    Money originalPrice;
+    Money currentPrice;
     int quantity;
     std::string merchant;
     double discount;
 
-    double getTotalPrice() const {
+    Money getTotalPrice() const {
         return currentPrice * quantity;
     }
 };
@@ -45,13 +46,13 @@ struct OrderItemInfo {
     int productId;
     std::string productName;
     std::string productType;
-    double originalPrice;
-    double currentPrice;
+    Money originalPrice;
+    Money currentPrice;
     int quantity;
     std::string merchantName;
     double discount;
 
-    double getTotalPrice() const {
+    Money getTotalPrice() const {
         return currentPrice * quantity;
     }
 };
@@ -60,7 +61,7 @@ struct OrderItemInfo {
 struct OrderInfo {
     int orderId;
     std::string orderTime;
-    double totalAmount;
+    Money totalAmount;
     std::string status;
     std::vector<OrderItemInfo> items;
 };
@@ -74,18 +75,21 @@ private:
     // 用户信息
     std::string currentUser;
     std::string userType;
-    double userBalance;
+    Money userBalance;
 
     // 商品浏览相关
     std::vector<ProductInfo> currentProducts;
     int currentPage;
     int totalPages;
     size_t totalCount;
+    ProductSortKey currentSortKey;  // 商品列表/搜索的排序方式
+    std::string nextCursor;         // 下一页的分页游标，为空表示没有下一页
+    std::vector<std::string> currentSuggestions;   // 搜索建议（按热度排序的商品名称）
     bool waitingForResponse;
 
     // 购物车相关
     std::vector<CartItemInfo> currentCartItems;
-    double cartTotalPrice;
+    Money cartTotalPrice;
     int cartTotalCount;
 
     // 当前订单信息
@@ -97,6 +101,8 @@ private:
     // 处理接收到的消息
     void handleMessage(const NetworkMessage& message);
 
+    static const char* sortKeyName(ProductSortKey sortKey);
+
 public:
     Client();
     ~Client();
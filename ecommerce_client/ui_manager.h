@@ -2,98 +2,99 @@
 #define UI_MANAGER_H
 
 #include <string>
+#include "money.h"
 #include <windows.h>
 
 class UIManager {
 public:
-    // ʾϵͳ
+    // 显示系统标题
     static void showSystemTitle();
 
-    // ʾӭϢ
+    // 显示欢迎信息
     static void showWelcomeMessage();
 
-    // ʾ˵
+    // 显示主菜单
     static void showMainMenu();
 
-    // ʾ¼˵
-    static void showLoggedInMenu(const std::string& username, const std::string& userType, double balance);
+    // 显示登录后菜单
+    static void showLoggedInMenu(const std::string& username, const std::string& userType, Money balance);
 
-    // ʾע
+    // 显示注册界面
     static void showRegisterForm();
 
-    // ʾ¼
+    // 显示登录界面
     static void showLoginForm();
 
-    // ʾ˻˵
+    // 显示账户管理菜单
     static void showAccountMenu();
 
-    // ʾ޸Ľ
+    // 显示密码修改界面
     static void showChangePasswordForm();
 
-    // ʾƷ
+    // 显示商品浏览界面
     static void showProductBrowseMenu();
 
-    // ʾƷб
+    // 显示商品列表
     static void showProductList();
 
-    // ʾƷ
+    // 显示商品搜索界面
     static void showProductSearchForm();
 
-    // ʾƷ
+    // 显示商品详情界面
     static void showProductDetail();
 
-    // ʾ̼Ʒ˵
+    // 显示商家商品管理菜单
     static void showMerchantProductMenu();
 
-    // ʾƷ
+    // 显示添加商品界面
     static void showAddProductForm();
 
-    // ʾ޸Ʒ
+    // 显示修改商品界面
     static void showModifyProductForm();
 
-    // ʾ̼Ʒб
+    // 显示商家商品列表
     static void showMerchantProductList();
 
-    // ʾۿ۽
+    // 显示设置折扣界面
     static void showSetDiscountForm();
 
-    // ʾﳵ˵ߣ
+    // 显示购物车菜单（消费者）
     static void showCartMenu();
 
-    // ʾﳵ
+    // 显示购物车详情
     static void showCartDetail();
 
-    // ʾ޸ĹﳵƷ
+    // 显示修改购物车商品数量界面
     static void showUpdateCartItemForm();
 
-    // ʾƳﳵƷ
+    // 显示移除购物车商品界面
     static void showRemoveCartItemForm();
 
-    // ʾ߲˵
+    // 显示消费者菜单
     static void showConsumerMenu();
 
-    // ʾ˵
+    // 显示订单管理菜单
     static void showOrderMenu();
 
-    // ʾб
+    // 显示订单列表
     static void showOrderList();
 
-    // ʾ
+    // 显示订单详情
     static void showOrderDetail();
 
-    // ʾ˳Ϣ
+    // 显示退出信息
     static void showExitMessage();
 
-    // ȡ˵ѡ
+    // 获取菜单选择
     static std::string getMenuChoice(int maxChoice);
 
-    // ʾض
+    // 显示加载动画
     static void showLoading(const std::string& message);
 
-    // ʾ
+    // 显示结算界面
     static void showCheckoutInterface();
 
-    // ʾȷϽ
+    // 显示结算确认界面
     static void showCheckoutConfirmation();
 };
 
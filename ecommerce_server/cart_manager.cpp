@@ -1,4 +1,5 @@
 #include "cart_manager.h"
+#include "snapshot_file.h"
 #include <fstream>
 #include <iostream>
 
@@ -15,7 +16,7 @@ bool CartManager::addItemToCart(const std::string& username, const CartItem& ite
 
     auto it = userCarts.find(username);
     if (it == userCarts.end()) {
-        // µĹﳵ
+        // 创建新的购物车
         userCarts.emplace(username, Cart(username));
         it = userCarts.find(username);
     }
@@ -23,7 +24,7 @@ bool CartManager::addItemToCart(const std::string& username, const CartItem& ite
     bool result = it->second.addItem(item);
     if (result) {
         saveCarts();
-        std::cout << "û [" << username << "] Ʒﳵ: " << item.productName
+        std::cout << "用户 [" << username << "] 添加商品到购物车: " << item.productName
             << " x" << item.quantity << std::endl;
     }
 
@@ -41,8 +42,8 @@ bool CartManager::updateCartItem(const std::string& username, int productId, int
     bool result = it->second.updateItemQuantity(productId, quantity);
     if (result) {
         saveCarts();
-        std::cout << "û [" << username << "] ¹ﳵƷ: ƷID=" << productId
-            << ", =" << quantity << std::endl;
+        std::cout << "用户 [" << username << "] 更新购物车商品数量: 商品ID=" << productId
+            << ", 新数量=" << quantity << std::endl;
     }
 
     return result;
@@ -59,7 +60,7 @@ bool CartManager::removeItemFromCart(const std::string& username, int productId)
     bool result = it->second.removeItem(productId);
     if (result) {
         saveCarts();
-        std::cout << "û [" << username << "] ӹﳵƳƷ: ƷID=" << productId << std::endl;
+        std::cout << "用户 [" << username << "] 从购物车移除商品: 商品ID=" << productId << std::endl;
     }
 
     return result;
@@ -75,7 +76,7 @@ bool CartManager::clearUserCart(const std::string& username) {
 
     it->second.clear();
     saveCarts();
-    std::cout << "û [" << username << "] չﳵ" << std::endl;
+    std::cout << "用户 [" << username << "] 清空购物车" << std::endl;
 
     return true;
 }
@@ -88,7 +89,7 @@ Cart CartManager::getUserCart(const std::string& username) const {
         return it->second;
     }
 
-    return Cart(username); // ؿչﳵ
+    return Cart(username); // 返回空购物车
 }
 
 std::vector<CartItem> CartManager::getUserCartItems(const std::string& username) const {
@@ -99,10 +100,10 @@ std::vector<CartItem> CartManager::getUserCartItems(const std::string& username)
         return it->second.getItems();
     }
 
-    return std::vector<CartItem>(); // ؿб
+    return std::vector<CartItem>(); // 返回空列表
 }
 
-double CartManager::getUserCartTotalPrice(const std::string& username) const {
+Money CartManager::getUserCartTotalPrice(const std::string& username) const {
     std::lock_guard<std::mutex> lock(cartsMutex);
 
     auto it = userCarts.find(username);
@@ -110,7 +111,7 @@ double CartManager::getUserCartTotalPrice(const std::string& username) const {
         return it->second.getTotalPrice();
     }
 
-    return 0.0;
+    return Money();
 }
 
 int CartManager::getUserCartItemCount(const std::string& username) const {
@@ -125,46 +126,98 @@ int CartManager::getUserCartItemCount(const std::string& username) const {
 }
 
 void CartManager::loadCarts() {
+    userCarts.clear();
+
+    bool intact = true;
+    {
+        SnapshotReader snapshot;
+        SnapshotReader::Status status = snapshot.open(filename, "CART");
+        if (status == SnapshotReader::Status::MISSING) {
+            std::cout << "购物车文件不存在，将在首次使用时创建: " << filename << std::endl;
+            return;
+        }
+        if (status == SnapshotReader::Status::LEGACY) {
+            loadLegacyCarts();
+        }
+        else {
+            intact = status == SnapshotReader::Status::VALID;
+            for (const auto& error : snapshot.getErrors()) {
+                std::cerr << error << std::endl;
+            }
+            if (snapshot.getKindVersion() == CART_RECORD_VERSION) {
+                // 每条记录是一个购物车的文本序列化结果
+                std::string line;
+                for (const auto& block : snapshot.getBlocks()) {
+                    SnapshotRecordReader reader(block);
+                    for (uint32_t i = 0; i < block.recordCount; ++i) {
+                        try {
+                            reader.readString(line, MAX_CART_RECORD_LENGTH, "购物车记录");
+                        }
+                        catch (const std::exception& e) {
+                            std::cerr << "解析购物车记录块出错: " << e.what() << std::endl;
+                            intact = false;
+                            break;
+                        }
+                        addCartLine(line);
+                    }
+                }
+            }
+            else if (intact) {
+                std::cerr << "不支持的购物车记录版本: " << snapshot.getKindVersion() << std::endl;
+                intact = false;
+            }
+        }
+    }
+
+    std::cout << "成功加载 " << userCarts.size() << " 个用户的购物车" << std::endl;
+    if (!intact) {
+        std::string backupName = SnapshotReader::preserveDamaged(filename);
+        std::cerr << "购物车文件已损坏，" << (backupName.empty() ? "且无法改名保留原文件" : "原文件保留为 " + backupName)
+            << std::endl;
+    }
+}
+
+void CartManager::loadLegacyCarts() {
     std::ifstream file(filename);
     if (!file.is_open()) {
-        std::cout << "ﳵļڣ״ʹʱ: " << filename << std::endl;
         return;
     }
 
-    userCarts.clear();
-
     std::string line;
     while (std::getline(file, line)) {
         if (!line.empty()) {
-            try {
-                Cart cart = Cart::deserialize(line);
-                std::string username = cart.getUsername();
-                if (!username.empty()) {
-                    userCarts.emplace(username, std::move(cart));
-                }
-            }
-            catch (const std::exception& e) {
-                std::cerr << "ﳵʱ: " << e.what() << std::endl;
-            }
+            addCartLine(line);
         }
     }
-
     file.close();
-    std::cout << "ɹ " << userCarts.size() << " ûĹﳵ" << std::endl;
+}
+
+void CartManager::addCartLine(const std::string& line) {
+    try {
+        Cart cart = Cart::deserialize(line);
+        std::string username = cart.getUsername();
+        if (!username.empty()) {
+            userCarts.emplace(username, std::move(cart));
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "解析购物车数据时出错: " << e.what() << std::endl;
+    }
 }
 
 void CartManager::saveCarts() {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "޷򿪹ﳵļд: " << filename << std::endl;
+    SnapshotWriter writer(filename, "CART", CART_RECORD_VERSION, CARTS_PER_BLOCK);
+    if (!writer.open()) {
         return;
     }
 
     for (const auto& pair : userCarts) {
-        if (!pair.second.isEmpty()) { // ֻǿչﳵ
-            file << pair.second.serialize() << std::endl;
+        if (!pair.second.isEmpty()) { // 只保存非空购物车
+            writer.putString(pair.second.serialize());
+            writer.endRecord();
         }
     }
-
-    file.close();
+    if (!writer.commit()) {
+        std::cerr << "保存购物车文件失败: " << filename << std::endl;
+    }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <cstdint>
 
 class CartManager {
 private:
@@ -12,35 +13,42 @@ private:
     mutable std::mutex cartsMutex;
     std::string filename;
 
+    // 购物车文件为快照容器，每条记录是一个购物车的文本序列化结果；旧格式（每行一个）只读不写
+    static const uint32_t CART_RECORD_VERSION = 1;
+    static const uint32_t CARTS_PER_BLOCK = 4096;
+    static const uint32_t MAX_CART_RECORD_LENGTH = 16 * 1024 * 1024;
+
     void loadCarts();
+    void loadLegacyCarts();
+    void addCartLine(const std::string& line);
     void saveCarts();
 
 public:
     CartManager(const std::string& filename);
     ~CartManager();
 
-    // Ʒûﳵ
+    // 添加商品到用户购物车
     bool addItemToCart(const std::string& username, const CartItem& item);
 
-    // ¹ﳵƷ
+    // 更新购物车中商品数量
     bool updateCartItem(const std::string& username, int productId, int quantity);
 
-    // ӹﳵƳƷ
+    // 从购物车移除商品
     bool removeItemFromCart(const std::string& username, int productId);
 
-    // ûﳵ
+    // 清空用户购物车
     bool clearUserCart(const std::string& username);
 
-    // ȡûﳵ
+    // 获取用户购物车
     Cart getUserCart(const std::string& username) const;
 
-    // ȡûﳵеƷб
+    // 获取用户购物车中的商品列表
     std::vector<CartItem> getUserCartItems(const std::string& username) const;
 
-    // ȡûﳵܼ
-    double getUserCartTotalPrice(const std::string& username) const;
+    // 获取用户购物车总价
+    Money getUserCartTotalPrice(const std::string& username) const;
 
-    // ȡûﳵƷ
+    // 获取用户购物车商品数量
     int getUserCartItemCount(const std::string& username) const;
 };
 
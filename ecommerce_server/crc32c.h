@@ -0,0 +1,11 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C（Castagnoli 多项式）。CPU 支持 SSE4.2 时使用 crc32 指令，否则查表计算。
+// crc 为之前部分的结果，可以分段连续计算；首段传 0
+uint32_t crc32c(uint32_t crc, const void* data, size_t size);
+
+#endif
\ No newline at end of file
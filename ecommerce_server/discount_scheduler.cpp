@@ -0,0 +1,345 @@
+#include "discount_scheduler.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+DiscountScheduler::DiscountScheduler(ProductManager& productManager, const std::string& filename)
+    : productManager(productManager), filename(filename),
+    wheel(static_cast<uint64_t>(nowMillis() / TICK_MS)), nextWindowId(1), stopping(false) {
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        loadWindows();
+    }
+    tickThread = std::thread(&DiscountScheduler::tickLoop, this);
+}
+
+DiscountScheduler::~DiscountScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        stopping = true;
+    }
+    tickCv.notify_one();
+    if (tickThread.joinable()) {
+        tickThread.join();
+    }
+}
+
+int64_t DiscountScheduler::nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t DiscountScheduler::tickAtOrAfter(int64_t millis) {
+    if (millis <= 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>((millis + TICK_MS - 1) / TICK_MS);
+}
+
+bool DiscountScheduler::scheduleWindow(const std::string& merchantName, const std::string& productType,
+    const std::vector<int>& productIds, double discount, int64_t startTime, int64_t endTime,
+    uint64_t& windowId, std::string& error) {
+    if (discount <= 0.0 || discount > 1.0) {
+        error = "折扣必须在0.0到1.0之间";
+        return false;
+    }
+    if (endTime - startTime < MIN_WINDOW_MS) {
+        error = "结束时间必须比开始时间至少晚1秒";
+        return false;
+    }
+    if (endTime <= nowMillis()) {
+        error = "结束时间已经过去";
+        return false;
+    }
+    if (productType.empty() == productIds.empty()) {
+        error = "请指定商品类型或商品ID";
+        return false;
+    }
+    if (productIds.size() > MAX_WINDOW_PRODUCTS) {
+        error = "一个定时折扣最多包含 " + std::to_string(MAX_WINDOW_PRODUCTS) + " 个商品";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    DiscountWindow window;
+    window.windowId = nextWindowId++;
+    window.merchantName = merchantName;
+    window.productType = productType;
+    window.productIds = productIds;
+    window.discount = discount;
+    window.startTime = startTime;
+    window.endTime = endTime;
+    window.started = false;
+    addTimers(window);
+    windowId = window.windowId;
+    windows.emplace(windowId, std::move(window));
+    saveWindows();
+
+    std::cout << "商家 [" << merchantName << "] 添加定时折扣 #" << windowId << "，"
+        << (productType.empty() ? std::to_string(productIds.size()) + " 个商品" : productType + "类商品")
+        << " " << static_cast<int>(discount * 100) << "折，当前共 " << windows.size() << " 个窗口" << std::endl;
+    return true;
+}
+
+size_t DiscountScheduler::getWindowCount() const {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    return windows.size();
+}
+
+void DiscountScheduler::addTimers(const DiscountWindow& window) {
+    if (!window.started) {
+        wheel.schedule(startTimer(window.windowId), tickAtOrAfter(window.startTime));
+    }
+    wheel.schedule(endTimer(window.windowId), tickAtOrAfter(window.endTime));
+}
+
+void DiscountScheduler::tickLoop() {
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+    while (!stopping) {
+        // 睡到下一个 tick 的边界，系统时间被调整时最多多等一个 tick
+        int64_t wait = static_cast<int64_t>(wheel.getCurrentTick() + 1) * TICK_MS - nowMillis();
+        if (wait > 0) {
+            tickCv.wait_for(lock, std::chrono::milliseconds(wait < TICK_MS ? wait : TICK_MS));
+            if (stopping) {
+                break;
+            }
+        }
+        uint64_t tick = static_cast<uint64_t>(nowMillis() / TICK_MS);
+        if (tick > wheel.getCurrentTick()) {
+            processTick(tick);
+        }
+    }
+}
+
+void DiscountScheduler::processTick(uint64_t tick) {
+    std::vector<uint64_t> expired;
+    wheel.advance(tick, expired);
+    if (expired.empty()) {
+        return;
+    }
+
+    std::vector<uint64_t> starting;
+    std::vector<uint64_t> ending;
+    for (uint64_t timerId : expired) {
+        uint64_t windowId = timerId / 2;
+        if (windows.count(windowId) == 0) {
+            continue;
+        }
+        if (timerId == endTimer(windowId)) {
+            ending.push_back(windowId);
+        }
+        else {
+            starting.push_back(windowId);
+        }
+    }
+
+    // 第一次涉及某个商品时读取它的当前折扣；与上次写入的不同说明商家手动改过，丢弃覆盖状态
+    std::vector<int> touched;
+    std::unordered_map<int, double> current;
+    auto prepare = [&](int productId) {
+        auto found = current.find(productId);
+        if (found != current.end()) {
+            return found->second >= 0;
+        }
+        ProductRef product = productManager.getProductById(productId);
+        double discount = product ? product->getDiscount() : -1;
+        current[productId] = discount;
+        touched.push_back(productId);
+        auto it = overrides.find(productId);
+        if (it != overrides.end() && it->second.applied != discount) {
+            overrides.erase(it);
+        }
+        return discount >= 0;
+    };
+
+    // 先结束再开始，同一 tick 内按顺序计算每个商品最终的生效折扣。
+    // 没有开始就结束的窗口（停机期间整个错过）直接丢弃，之后的开始事件找不到窗口会被忽略
+    size_t startedCount = 0;
+    for (uint64_t windowId : ending) {
+        const DiscountWindow& window = windows.at(windowId);
+        if (window.started) {
+            for (int productId : window.productIds) {
+                auto it = prepare(productId) ? overrides.find(productId) : overrides.end();
+                if (it == overrides.end()) {
+                    continue;
+                }
+                std::vector<uint64_t>& ids = it->second.windowIds;
+                ids.erase(std::remove(ids.begin(), ids.end(), windowId), ids.end());
+                it->second.applied = ids.empty() ? it->second.base : windows.at(ids.back()).discount;
+            }
+        }
+        windows.erase(windowId);
+    }
+    for (uint64_t windowId : starting) {
+        auto found = windows.find(windowId);
+        if (found == windows.end()) {
+            continue;
+        }
+        DiscountWindow& window = found->second;
+        if (!window.productType.empty()) {
+            window.productIds = productManager.getMerchantProductIds(window.merchantName, window.productType);
+        }
+        window.started = true;
+        startedCount++;
+        for (int productId : window.productIds) {
+            if (!prepare(productId)) {
+                continue;
+            }
+            auto it = overrides.find(productId);
+            if (it == overrides.end()) {
+                double base = current[productId];
+                it = overrides.emplace(productId, DiscountOverride{ base, base, {} }).first;
+            }
+            it->second.windowIds.push_back(windowId);
+            it->second.applied = window.discount;
+        }
+    }
+
+    // 每个商品只写一次最终折扣；写入时折扣已被并发修改的商品同样以手动值为准
+    std::vector<DiscountAssignment> assignments;
+    for (int productId : touched) {
+        auto it = overrides.find(productId);
+        if (it != overrides.end() && it->second.applied != current[productId]) {
+            assignments.push_back({ productId, it->second.applied, current[productId], -1, false });
+        }
+    }
+    size_t changed = productManager.applyScheduledDiscounts(assignments);
+    for (const auto& assignment : assignments) {
+        if (!assignment.applied && assignment.previous != assignment.discount) {
+            overrides.erase(assignment.productId);
+        }
+    }
+    for (int productId : touched) {
+        auto it = overrides.find(productId);
+        if (it != overrides.end() && it->second.windowIds.empty()) {
+            overrides.erase(it);
+        }
+    }
+
+    if (startedCount == 0 && ending.empty()) {
+        return;
+    }
+    std::cout << "定时折扣: 开始 " << startedCount << " 个、结束 " << ending.size() << " 个窗口，修改 "
+        << changed << " 个商品，目录版本 " << productManager.getCatalogVersion() << std::endl;
+    saveWindows();
+}
+
+void DiscountScheduler::loadWindows() {
+    SnapshotReader snapshot;
+    SnapshotReader::Status status = snapshot.open(filename, "DSCH");
+    if (status == SnapshotReader::Status::MISSING) {
+        return;
+    }
+
+    bool intact = status == SnapshotReader::Status::VALID;
+    for (const auto& error : snapshot.getErrors()) {
+        std::cerr << error << std::endl;
+    }
+    if (status == SnapshotReader::Status::LEGACY || snapshot.getKindVersion() != SCHEDULE_RECORD_VERSION) {
+        std::cerr << "无法识别的定时折扣文件: " << filename << std::endl;
+        intact = false;
+    }
+    else {
+        nextWindowId = std::max<uint64_t>(snapshot.getExtra(), 1);
+        for (const auto& block : snapshot.getBlocks()) {
+            SnapshotRecordReader reader(block);
+            try {
+                for (uint32_t i = 0; i < block.recordCount; ++i) {
+                    uint8_t recordType = reader.read<uint8_t>("记录类型");
+                    if (recordType == OVERRIDE_RECORD) {
+                        int productId = reader.read<int>("商品ID");
+                        DiscountOverride entry;
+                        entry.base = reader.read<double>("原折扣");
+                        entry.applied = reader.read<double>("生效折扣");
+                        uint32_t windowCount = reader.read<uint32_t>("窗口数量");
+                        for (uint32_t k = 0; k < windowCount; ++k) {
+                            entry.windowIds.push_back(reader.read<uint64_t>("窗口ID"));
+                        }
+                        overrides[productId] = std::move(entry);
+                        continue;
+                    }
+                    if (recordType != WINDOW_RECORD) {
+                        throw std::runtime_error("未知的记录类型: " + std::to_string(recordType));
+                    }
+                    DiscountWindow window;
+                    window.windowId = reader.read<uint64_t>("窗口ID");
+                    reader.readString(window.merchantName, 1000, "商家名称");
+                    reader.readString(window.productType, 1000, "商品类型");
+                    window.discount = reader.read<double>("折扣");
+                    window.startTime = reader.read<int64_t>("开始时间");
+                    window.endTime = reader.read<int64_t>("结束时间");
+                    window.started = reader.read<uint8_t>("开始标记") != 0;
+                    uint32_t productCount = reader.read<uint32_t>("商品数量");
+                    for (uint32_t k = 0; k < productCount; ++k) {
+                        window.productIds.push_back(reader.read<int>("商品ID"));
+                    }
+                    nextWindowId = std::max(nextWindowId, window.windowId + 1);
+                    addTimers(window);
+                    windows.emplace(window.windowId, std::move(window));
+                }
+                if (!reader.atEnd()) {
+                    throw std::runtime_error("块末尾有多余数据");
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "解析第 " << (block.firstRecord + 1) << " 条定时折扣记录起的记录块出错: " << e.what() << std::endl;
+                intact = false;
+            }
+        }
+    }
+
+    // 文件损坏时可能缺少部分窗口，覆盖状态中只保留还存在的窗口
+    for (auto& entry : overrides) {
+        std::vector<uint64_t>& ids = entry.second.windowIds;
+        ids.erase(std::remove_if(ids.begin(), ids.end(),
+            [this](uint64_t windowId) { return windows.count(windowId) == 0; }), ids.end());
+    }
+
+    std::cout << "成功加载 " << windows.size() << " 个定时折扣，" << overrides.size() << " 个商品处于折扣中" << std::endl;
+    if (!intact) {
+        snapshot.close();
+        std::string backupName = SnapshotReader::preserveDamaged(filename);
+        std::cerr << "定时折扣文件已损坏，" << (backupName.empty() ? "且无法改名保留原文件" : "原文件保留为 " + backupName)
+            << std::endl;
+    }
+}
+
+void DiscountScheduler::saveWindows() {
+    SnapshotWriter writer(filename, "DSCH", SCHEDULE_RECORD_VERSION, WINDOWS_PER_BLOCK);
+    if (!writer.open()) {
+        return;
+    }
+
+    for (const auto& item : windows) {
+        const DiscountWindow& window = item.second;
+        writer.put(static_cast<uint8_t>(WINDOW_RECORD));
+        writer.put(window.windowId);
+        writer.putString(window.merchantName);
+        writer.putString(window.productType);
+        writer.put(window.discount);
+        writer.put(window.startTime);
+        writer.put(window.endTime);
+        writer.put(static_cast<uint8_t>(window.started ? 1 : 0));
+        writer.put(static_cast<uint32_t>(window.productIds.size()));
+        for (int productId : window.productIds) {
+            writer.put(productId);
+        }
+        writer.endRecord();
+    }
+    for (const auto& item : overrides) {
+        const DiscountOverride& entry = item.second;
+        writer.put(static_cast<uint8_t>(OVERRIDE_RECORD));
+        writer.put(item.first);
+        writer.put(entry.base);
+        writer.put(entry.applied);
+        writer.put(static_cast<uint32_t>(entry.windowIds.size()));
+        for (uint64_t windowId : entry.windowIds) {
+            writer.put(windowId);
+        }
+        writer.endRecord();
+    }
+    writer.setExtra(nextWindowId);
+    if (!writer.commit()) {
+        std::cerr << "保存定时折扣文件失败: " << filename << std::endl;
+    }
+}
\ No newline at end of file
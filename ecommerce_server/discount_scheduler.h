@@ -0,0 +1,90 @@
+#ifndef DISCOUNT_SCHEDULER_H
+#define DISCOUNT_SCHEDULER_H
+
+#include "product_manager.h"
+#include "timer_wheel.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+
+// 定时折扣窗口：[startTime, endTime) 内商品按 discount 出售
+struct DiscountWindow {
+    uint64_t windowId;
+    std::string merchantName;
+    std::string productType;        // 按类型设置时为类型名，开始时展开为该商家该类型的全部商品
+    std::vector<int> productIds;    // 按商品设置时的商品ID；按类型设置时开始后为展开的商品
+    double discount;
+    int64_t startTime;              // Unix 时间（毫秒）
+    int64_t endTime;
+    bool started;
+};
+
+// 正被定时折扣覆盖的商品。windowIds 为覆盖它的窗口（按开始先后），最后一个生效，全部结束后恢复 base；
+// applied 为最近一次写入的折扣，当前折扣与之不同说明商家期间手动修改过，以手动值为准不再恢复
+struct DiscountOverride {
+    double base;
+    double applied;
+    std::vector<uint64_t> windowIds;
+};
+
+/**
+ * @brief 定时折扣调度
+ * 窗口的开始和结束各是时间轮上的一个定时器，后台线程每 TICK_MS 推进一次时间轮，
+ * 同一 tick 内到期的全部窗口合成一批交给 ProductManager，目录版本号每 tick 最多加一。
+ * 窗口可以重叠，每个商品按覆盖它的窗口计算生效折扣，窗口按任意顺序结束都能恢复到最初的折扣。
+ * 窗口保存在快照容器文件中，服务器重启后继续调度，停机期间错过的开始和结束在第一个 tick 补上。
+ */
+class DiscountScheduler {
+public:
+    static const int64_t TICK_MS = 100;
+    static const int64_t MIN_WINDOW_MS = 1000;          // 窗口最短持续时间
+    static const size_t MAX_WINDOW_PRODUCTS = 10000;    // 按商品设置时一个窗口的商品数上限
+
+    DiscountScheduler(ProductManager& productManager, const std::string& filename);
+    ~DiscountScheduler();
+
+    // 添加窗口，时间为 Unix 毫秒；productType 与 productIds 二选一，商品归属由调用方校验
+    bool scheduleWindow(const std::string& merchantName, const std::string& productType,
+        const std::vector<int>& productIds, double discount, int64_t startTime, int64_t endTime,
+        uint64_t& windowId, std::string& error);
+
+    size_t getWindowCount() const;
+
+    static int64_t nowMillis();
+
+private:
+    ProductManager& productManager;
+    std::string filename;
+    std::unordered_map<uint64_t, DiscountWindow> windows;
+    std::unordered_map<int, DiscountOverride> overrides;    // 商品ID -> 覆盖状态
+    TimerWheel wheel;
+    uint64_t nextWindowId;
+    mutable std::mutex schedulerMutex;
+
+    std::thread tickThread;
+    std::condition_variable tickCv;
+    bool stopping;
+
+    static const uint32_t SCHEDULE_RECORD_VERSION = 1;
+    static const uint32_t WINDOWS_PER_BLOCK = 1024;
+    static const uint8_t WINDOW_RECORD = 0;     // 文件中的两种记录
+    static const uint8_t OVERRIDE_RECORD = 1;
+
+    // 定时器ID = 窗口ID * 2 + 事件（0 开始，1 结束）
+    static uint64_t startTimer(uint64_t windowId) { return windowId * 2; }
+    static uint64_t endTimer(uint64_t windowId) { return windowId * 2 + 1; }
+    // 不早于 millis 的第一个 tick，保证折扣不会提前开始或结束
+    static uint64_t tickAtOrAfter(int64_t millis);
+
+    void tickLoop();
+    void processTick(uint64_t tick);        // 以下方法调用方需持有schedulerMutex
+    void addTimers(const DiscountWindow& window);
+    void loadWindows();
+    void saveWindows();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "epoch_manager.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+const size_t EpochManager::MAX_READERS;
+
+EpochManager::EpochManager() : globalEpoch(1) {
+    for (auto& slot : slots) {
+        slot.epoch.store(0, std::memory_order_relaxed);
+    }
+}
+
+EpochManager::~EpochManager() {
+    retired.clear();
+}
+
+size_t EpochManager::enter() {
+    // 从线程ID对应的槽位开始找空槽位，同一线程通常落在同一条缓存行上
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS;
+    while (true) {
+        for (size_t i = 0; i < MAX_READERS; ++i) {
+            ReaderSlot& slot = slots[(start + i) % MAX_READERS];
+            if (slot.epoch.load(std::memory_order_relaxed) != 0) {
+                continue;
+            }
+            // 登记的纪元可能已经落后于全局纪元，只会让回收更保守
+            uint64_t expected = 0;
+            if (slot.epoch.compare_exchange_strong(expected, globalEpoch.load())) {
+                return (start + i) % MAX_READERS;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+void EpochManager::leave(size_t slot) {
+    slots[slot].epoch.store(0, std::memory_order_release);
+}
+
+void EpochManager::retire(std::unique_ptr<Product> product) {
+    if (!product) {
+        return;
+    }
+    // 调用方已经摘除了商品，此后登记的读者纪元都大于 epoch，不可能再查到它
+    uint64_t epoch = globalEpoch.fetch_add(1);
+    std::lock_guard<std::mutex> lock(retiredMutex);
+    retired.push_back({ epoch, std::move(product) });
+}
+
+uint64_t EpochManager::oldestReaderEpoch() const {
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (const auto& slot : slots) {
+        uint64_t epoch = slot.epoch.load();
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
+
+size_t EpochManager::reclaim() {
+    // 在锁外析构，避免释放商品时阻塞 retire
+    std::vector<RetiredProduct> freed;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        if (retired.empty()) {
+            return 0;
+        }
+        uint64_t oldest = oldestReaderEpoch();
+        auto split = std::partition(retired.begin(), retired.end(),
+            [oldest](const RetiredProduct& item) { return item.epoch >= oldest; });
+        freed.assign(std::make_move_iterator(split), std::make_move_iterator(retired.end()));
+        retired.erase(split, retired.end());
+    }
+    return freed.size();
+}
+
+size_t EpochManager::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(retiredMutex);
+    return retired.size();
+}
\ No newline at end of file
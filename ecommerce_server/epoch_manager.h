@@ -0,0 +1,74 @@
+#ifndef EPOCH_MANAGER_H
+#define EPOCH_MANAGER_H
+
+#include "product.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 基于纪元的延迟回收
+ * 读者在访问商品对象期间用 EpochGuard 在槽位数组中登记进入时的全局纪元，不加任何锁。
+ * 写者先把商品从所有能查到它的结构中摘除，再调用 retire 交给回收器，同时把全局纪元加一。
+ * 只有当所有仍在读的读者登记的纪元都晚于退役时的纪元，才说明没有读者还拿着它，这时才释放。
+ */
+class EpochManager {
+public:
+    static const size_t MAX_READERS = 256;      // 同时在读的读者上限，槽位占满时后来者让出CPU重试
+
+    EpochManager();
+    ~EpochManager();    // 释放全部待回收的商品，此时不能再有读者
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    // 交给回收器的商品必须已经无法被新的读者查到
+    void retire(std::unique_ptr<Product> product);
+
+    // 释放已经没有读者的商品，返回释放的数量
+    size_t reclaim();
+
+    size_t getPendingCount() const;
+
+private:
+    friend class EpochGuard;
+
+    // 每个槽位独占一条缓存行，读者之间不互相干扰；0 表示空闲
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch;
+    };
+
+    struct RetiredProduct {
+        uint64_t epoch;
+        std::unique_ptr<Product> product;
+    };
+
+    std::atomic<uint64_t> globalEpoch;
+    ReaderSlot slots[MAX_READERS];
+
+    mutable std::mutex retiredMutex;
+    std::vector<RetiredProduct> retired;
+
+    size_t enter();
+    void leave(size_t slot);
+    uint64_t oldestReaderEpoch() const;     // 没有读者时返回 UINT64_MAX
+};
+
+// 读者登记：有效期间查到的商品对象不会被释放（可能已被下架或替换，读到的是当时的版本）
+class EpochGuard {
+public:
+    explicit EpochGuard(EpochManager& manager) : manager(manager), slot(manager.enter()) {}
+    ~EpochGuard() { manager.leave(slot); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+private:
+    EpochManager& manager;
+    size_t slot;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "product_columns.h"
+
+void ProductColumns::clear() {
+    ids.clear();
+    prices.clear();
+    discounts.clear();
+    priceFactors.clear();
+    stocks.clear();
+    frozenStocks.clear();
+    typeTags.clear();
+    merchantIds.clear();
+}
+
+void ProductColumns::reserve(size_t count) {
+    ids.reserve(count);
+    prices.reserve(count);
+    discounts.reserve(count);
+    priceFactors.reserve(count);
+    stocks.reserve(count);
+    frozenStocks.reserve(count);
+    typeTags.reserve(count);
+    merchantIds.reserve(count);
+}
+
+void ProductColumns::append(const Product& product, uint8_t typeTag, int merchantId) {
+    ids.push_back(product.getProductId());
+    prices.push_back(static_cast<double>(product.getOriginalPrice().getCents()));
+    discounts.push_back(product.getDiscount());
+    priceFactors.push_back(categoryPolicy(product.getCategory()).priceFactor);
+    stocks.push_back(product.getStock());
+    frozenStocks.push_back(product.getFrozenStock());
+    typeTags.push_back(typeTag);
+    merchantIds.push_back(merchantId);
+}
+
+void ProductColumns::assign(size_t row, const Product& product, uint8_t typeTag, int merchantId) {
+    ids[row] = product.getProductId();
+    prices[row] = static_cast<double>(product.getOriginalPrice().getCents());
+    discounts[row] = product.getDiscount();
+    priceFactors[row] = categoryPolicy(product.getCategory()).priceFactor;
+    stocks[row] = product.getStock();
+    frozenStocks[row] = product.getFrozenStock();
+    typeTags[row] = typeTag;
+    merchantIds[row] = merchantId;
+}
+
+namespace {
+
+template <typename T>
+void eraseColumnRows(std::vector<T>& column, const std::vector<size_t>& rows) {
+    size_t kept = 0;
+    size_t next = 0;
+    for (size_t row = 0; row < column.size(); ++row) {
+        if (next < rows.size() && rows[next] == row) {
+            next++;
+            continue;
+        }
+        column[kept++] = column[row];
+    }
+    column.resize(kept);
+}
+
+}
+
+void ProductColumns::eraseRows(const std::vector<size_t>& rows) {
+    eraseColumnRows(ids, rows);
+    eraseColumnRows(prices, rows);
+    eraseColumnRows(discounts, rows);
+    eraseColumnRows(priceFactors, rows);
+    eraseColumnRows(stocks, rows);
+    eraseColumnRows(frozenStocks, rows);
+    eraseColumnRows(typeTags, rows);
+    eraseColumnRows(merchantIds, rows);
+}
+
+std::vector<size_t> ProductColumns::filter(const ProductFilterQuery& query) const {
+    std::vector<size_t> rows;
+    ProductFilter::filter(prices.data(), discounts.data(), priceFactors.data(),
+        typeTags.data(), CategoryDiscountTerms::current(),
+        stocks.data(), frozenStocks.data(), size(), query, rows);
+    return rows;
+}
+
+std::vector<size_t> ProductColumns::filterByPriceRange(Money minPrice, Money maxPrice) const {
+    return filter(ProductFilterQuery(minPrice, maxPrice, false));
+}
+
+std::vector<size_t> ProductColumns::filterInStock() const {
+    return filter(ProductFilterQuery::anyPrice(true));
+}
+
+std::vector<size_t> ProductColumns::filterByType(uint8_t typeTag) const {
+    std::vector<size_t> rows;
+    const size_t count = size();
+    const uint8_t* tag = typeTags.data();
+    for (size_t i = 0; i < count; ++i) {
+        if (tag[i] == typeTag) {
+            rows.push_back(i);
+        }
+    }
+    return rows;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef PRODUCT_COLUMNS_H
+#define PRODUCT_COLUMNS_H
+
+#include "product.h"
+#include "product_filter.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// 从行号列表 list 中删除 erasedRows（升序）里的行，其余行号减去排在它前面的被删行数，
+// list 原有的顺序保持不变。用于删除若干行后就地修正各个索引，不必整体重建
+template <typename Row>
+void eraseAndShiftRows(std::vector<Row>& list, const std::vector<size_t>& erasedRows) {
+    size_t kept = 0;
+    for (Row row : list) {
+        auto it = std::lower_bound(erasedRows.begin(), erasedRows.end(), static_cast<size_t>(row));
+        if (it != erasedRows.end() && *it == static_cast<size_t>(row)) {
+            continue;
+        }
+        list[kept++] = static_cast<Row>(row - (it - erasedRows.begin()));
+    }
+    list.resize(kept);
+}
+
+/**
+ * @brief 商品热点字段的列式副本（结构体数组）
+ * 第 i 行与 ProductManager::products[i] 一一对应。
+ * 价格区间、有货筛选、按类别批量打折等操作只扫描连续数组，
+ * 不再逐个通过 unique_ptr 和虚函数访问商品对象。
+ */
+struct ProductColumns {
+    std::vector<int> ids;
+    std::vector<double> prices;         // 原价的分值（整数，存为 double 以便与折扣直接做向量乘法）
+    std::vector<double> discounts;      // 商品自身的折扣，类别折扣在读取时组合
+    std::vector<double> priceFactors;   // 类别定价系数，取自 CATEGORY_POLICIES
+    std::vector<int> stocks;
+    std::vector<int> frozenStocks;
+    std::vector<uint8_t> typeTags;      // 0-食品 1-书籍 2-衣服
+    std::vector<int> merchantIds;       // 商家在 SymbolTable::merchants() 中的编号
+
+    size_t size() const { return ids.size(); }
+    void clear();
+    void reserve(size_t count);
+
+    void append(const Product& product, uint8_t typeTag, int merchantId);
+    // 用 product 的当前值覆盖第 row 行（商品被替换时）
+    void assign(size_t row, const Product& product, uint8_t typeTag, int merchantId);
+    // 删除若干行（升序），其后的行前移
+    void eraseRows(const std::vector<size_t>& rows);
+
+    // 有效折扣 = 商品折扣与类别折扣的组合，现价 = 原价 * 有效折扣 * 类别系数（四舍五入到分），与 Product::getPrice 一致
+    double effectiveDiscount(size_t row) const {
+        return CategoryDiscounts::effectiveDiscount(static_cast<ProductCategory>(typeTags[row]), discounts[row]);
+    }
+    Money effectivePrice(size_t row) const {
+        return Money::fromCents(Money::roundCents(prices[row] * effectiveDiscount(row) * priceFactors[row]));
+    }
+
+    // 以下查询均返回行号；价格与库存条件由 ProductFilter 的向量化实现求值
+    std::vector<size_t> filter(const ProductFilterQuery& query) const;
+    std::vector<size_t> filterByPriceRange(Money minPrice, Money maxPrice) const;
+    std::vector<size_t> filterInStock() const;
+    std::vector<size_t> filterByType(uint8_t typeTag) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "product_directory.h"
+
+const size_t ProductDirectory::PAGE_SIZE;
+const size_t ProductDirectory::MAX_PAGES;
+
+ProductDirectory::ProductDirectory() : pages(new std::atomic<std::atomic<Product*>*>[MAX_PAGES]) {
+    for (size_t i = 0; i < MAX_PAGES; ++i) {
+        pages[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ProductDirectory::~ProductDirectory() {
+    for (size_t i = 0; i < MAX_PAGES; ++i) {
+        delete[] pages[i].load(std::memory_order_relaxed);
+    }
+}
+
+Product* ProductDirectory::find(int productId) const {
+    if (productId < 0) {
+        return nullptr;
+    }
+    size_t id = static_cast<size_t>(productId);
+    std::atomic<Product*>* page = pages[id >> PAGE_BITS].load(std::memory_order_acquire);
+    if (!page) {
+        return nullptr;
+    }
+    return page[id & (PAGE_SIZE - 1)].load();
+}
+
+void ProductDirectory::publish(int productId, Product* product) {
+    if (productId < 0) {
+        return;
+    }
+    size_t id = static_cast<size_t>(productId);
+    std::atomic<Product*>* page = pages[id >> PAGE_BITS].load(std::memory_order_acquire);
+    if (!page) {
+        if (!product) {
+            return;
+        }
+        page = new std::atomic<Product*>[PAGE_SIZE];
+        for (size_t i = 0; i < PAGE_SIZE; ++i) {
+            page[i].store(nullptr, std::memory_order_relaxed);
+        }
+        pages[id >> PAGE_BITS].store(page, std::memory_order_release);
+    }
+    // 摘除与 EpochManager::retire 中的纪元递增之间需要全序，这里用默认的顺序一致性
+    page[id & (PAGE_SIZE - 1)].store(product);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef PRODUCT_DIRECTORY_H
+#define PRODUCT_DIRECTORY_H
+
+#include "product.h"
+#include "epoch_manager.h"
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @brief 商品ID到商品对象的无锁查找表
+ * 商品ID连续分配且不复用，按ID分页存放原子指针；页一经分配就不再移动，读者不加锁直接按ID读取。
+ * 写入只在持有 productsMutex 时进行。读到的指针只能在 EpochGuard 有效期间使用。
+ */
+class ProductDirectory {
+public:
+    static const size_t PAGE_BITS = 16;
+    static const size_t PAGE_SIZE = size_t(1) << PAGE_BITS;
+    static const size_t MAX_PAGES = 32768;      // 覆盖全部非负的 int 商品ID
+
+    ProductDirectory();
+    ~ProductDirectory();
+
+    ProductDirectory(const ProductDirectory&) = delete;
+    ProductDirectory& operator=(const ProductDirectory&) = delete;
+
+    Product* find(int productId) const;
+
+    // product 为空表示摘除该商品
+    void publish(int productId, Product* product);
+
+private:
+    std::unique_ptr<std::atomic<std::atomic<Product*>*>[]> pages;
+};
+
+// 持有读者纪元的商品引用，析构前商品对象不会被释放
+class ProductRef {
+public:
+    ProductRef(EpochManager& epochs, const ProductDirectory& directory, int productId)
+        : guard(epochs), product(directory.find(productId)) {}
+
+    Product* get() const { return product; }
+    Product* operator->() const { return product; }
+    Product& operator*() const { return *product; }
+    explicit operator bool() const { return product != nullptr; }
+
+private:
+    EpochGuard guard;       // 必须先于查找登记
+    Product* product;
+};
+
+#endif
\ No newline at end of file
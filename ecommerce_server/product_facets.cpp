@@ -0,0 +1,112 @@
+#include "product_facets.h"
+#include <algorithm>
+
+namespace {
+
+// 价格区间的上界（元，不含），最后一个区间没有上界
+const int PRICE_BUCKET_BOUNDS[] = { 50, 100, 200, 500, 1000 };
+
+// 两个升序行号数组的交集大小；一边远小于另一边时对小的一边逐个二分查找
+size_t intersectCount(const std::vector<size_t>& a, const std::vector<size_t>& b) {
+    const std::vector<size_t>& small = a.size() <= b.size() ? a : b;
+    const std::vector<size_t>& large = a.size() <= b.size() ? b : a;
+    size_t count = 0;
+    if (small.size() * 16 < large.size()) {
+        for (size_t row : small) {
+            if (std::binary_search(large.begin(), large.end(), row)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < small.size() && j < large.size()) {
+        if (small[i] < large[j]) {
+            i++;
+        }
+        else if (large[j] < small[i]) {
+            j++;
+        }
+        else {
+            count++;
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+
+}
+
+FacetCounts::FacetCounts()
+    : total(0), inStock(0), categories(CATEGORY_COUNT, 0), priceBuckets(ProductFacets::PRICE_BUCKET_COUNT, 0) {
+}
+
+size_t ProductFacets::priceBucket(Money price) {
+    size_t bucket = 0;
+    while (bucket < PRICE_BUCKET_COUNT - 1 && price.getCents() >= PRICE_BUCKET_BOUNDS[bucket] * 100LL) {
+        bucket++;
+    }
+    return bucket;
+}
+
+std::string ProductFacets::bucketLabel(size_t bucket) {
+    if (bucket >= PRICE_BUCKET_COUNT - 1) {
+        return std::to_string(PRICE_BUCKET_BOUNDS[PRICE_BUCKET_COUNT - 2]) + "+";
+    }
+    int lower = bucket == 0 ? 0 : PRICE_BUCKET_BOUNDS[bucket - 1];
+    return std::to_string(lower) + "-" + std::to_string(PRICE_BUCKET_BOUNDS[bucket]);
+}
+
+void ProductFacets::clear() {
+    counts = FacetCounts();
+}
+
+void ProductFacets::addRow(const ProductColumns& columns, size_t row) {
+    applyRow(columns, row, 1);
+}
+
+void ProductFacets::removeRow(const ProductColumns& columns, size_t row) {
+    applyRow(columns, row, -1);
+}
+
+void ProductFacets::applyRow(const ProductColumns& columns, size_t row, int delta) {
+    size_t merchantId = static_cast<size_t>(columns.merchantIds[row]);
+    if (merchantId >= counts.merchants.size()) {
+        counts.merchants.resize(merchantId + 1, 0);
+    }
+
+    counts.total += delta;
+    counts.categories[columns.typeTags[row]] += delta;
+    counts.merchants[merchantId] += delta;
+    counts.priceBuckets[priceBucket(columns.effectivePrice(row))] += delta;
+    if (columns.stocks[row] - columns.frozenStocks[row] > 0) {
+        counts.inStock += delta;
+    }
+}
+
+FacetCounts ProductFacets::countRows(const ProductColumns& columns, const std::vector<size_t>& rows,
+    const std::vector<std::vector<size_t>>& categoryRows) {
+    FacetCounts result;
+    result.total = rows.size();
+
+    for (size_t category = 0; category < categoryRows.size() && category < CATEGORY_COUNT; ++category) {
+        result.categories[category] = intersectCount(rows, categoryRows[category]);
+    }
+
+    // 商家数量可能很多，逐个求交不划算，直接按商家列计数；价格区间和库存同样按列计数
+    for (size_t row : rows) {
+        size_t merchantId = static_cast<size_t>(columns.merchantIds[row]);
+        if (merchantId >= result.merchants.size()) {
+            result.merchants.resize(merchantId + 1, 0);
+        }
+        result.merchants[merchantId]++;
+        result.priceBuckets[priceBucket(columns.effectivePrice(row))]++;
+        if (columns.stocks[row] - columns.frozenStocks[row] > 0) {
+            result.inStock++;
+        }
+    }
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef PRODUCT_FACETS_H
+#define PRODUCT_FACETS_H
+
+#include "product_columns.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// 分面统计：商品总数、有可售库存的数量，以及按类别 / 商家 / 现价区间的数量
+struct FacetCounts {
+    size_t total;
+    size_t inStock;
+    std::vector<size_t> categories;     // 下标为类别标签
+    std::vector<size_t> merchants;      // 下标为商家在 SymbolTable::merchants() 中的编号
+    std::vector<size_t> priceBuckets;   // 下标为 ProductFacets::priceBucket 的返回值
+
+    FacetCounts();
+};
+
+/**
+ * @brief 增量维护的全目录分面计数
+ * 新增商品时 addRow；某行的现价或库存变化时，先 removeRow 再修改列数据再 addRow，
+ * 浏览页取分面不需要扫描整个目录。
+ * 搜索结果的分面由 countRows 计算：类别通过与类别倒排表求交得到。
+ */
+class ProductFacets {
+public:
+    static const size_t PRICE_BUCKET_COUNT = 6;
+
+    // 现价所在的区间：0-50, 50-100, 100-200, 200-500, 500-1000, 1000以上
+    static size_t priceBucket(Money price);
+    static std::string bucketLabel(size_t bucket);
+
+    void clear();
+    void addRow(const ProductColumns& columns, size_t row);
+    void removeRow(const ProductColumns& columns, size_t row);
+
+    const FacetCounts& getCounts() const { return counts; }
+
+    // 统计任意结果集（行号升序）的分面；categoryRows 为各类别的行号倒排表（升序）
+    static FacetCounts countRows(const ProductColumns& columns, const std::vector<size_t>& rows,
+        const std::vector<std::vector<size_t>>& categoryRows);
+
+private:
+    FacetCounts counts;
+
+    void applyRow(const ProductColumns& columns, size_t row, int delta);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "product_filter.h"
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PRODUCT_FILTER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang 需要为单个函数开启 AVX2 指令，MSVC 不需要
+#if defined(PRODUCT_FILTER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+typedef void (*FilterKernel)(const double*, const double*, const double*, const uint8_t*,
+    const CategoryDiscountTerms&, const int*, const int*, size_t, const ProductFilterQuery&, std::vector<size_t>&);
+
+inline bool matchRow(const double* prices, const double* discounts, const double* priceFactors,
+    const uint8_t* typeTags, const CategoryDiscountTerms& terms,
+    const int* stocks, const int* frozenStocks, size_t i, const ProductFilterQuery& query) {
+    double discount = discounts[i] * terms.scale[typeTags[i]];
+    double cap = terms.cap[typeTags[i]];
+    double rounded = prices[i] * (discount < cap ? discount : cap) * priceFactors[i] + 0.5;
+    if (!(rounded >= query.lowerBound && rounded < query.upperBound)) {
+        return false;
+    }
+    return !query.inStockOnly || stocks[i] - frozenStocks[i] > 0;
+}
+
+void filterScalar(const double* prices, const double* discounts, const double* priceFactors,
+    const uint8_t* typeTags, const CategoryDiscountTerms& terms,
+    const int* stocks, const int* frozenStocks, size_t count,
+    const ProductFilterQuery& query, std::vector<size_t>& rows) {
+    for (size_t i = 0; i < count; ++i) {
+        if (matchRow(prices, discounts, priceFactors, typeTags, terms, stocks, frozenStocks, i, query)) {
+            rows.push_back(i);
+        }
+    }
+}
+
+#ifdef PRODUCT_FILTER_X86
+
+// 把比较掩码里置位的行号依次追加
+inline void appendMaskedRows(int mask, size_t base, std::vector<size_t>& rows) {
+    while (mask) {
+        int bit = 0;
+        while (!(mask & (1 << bit))) {
+            bit++;
+        }
+        rows.push_back(base + bit);
+        mask &= mask - 1;
+    }
+}
+
+void filterSse2(const double* prices, const double* discounts, const double* priceFactors,
+    const uint8_t* typeTags, const CategoryDiscountTerms& terms,
+    const int* stocks, const int* frozenStocks, size_t count,
+    const ProductFilterQuery& query, std::vector<size_t>& rows) {
+    const __m128d lowerBound = _mm_set1_pd(query.lowerBound);
+    const __m128d upperBound = _mm_set1_pd(query.upperBound);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d zero = _mm_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        // 类别参数按标签逐行查表（表只有几项，常驻缓存）
+        __m128d scale = _mm_set_pd(terms.scale[typeTags[i + 1]], terms.scale[typeTags[i]]);
+        __m128d cap = _mm_set_pd(terms.cap[typeTags[i + 1]], terms.cap[typeTags[i]]);
+        __m128d discount = _mm_min_pd(_mm_mul_pd(_mm_loadu_pd(discounts + i), scale), cap);
+        __m128d rounded = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(prices + i), discount),
+            _mm_loadu_pd(priceFactors + i)), half);
+        __m128d mask = _mm_and_pd(_mm_cmpge_pd(rounded, lowerBound), _mm_cmplt_pd(rounded, upperBound));
+        if (query.inStockOnly) {
+            __m128i stock = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(stocks + i));
+            __m128i frozen = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(frozenStocks + i));
+            __m128d available = _mm_cvtepi32_pd(_mm_sub_epi32(stock, frozen));
+            mask = _mm_and_pd(mask, _mm_cmpgt_pd(available, zero));
+        }
+        appendMaskedRows(_mm_movemask_pd(mask), i, rows);
+    }
+    for (; i < count; ++i) {
+        if (matchRow(prices, discounts, priceFactors, typeTags, terms, stocks, frozenStocks, i, query)) {
+            rows.push_back(i);
+        }
+    }
+}
+
+TARGET_AVX2
+void filterAvx2(const double* prices, const double* discounts, const double* priceFactors,
+    const uint8_t* typeTags, const CategoryDiscountTerms& terms,
+    const int* stocks, const int* frozenStocks, size_t count,
+    const ProductFilterQuery& query, std::vector<size_t>& rows) {
+    const __m256d lowerBound = _mm256_set1_pd(query.lowerBound);
+    const __m256d upperBound = _mm256_set1_pd(query.upperBound);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d zero = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d scale = _mm256_set_pd(terms.scale[typeTags[i + 3]], terms.scale[typeTags[i + 2]],
+            terms.scale[typeTags[i + 1]], terms.scale[typeTags[i]]);
+        __m256d cap = _mm256_set_pd(terms.cap[typeTags[i + 3]], terms.cap[typeTags[i + 2]],
+            terms.cap[typeTags[i + 1]], terms.cap[typeTags[i]]);
+        __m256d discount = _mm256_min_pd(_mm256_mul_pd(_mm256_loadu_pd(discounts + i), scale), cap);
+        __m256d rounded = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(prices + i), discount),
+            _mm256_loadu_pd(priceFactors + i)), half);
+        __m256d mask = _mm256_and_pd(_mm256_cmp_pd(rounded, lowerBound, _CMP_GE_OQ),
+            _mm256_cmp_pd(rounded, upperBound, _CMP_LT_OQ));
+        if (query.inStockOnly) {
+            __m128i stock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stocks + i));
+            __m128i frozen = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frozenStocks + i));
+            __m256d available = _mm256_cvtepi32_pd(_mm_sub_epi32(stock, frozen));
+            mask = _mm256_and_pd(mask, _mm256_cmp_pd(available, zero, _CMP_GT_OQ));
+        }
+        appendMaskedRows(_mm256_movemask_pd(mask), i, rows);
+    }
+    for (; i < count; ++i) {
+        if (matchRow(prices, discounts, priceFactors, typeTags, terms, stocks, frozenStocks, i, query)) {
+            rows.push_back(i);
+        }
+    }
+}
+
+bool cpuSupportsAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return false;
+    }
+    // 操作系统需要保存 YMM 寄存器状态
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+struct KernelChoice {
+    FilterKernel kernel;
+    const char* name;
+};
+
+KernelChoice chooseKernel() {
+#ifdef PRODUCT_FILTER_X86
+    if (cpuSupportsAvx2()) {
+        return { filterAvx2, "AVX2" };
+    }
+    return { filterSse2, "SSE2" };
+#else
+    return { filterScalar, "标量" };
+#endif
+}
+
+const KernelChoice& activeKernel() {
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+}
+
+ProductFilterQuery ProductFilterQuery::anyPrice(bool inStockOnly) {
+    const double unbounded = std::numeric_limits<double>::infinity();
+    return ProductFilterQuery(-unbounded, unbounded, inStockOnly);
+}
+
+CategoryDiscountTerms CategoryDiscountTerms::current() {
+    CategoryDiscountTerms terms;
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i) {
+        CategoryDiscounts::getTerms(static_cast<ProductCategory>(i), terms.scale[i], terms.cap[i]);
+    }
+    return terms;
+}
+
+void ProductFilter::filter(const double* prices, const double* discounts, const double* priceFactors,
+    const uint8_t* typeTags, const CategoryDiscountTerms& terms,
+    const int* stocks, const int* frozenStocks, size_t count,
+    const ProductFilterQuery& query, std::vector<size_t>& rows) {
+    activeKernel().kernel(prices, discounts, priceFactors, typeTags, terms, stocks, frozenStocks, count, query, rows);
+}
+
+const char* ProductFilter::getKernelName() {
+    return activeKernel().name;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef PRODUCT_FILTER_H
+#define PRODUCT_FILTER_H
+
+#include "product.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// 各类别折扣的组合参数，下标为类别标签：有效折扣 = min(商品折扣 * scale, cap)，见 CategoryDiscounts
+struct CategoryDiscountTerms {
+    double scale[CATEGORY_COUNT];
+    double cap[CATEGORY_COUNT];
+
+    static CategoryDiscountTerms current();
+};
+
+// 筛选条件：现价（原价*有效折扣*类别系数，四舍五入到分）在 [minPrice, maxPrice] 内，且可选要求有可售库存。
+// 四舍五入即 floor(x + 0.5)，所以只需比较 minPrice <= x + 0.5 < maxPrice + 1分，向量化实现不必逐行取整
+struct ProductFilterQuery {
+    double lowerBound;      // minPrice 的分值
+    double upperBound;      // maxPrice 的分值 + 1（不含）
+    bool inStockOnly;       // 要求 stock - frozenStock > 0
+
+    ProductFilterQuery(Money minPrice, Money maxPrice, bool inStockOnly)
+        : lowerBound(static_cast<double>(minPrice.getCents())),
+        upperBound(static_cast<double>(maxPrice.getCents()) + 1.0), inStockOnly(inStockOnly) {}
+
+    // 不限价格
+    static ProductFilterQuery anyPrice(bool inStockOnly);
+
+private:
+    ProductFilterQuery(double lowerBound, double upperBound, bool inStockOnly)
+        : lowerBound(lowerBound), upperBound(upperBound), inStockOnly(inStockOnly) {}
+};
+
+/**
+ * @brief 列式商品数据上的批量谓词求值
+ * 启动时检测CPU，依次选用 AVX2 / SSE2 / 标量实现，三者结果完全一致。
+ */
+class ProductFilter {
+public:
+    // 在 count 行列数据上求值，匹配的行号追加到 rows
+    static void filter(const double* prices, const double* discounts, const double* priceFactors,
+        const uint8_t* typeTags, const CategoryDiscountTerms& terms,
+        const int* stocks, const int* frozenStocks, size_t count,
+        const ProductFilterQuery& query, std::vector<size_t>& rows);
+
+    // 当前使用的实现名称（"AVX2" / "SSE2" / "标量"）
+    static const char* getKernelName();
+};
+
+#endif
\ No newline at end of file
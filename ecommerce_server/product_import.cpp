@@ -0,0 +1,183 @@
+#include "product_import.h"
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+namespace {
+
+// 每个线程至少处理的行数，行数太少时单线程解析更快
+const size_t MIN_LINES_PER_THREAD = 4096;
+
+enum LineStatus : uint8_t {
+    LINE_OK = 0,
+    LINE_SKIPPED = 1,
+    LINE_INVALID = 2
+};
+
+struct LineSpan {
+    const char* begin;
+    const char* end;
+};
+
+void trim(const char*& begin, const char*& end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        begin++;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        end--;
+    }
+}
+
+bool parseDouble(const std::string& text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* parsedEnd = nullptr;
+    value = std::strtod(text.c_str(), &parsedEnd);
+    return parsedEnd == text.c_str() + text.size() && std::isfinite(value);
+}
+
+bool parseInt(const std::string& text, int& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* parsedEnd = nullptr;
+    long parsed = std::strtol(text.c_str(), &parsedEnd, 10);
+    if (parsedEnd != text.c_str() + text.size() || parsed < INT_MIN || parsed > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+}
+
+bool ProductImportParser::parseLine(const char* begin, const char* end, ProductImportRow& row, std::string& error) {
+    std::string fields[5];
+    size_t fieldCount = 0;
+    const char* fieldBegin = begin;
+    for (const char* p = begin; ; ++p) {
+        if (p == end || *p == ',') {
+            if (fieldCount == 5) {
+                error = "字段过多";
+                return false;
+            }
+            const char* b = fieldBegin;
+            const char* e = p;
+            trim(b, e);
+            fields[fieldCount++].assign(b, e);
+            if (p == end) {
+                break;
+            }
+            fieldBegin = p + 1;
+        }
+    }
+    if (fieldCount < 4) {
+        error = "字段不足，格式为 类型,名称,原价,库存[,折扣]";
+        return false;
+    }
+
+    if (!categoryFromName(fields[0], row.category)) {
+        error = "无效的商品类型: " + fields[0];
+        return false;
+    }
+
+    // 名称会出现在以 | 和 ; 分隔的列表响应中
+    const std::string& name = fields[1];
+    if (name.empty() || name.size() > MAX_NAME_LENGTH || name.find_first_of("|;") != std::string::npos) {
+        error = "商品名称为空、过长或包含 | ;";
+        return false;
+    }
+    row.name = name;
+
+    if (!Money::parse(fields[2], row.price) || row.price < Money()) {
+        error = "无效的价格（最多两位小数）: " + fields[2];
+        return false;
+    }
+    if (!parseInt(fields[3], row.stock) || row.stock < 0) {
+        error = "无效的库存: " + fields[3];
+        return false;
+    }
+    row.discount = 1.0;
+    if (fieldCount == 5 && (!parseDouble(fields[4], row.discount) || row.discount <= 0.0 || row.discount > 1.0)) {
+        error = "折扣必须在0.0到1.0之间: " + fields[4];
+        return false;
+    }
+    return true;
+}
+
+bool ProductImportParser::parse(const std::string& csv, std::vector<ProductImportRow>& rows,
+    std::vector<std::string>& errors) {
+    rows.clear();
+    errors.clear();
+
+    // 先顺序切分行（只扫描换行符），再并行解析
+    std::vector<LineSpan> lines;
+    const char* data = csv.data();
+    const char* dataEnd = data + csv.size();
+    while (data < dataEnd) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', dataEnd - data));
+        const char* lineEnd = newline ? newline : dataEnd;
+        lines.push_back({ data, lineEnd });
+        data = lineEnd + 1;
+    }
+
+    size_t lineCount = lines.size();
+    std::vector<ProductImportRow> parsed(lineCount);
+    std::vector<uint8_t> status(lineCount, LINE_SKIPPED);
+    std::vector<std::string> lineErrors(lineCount);
+
+    auto parseRange = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const char* begin = lines[i].begin;
+            const char* end = lines[i].end;
+            trim(begin, end);
+            if (begin == end || *begin == '#') {
+                continue;
+            }
+            status[i] = parseLine(begin, end, parsed[i], lineErrors[i]) ? LINE_OK : LINE_INVALID;
+        }
+    };
+
+    size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, std::max<size_t>(1, lineCount / MIN_LINES_PER_THREAD));
+    if (threadCount == 1) {
+        parseRange(0, lineCount);
+    }
+    else {
+        std::vector<std::thread> workers;
+        size_t chunk = (lineCount + threadCount - 1) / threadCount;
+        for (size_t first = 0; first < lineCount; first += chunk) {
+            workers.emplace_back(parseRange, first, std::min(lineCount, first + chunk));
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    size_t validCount = 0;
+    for (size_t i = 0; i < lineCount; ++i) {
+        if (status[i] == LINE_INVALID) {
+            if (errors.size() < MAX_ERRORS) {
+                errors.push_back("第" + std::to_string(i + 1) + "行: " + lineErrors[i]);
+            }
+        }
+        else if (status[i] == LINE_OK) {
+            validCount++;
+        }
+    }
+    if (!errors.empty()) {
+        return false;
+    }
+
+    rows.reserve(validCount);
+    for (size_t i = 0; i < lineCount; ++i) {
+        if (status[i] == LINE_OK) {
+            rows.push_back(std::move(parsed[i]));
+        }
+    }
+    return true;
+}
\ No newline at end of file
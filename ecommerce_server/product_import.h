@@ -0,0 +1,35 @@
+#ifndef PRODUCT_IMPORT_H
+#define PRODUCT_IMPORT_H
+
+#include "product.h"
+#include <string>
+#include <vector>
+
+// 批量导入中的一行商品（商家由登录用户决定，ID 在写入时统一分配）
+struct ProductImportRow {
+    ProductCategory category;
+    std::string name;
+    Money price;
+    int stock;
+    double discount;
+};
+
+/**
+ * @brief 商家批量导入的 CSV 解析与校验
+ * 每行格式: 类型,名称,原价,库存[,折扣]，空行和以 # 开头的行忽略。
+ * 行数较多时按行切块多线程解析，结果保持原始行顺序。
+ */
+class ProductImportParser {
+public:
+    static const size_t MAX_ERRORS = 20;            // 最多返回的错误行数
+    static const size_t MAX_NAME_LENGTH = 1000;     // 与快照读取时的名称长度上限一致
+
+    // 全部行合法时返回true；否则 rows 为空，errors 中为 "第N行: 原因"
+    static bool parse(const std::string& csv, std::vector<ProductImportRow>& rows,
+        std::vector<std::string>& errors);
+
+private:
+    static bool parseLine(const char* begin, const char* end, ProductImportRow& row, std::string& error);
+};
+
+#endif
\ No newline at end of file
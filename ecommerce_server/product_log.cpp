@@ -0,0 +1,204 @@
+#include "product_log.h"
+#include "crc32c.h"
+#include <iostream>
+#include <filesystem>
+
+ProductLog::ProductLog(const std::string& filename)
+    : filename(filename), recordCount(0), batching(false), batchRecords(0) {
+}
+
+ProductLog::~ProductLog() {
+    close();
+}
+
+bool ProductLog::open() {
+    out.open(filename, std::ios::binary | std::ios::app);
+    if (!out.is_open()) {
+        std::cerr << "无法打开商品日志文件: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ProductLog::close() {
+    if (out.is_open()) {
+        out.close();
+    }
+}
+
+std::string ProductLog::beginRecord(ProductLogOp op, int productId) {
+    std::string record(1, static_cast<char>(op));
+    record.append(reinterpret_cast<const char*>(&productId), sizeof(productId));
+    return record;
+}
+
+void ProductLog::write(const std::string& record, size_t records) {
+    // 每次写出立即刷到操作系统，避免进程崩溃丢失
+    out.write(record.data(), static_cast<std::streamsize>(record.size()));
+    out.flush();
+    if (out.fail()) {
+        std::cerr << "写入商品日志失败: " << filename << std::endl;
+        out.clear();
+        return;
+    }
+    recordCount += records;
+}
+
+void ProductLog::commit(const std::string& record) {
+    if (batching) {
+        batch.append(record);
+        batchRecords++;
+        return;
+    }
+    write(record, 1);
+}
+
+void ProductLog::appendAdd(const Product& product) {
+    if (!out.is_open()) return;
+    std::string record = beginRecord(ProductLogOp::ADD, product.getProductId());
+    product.appendRecord(record);
+    commit(record);
+}
+
+void ProductLog::appendPrice(int productId, Money price) {
+    if (!out.is_open()) return;
+    std::string record = beginRecord(ProductLogOp::PRICE, productId);
+    int64_t cents = price.getCents();
+    record.append(reinterpret_cast<const char*>(&cents), sizeof(cents));
+    commit(record);
+}
+
+void ProductLog::appendStock(int productId, int stock) {
+    if (!out.is_open()) return;
+    std::string record = beginRecord(ProductLogOp::STOCK, productId);
+    record.append(reinterpret_cast<const char*>(&stock), sizeof(stock));
+    commit(record);
+}
+
+void ProductLog::appendDiscount(int productId, double discount) {
+    if (!out.is_open()) return;
+    std::string record = beginRecord(ProductLogOp::DISCOUNT, productId);
+    record.append(reinterpret_cast<const char*>(&discount), sizeof(discount));
+    commit(record);
+}
+
+void ProductLog::appendFreeze(int productId, int frozenStock) {
+    if (!out.is_open()) return;
+    std::string record = beginRecord(ProductLogOp::FREEZE, productId);
+    record.append(reinterpret_cast<const char*>(&frozenStock), sizeof(frozenStock));
+    commit(record);
+}
+
+void ProductLog::appendRemove(int productId) {
+    if (!out.is_open()) return;
+    commit(beginRecord(ProductLogOp::REMOVE, productId));
+}
+
+void ProductLog::appendReplace(const Product& product) {
+    if (!out.is_open()) return;
+    std::string record = beginRecord(ProductLogOp::REPLACE, product.getProductId());
+    product.appendRecord(record);
+    commit(record);
+}
+
+void ProductLog::beginBatch() {
+    batching = true;
+    batch.clear();
+    batchRecords = 0;
+}
+
+void ProductLog::endBatch() {
+    batching = false;
+    if (!out.is_open() || batchRecords == 0) {
+        batch.clear();
+        return;
+    }
+
+    // 批头记下字节数和校验和，整批拼成一块写出；崩溃只写了一部分时回放会整批丢弃
+    uint32_t size = static_cast<uint32_t>(batch.size());
+    uint32_t checksum = crc32c(0, batch.data(), batch.size());
+    std::string record = beginRecord(ProductLogOp::BATCH, static_cast<int>(batchRecords));
+    record.reserve(record.size() + BATCH_HEADER_SIZE + batch.size());
+    record.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    record.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    record.append(batch);
+    write(record, batchRecords);
+
+    batch.clear();
+    batch.shrink_to_fit();
+    batchRecords = 0;
+}
+
+void ProductLog::reset() {
+    close();
+    // 以截断模式重新打开即清空日志
+    out.open(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "无法截断商品日志文件: " << filename << std::endl;
+        return;
+    }
+    recordCount = 0;
+}
+
+uint64_t ProductLog::getSize() {
+    if (out.is_open()) {
+        out.flush();
+    }
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(filename, ec);
+    return ec ? 0 : size;
+}
+
+void ProductLog::discardPrefix(uint64_t offset, size_t records) {
+    uint64_t size = getSize();
+    if (size <= offset) {
+        reset();
+        return;
+    }
+
+    // 快照写入期间追加的记录搬到新文件，再整体替换日志，中途崩溃时旧日志仍然完整
+    std::string tail;
+    {
+        std::ifstream in(filename, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(offset));
+        tail.resize(static_cast<size_t>(size - offset));
+        in.read(&tail[0], static_cast<std::streamsize>(tail.size()));
+        if (!in) {
+            std::cerr << "读取商品日志失败，保留完整日志: " << filename << std::endl;
+            return;
+        }
+    }
+
+    std::string tempFilename = filename + ".tmp";
+    {
+        std::ofstream temp(tempFilename, std::ios::binary | std::ios::trunc);
+        temp.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+        temp.flush();
+        if (!temp) {
+            std::cerr << "写入商品日志失败，保留完整日志: " << tempFilename << std::endl;
+            return;
+        }
+    }
+
+    close();
+    std::error_code ec;
+    std::filesystem::rename(tempFilename, filename, ec);
+    if (ec) {
+        std::cerr << "替换商品日志失败，保留完整日志: " << ec.message() << std::endl;
+        std::filesystem::remove(tempFilename, ec);
+    }
+    else {
+        recordCount = recordCount > records ? recordCount - records : 0;
+    }
+    open();
+}
+
+bool ProductLog::truncateTo(uint64_t size) {
+    std::error_code ec;
+    std::filesystem::resize_file(filename, size, ec);
+    if (ec) {
+        std::cerr << "无法截断商品日志文件: " << filename << " (" << ec.message() << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef PRODUCT_LOG_H
+#define PRODUCT_LOG_H
+
+#include "product.h"
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+// 商品变更日志记录类型
+enum class ProductLogOp : uint8_t {
+    LEGACY_ADD = 1,     // 旧版本的新增商品（序列化的原价为 double 元），只回放不写入
+    LEGACY_PRICE = 2,   // 旧版本的修改原价（负载为 double 元），只回放不写入
+    STOCK = 3,          // 修改库存（负载为 int，记录的是修改后的绝对值）
+    DISCOUNT = 4,       // 修改折扣（负载为 double）
+    FREEZE = 5,         // 修改冻结库存（负载为 int，修改后的绝对值）
+    ADD = 6,            // 新增商品（负载为完整序列化的商品，原价为 int64 分）
+    PRICE = 7,          // 修改原价（负载为 int64 分）
+    REMOVE = 8,         // 下架商品（无负载）
+    REPLACE = 9,        // 替换商品（负载与 ADD 相同，商品ID不变）
+    BATCH = 10          // 一批修改：productId 字段为批内记录数，负载为 uint32 字节数 + uint32 CRC32C + 批内各条记录
+};
+
+/**
+ * @brief 商品变更日志（只追加）
+ * 每条记录格式: op(1字节) | productId(4字节) | 负载，先在内存中拼好再一次写出。
+ * 所有记录都写入修改后的绝对值，重复回放结果不变，
+ * 因此快照写完但日志尚未截断时崩溃也不会出错。
+ * 批量修改的记录包在一条 BATCH 记录里，回放时字节数和校验和都对得上才应用其中的记录，
+ * 崩溃时整批要么全部生效，要么全部丢弃
+ */
+class ProductLog {
+private:
+    std::string filename;
+    std::ofstream out;
+    size_t recordCount;     // 自上次截断以来追加的记录数（批内记录逐条计数）
+    bool batching;          // 批量写入期间记录先攒在 batch 中，由 endBatch 一次写出
+    std::string batch;
+    size_t batchRecords;
+
+    static std::string beginRecord(ProductLogOp op, int productId);
+    void write(const std::string& record, size_t records);
+    void commit(const std::string& record);
+
+public:
+    ProductLog(const std::string& filename);
+    ~ProductLog();
+
+    // 以追加模式打开日志文件
+    bool open();
+    void close();
+
+    void appendAdd(const Product& product);
+    void appendPrice(int productId, Money price);
+    void appendStock(int productId, int stock);
+    void appendDiscount(int productId, double discount);
+    void appendFreeze(int productId, int frozenStock);
+    void appendRemove(int productId);
+    void appendReplace(const Product& product);
+
+    // 批量修改：期间追加的记录在 endBatch 时包成一条 BATCH 记录一次写出
+    void beginBatch();
+    void endBatch();
+
+    // BATCH 记录 productId 之后的固定部分：批内字节数和 CRC32C
+    static const size_t BATCH_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    // 快照落盘后清空日志
+    void reset();
+
+    // 把日志文件截到 size 字节，丢掉崩溃留下的残缺尾部（须在 open 之前调用）
+    bool truncateTo(uint64_t size);
+
+    // 当前已写入的字节数，快照复制商品表时记下，作为快照覆盖到的日志位置
+    uint64_t getSize();
+    // 快照写完后丢掉前 offset 字节（共 records 条记录），保留快照复制之后追加的记录
+    void discardPrefix(uint64_t offset, size_t records);
+
+    size_t getRecordCount() const { return recordCount; }
+    const std::string& getFilename() const { return filename; }
+};
+
+#endif
\ No newline at end of file
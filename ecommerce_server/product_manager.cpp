@@ -1,423 +1,1982 @@
 #include "product_manager.h"
+#include "crc32c.h"
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <map>
+#include <cstring>
+
+ProductManager::ProductManager(const std::string& filename, ProductStorageMode mode)
+    : filename(filename), nextProductId(1),
+    productLog(filename + ".log"), stopCompaction(false),
+    categoryRows(CATEGORY_COUNT),
+    priceOrder(ProductSortIndex::byEffectivePrice), discountOrder(ProductSortIndex::byDiscount),
+    catalogVersion(0), storageMode(mode), categoryFilename(filename + ".categories") {
+    if (storageMode == ProductStorageMode::MAPPED_RECORDS) {
+        recordStore = std::make_unique<ProductRecordStore>(filename + ".dat", filename + ".str");
+        if (!recordStore->open()) {
+            std::cerr << "无法打开商品记录文件，改用快照+日志存储" << std::endl;
+            recordStore.reset();
+            storageMode = ProductStorageMode::SNAPSHOT_LOG;
+        }
+    }
+
+    // 类别折扣先于商品加载，建立分面计数和排序索引时按生效的折扣计算
+    loadCategoryDiscounts();
+
+    bool snapshotIntact = true;
+    if (recordStore && !recordStore->isEmpty()) {
+        loadFromRecordStore();
+    }
+    else {
+        snapshotIntact = loadProducts();
+        replayLog();
+        if (recordStore) {
+            migrateToRecordStore();
+        }
+    }
+
+    if (!recordStore) {
+        productLog.open();
+    }
+
+    // 快照损坏时即使一个商品也没读出来，也不写入示例商品
+    if (products.empty() && snapshotIntact) {
+        createSampleProducts();
+    }
 
-ProductManager::ProductManager(const std::string& filename)
-    : filename(filename), nextProductId(1) {
-    loadProducts();
+    compactionThread = std::thread(&ProductManager::compactionLoop, this);
 }
 
 ProductManager::~ProductManager() {
-    saveProducts();
+    {
+        std::lock_guard<std::mutex> lock(compactionMutex);
+        stopCompaction = true;
+    }
+    compactionCv.notify_all();
+    if (compactionThread.joinable()) {
+        compactionThread.join();
+    }
+
+    // 退出前写一次完整快照并清空日志
+    compactLog();
 }
 
 std::unique_ptr<Product> ProductManager::createProduct(const std::string& type, int id,
-    const std::string& name, double price,
+    const std::string& name, Money price,
     int stock, const std::string& merchant,
     double discount) {
-    if (type == "ʳƷ") {
+    if (type == "食品") {
         return std::make_unique<Food>(id, name, price, stock, merchant, discount);
     }
-    else if (type == "鼮") {
+    else if (type == "书籍") {
         return std::make_unique<Book>(id, name, price, stock, merchant, discount);
     }
-    else if (type == "·") {
+    else if (type == "衣服") {
         return std::make_unique<Clothing>(id, name, price, stock, merchant, discount);
     }
     return nullptr;
 }
 
 bool ProductManager::addProduct(const std::string& type, const std::string& name,
-    double price, int stock, const std::string& merchantName,
+    Money price, int stock, const std::string& merchantName,
     double discount) {
     std::lock_guard<std::mutex> lock(productsMutex);
 
     try {
         auto product = createProduct(type, nextProductId++, name, price, stock, merchantName, discount);
         if (!product) {
-            std::cout << "ЧƷ: " << type << std::endl;
-            nextProductId--; // عID
+            std::cout << "无效的商品类型: " << type << std::endl;
+            nextProductId--; // 回滚ID
             return false;
         }
 
-        products.push_back(std::move(product));
-        // 浽ļ
-        saveProductsToFile();
+        recordAdd(*product);
+        appendProduct(std::move(product));
+        notifyChangeRecorded();
 
-        std::cout << "Ʒӳɹ: " << name << " (ID: " << (nextProductId - 1) << ", : " << type << ")";
+        std::cout << "商品添加成功: " << name << " (ID: " << (nextProductId - 1) << ", 类型: " << type << ")";
         if (discount < 1.0) {
-            std::cout << " [" << static_cast<int>(discount * 100) << "]";
+            std::cout << " [" << static_cast<int>(discount * 100) << "折]";
         }
         std::cout << std::endl;
 
         return true;
     }
     catch (const std::exception& e) {
-        std::cout << "Ʒʧ: " << e.what() << std::endl;
-        nextProductId--; // عID
+        std::cout << "添加商品失败: " << e.what() << std::endl;
+        nextProductId--; // 回滚ID
         return false;
     }
 }
 
-bool ProductManager::modifyProduct(int productId, double newPrice, int newStock, double newDiscount) {
+bool ProductManager::importProducts(const std::string& merchantName, const std::vector<ProductImportRow>& rows,
+    int& firstProductId) {
     std::lock_guard<std::mutex> lock(productsMutex);
 
-    for (auto& product : products) {
-        if (product->getProductId() == productId) {
-            try {
-                if (newPrice >= 0) {
-                    product->setPrice(newPrice);
-                }
-                if (newStock >= 0) {
-                    product->setStock(newStock);
-                }
-                if (newDiscount >= 0) {
-                    product->setDiscount(newDiscount);
-                }
+    // 先全部构造，任何一行失败都不修改商品表，ID 也不会被占用
+    std::vector<std::unique_ptr<Product>> created;
+    created.reserve(rows.size());
+    try {
+        int productId = nextProductId;
+        for (const auto& row : rows) {
+            created.push_back(createProduct(categoryPolicy(row.category).typeName, productId++, row.name,
+                row.price, row.stock, merchantName, row.discount));
+        }
+    }
+    catch (const std::exception& e) {
+        std::cout << "批量导入失败: " << e.what() << std::endl;
+        return false;
+    }
 
-                // 浽ļ
-                saveProductsToFile();
-                std::cout << "Ʒ޸ĳɹ: " << product->getName() << " (ID: " << productId << ")" << std::endl;
-                return true;
-            }
-            catch (const std::exception& e) {
-                std::cout << "޸Ʒʧ: " << e.what() << std::endl;
-                return false;
-            }
+    firstProductId = nextProductId;
+    nextProductId += static_cast<int>(created.size());
+    products.reserve(products.size() + created.size());
+    for (auto& product : created) {
+        products.push_back(std::move(product));
+        indexRow(products.size() - 1);
+    }
+    // 逐个插入排序索引是 O(n) 一次，整批导入后统一重建
+    rebuildSortOrders();
+    suggestIndex.rebuild(products);
+
+    // 整批只刷盘一次：映射存储追加记录后刷盘，快照存储批量追加日志，
+    // 快照交给后台合并线程在锁外写出
+    if (recordStore) {
+        for (size_t row = products.size() - created.size(); row < products.size(); ++row) {
+            recordStore->append(*products[row], static_cast<uint8_t>(products[row]->getCategory()));
+        }
+        recordStore->setNextProductId(nextProductId);
+        recordStore->flush();
+    }
+    else {
+        productLog.beginBatch();
+        for (size_t row = products.size() - created.size(); row < products.size(); ++row) {
+            productLog.appendAdd(*products[row]);
         }
+        productLog.endBatch();
+    }
+    notifyChangeRecorded();
+
+    std::cout << "商家 [" << merchantName << "] 批量导入 " << created.size() << " 个商品 (ID "
+        << firstProductId << " - " << (nextProductId - 1) << ")" << std::endl;
+    return true;
+}
+
+namespace {
+
+// 商品折扣和类别折扣的取值范围 (0, 1]；写成取反的形式，NaN 同样不通过
+bool isValidDiscount(double discount) {
+    return discount > 0.0 && discount <= 1.0;
+}
+
+// 检查一项修改是否满足 Product 各个 setter 的前提条件（负数表示不修改该字段），
+// 通过后应用时不会抛出异常，不会出现只改了一部分字段的情况
+bool validateChange(const ProductChange& change, std::string& error) {
+    if (change.discount >= 0 && !isValidDiscount(change.discount)) {
+        error = "商品[ID:" + std::to_string(change.productId) + "]的折扣必须在0.0到1.0之间";
+        return false;
     }
+    return true;
+}
 
-    std::cout << "Ʒ: ID " << productId << std::endl;
-    return false;
 }
 
-int ProductManager::setDiscountByType(const std::string& productType, double discount) {
+bool ProductManager::modifyProduct(int productId, Money newPrice, int newStock, double newDiscount) {
     std::lock_guard<std::mutex> lock(productsMutex);
 
-    int modifiedCount = 0;
+    Product* product = findProduct(productId);
+    if (!product) {
+        std::cout << "商品不存在: ID " << productId << std::endl;
+        return false;
+    }
+
+    // 先校验全部字段，再依次修改并写日志
+    std::string error;
+    if (!validateChange(ProductChange{ productId, newPrice, newStock, newDiscount }, error)) {
+        std::cout << "修改商品失败: " << error << std::endl;
+        return false;
+    }
 
     try {
-        for (auto& product : products) {
-            if (product->getProductType() == productType) {
-                product->setDiscount(discount);
-                modifiedCount++;
-            }
+        size_t row = rowIndex.at(productId);
+        SortKeys previousKeys = sortKeysOf(row);
+        if (newPrice >= Money()) {
+            product->setPrice(newPrice);
+            recordPrice(productId, newPrice);
         }
-
-        if (modifiedCount > 0) {
-            // 浽ļ
-            saveProductsToFile();
-            std::cout << "ɹΪ " << modifiedCount << " " << productType
-                << "Ʒ " << static_cast<int>(discount * 100) << "" << std::endl;
+        if (newStock >= 0) {
+            product->setStock(newStock);
+            recordStock(productId, newStock);
+        }
+        if (newDiscount >= 0) {
+            product->setDiscount(newDiscount);
+            recordDiscount(productId, newDiscount);
         }
+        if (newPrice >= Money() || newDiscount >= 0) {
+            refreshSortOrders(row, previousKeys);
+        }
+
+        notifyChangeRecorded();
+        std::cout << "商品修改成功: " << product->getName() << " (ID: " << productId << ")" << std::endl;
+        return true;
     }
     catch (const std::exception& e) {
-        std::cout << "ۿʧ: " << e.what() << std::endl;
-        return 0;
+        std::cout << "修改商品失败: " << e.what() << std::endl;
+        return false;
     }
-
-    return modifiedCount;
 }
 
-std::vector<ProductInfo> ProductManager::getAllProducts() const {
+bool ProductManager::setDiscountByType(const std::string& productType, double discount,
+    DiscountComposition composition, int& count, std::string& error) {
+    count = 0;
+    ProductCategory category;
+    if (!categoryFromName(productType, category)) {
+        error = "无效的商品类型: " + productType;
+        return false;
+    }
+    if (!isValidDiscount(discount)) {
+        error = "折扣必须在0.0到1.0之间";
+        std::cout << "设置折扣失败: " << error << std::endl;
+        return false;
+    }
+
     std::lock_guard<std::mutex> lock(productsMutex);
 
-    std::vector<ProductInfo> result;
-    for (const auto& product : products) {
-        result.emplace_back(*product);
+    // 商品本身不修改，写盘只有很小的类别折扣文件；但现价和有效折扣变化的该类别各行仍要逐行更新
+    // 分面计数，并在排序索引中重新排序后与其余行归并（O(n + k log k)，k 为该类别商品数），
+    // 这部分内存中的工作与类别大小成正比，期间持有 productsMutex
+    const std::vector<size_t>& rows = categoryRows[static_cast<size_t>(category)];
+    for (size_t row : rows) {
+        facets.removeRow(columns, row);
     }
-    return result;
+    CategoryDiscounts::set(category, discount, composition);
+    for (size_t row : rows) {
+        facets.addRow(columns, row);
+    }
+    if (rows.size() < PARALLEL_REBUILD_THRESHOLD) {
+        priceOrder.resortRows(columns, rows);
+        discountOrder.resortRows(columns, rows);
+    }
+    else {
+        std::thread priceThread([this, &rows] { priceOrder.resortRows(columns, rows); });
+        discountOrder.resortRows(columns, rows);
+        priceThread.join();
+    }
+    saveCategoryDiscounts();
+    notifyChangeRecorded();
+
+    std::cout << "成功为 " << rows.size() << " 个" << productType << "商品设置类别折扣 "
+        << static_cast<int>(discount * 100) << "折（"
+        << (composition == DiscountComposition::MIN ? "与商品折扣取低" : "与商品折扣叠加") << "）" << std::endl;
+    count = static_cast<int>(rows.size());
+    return true;
 }
 
-std::vector<ProductInfo> ProductManager::getProductsByPage(int page, int pageSize) const {
+bool ProductManager::applyChanges(const std::string& merchantName, const std::vector<ProductChange>& changes,
+    std::string& error) {
+    uint32_t merchantId;
+    if (!SymbolTable::merchants().find(merchantName, merchantId)) {
+        error = "商家没有任何商品";
+        return false;
+    }
+
     std::lock_guard<std::mutex> lock(productsMutex);
 
-    std::vector<ProductInfo> result;
-    int startIndex = (page - 1) * pageSize;
-    int endIndex = std::min(startIndex + pageSize, static_cast<int>(products.size()));
+    // 第一遍只校验，任何一项不通过都不做修改
+    std::vector<Product*> targets;
+    targets.reserve(changes.size());
+    for (const auto& change : changes) {
+        Product* product = findProduct(change.productId);
+        if (!product) {
+            error = "商品[ID:" + std::to_string(change.productId) + "]不存在";
+            return false;
+        }
+        if (product->getMerchantId() != merchantId) {
+            error = "您没有权限修改商品[ID:" + std::to_string(change.productId) + "]";
+            return false;
+        }
+        if (!validateChange(change, error)) {
+            return false;
+        }
+        targets.push_back(product);
+    }
 
-    for (int i = startIndex; i < endIndex; ++i) {
-        result.emplace_back(*products[i]);
+    // 改价较多时最后整体重建排序索引，比逐个删除再插入便宜；否则每项改完立即移动该行，
+    // 排序索引按旧键二分定位，要求其余行的键与索引一致
+    size_t repriced = 0;
+    for (const auto& change : changes) {
+        if (change.price >= Money() || change.discount >= 0) {
+            repriced++;
+        }
     }
+    bool rebuildSort = repriced > REBUILD_SORT_THRESHOLD;
 
-    return result;
+    // 第二遍应用（取值已全部校验，setter 不会抛出）：日志记录攒在一起，最后只刷新一次
+    if (!recordStore) {
+        productLog.beginBatch();
+    }
+    for (size_t i = 0; i < changes.size(); ++i) {
+        const ProductChange& change = changes[i];
+        Product* product = targets[i];
+        bool reprice = change.price >= Money() || change.discount >= 0;
+        size_t row = rowIndex.at(change.productId);
+        SortKeys previousKeys = sortKeysOf(row);
+        if (change.price >= Money()) {
+            product->setPrice(change.price);
+            recordPrice(change.productId, change.price);
+        }
+        if (change.stock >= 0) {
+            product->setStock(change.stock);
+            recordStock(change.productId, change.stock);
+        }
+        if (change.discount >= 0) {
+            product->setDiscount(change.discount);
+            recordDiscount(change.productId, change.discount);
+        }
+        if (reprice && !rebuildSort) {
+            refreshSortOrders(row, previousKeys);
+        }
+    }
+    if (recordStore) {
+        recordStore->flush();
+    }
+    else {
+        productLog.endBatch();
+    }
+    if (rebuildSort) {
+        rebuildSortOrders();
+    }
+
+    notifyChangeRecorded();
+    std::cout << "商家 [" << merchantName << "] 批量修改 " << changes.size() << " 个商品，目录版本 "
+        << catalogVersion.load() << std::endl;
+    return true;
 }
 
-std::vector<ProductInfo> ProductManager::searchProducts(const std::string& keyword) const {
+bool ProductManager::delistProducts(const std::string& merchantName, const std::vector<int>& productIds,
+    std::string& error) {
+    uint32_t merchantId;
+    if (!SymbolTable::merchants().find(merchantName, merchantId)) {
+        error = "商家没有任何商品";
+        return false;
+    }
+
+    // 先取涉及商品的分段锁：进行中的库存操作结束后才下架，之后的库存操作查不到这些商品
+    auto stripes = stockLocks.lockProducts(productIds);
     std::lock_guard<std::mutex> lock(productsMutex);
 
-    std::vector<ProductInfo> result;
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    std::vector<size_t> rows;
+    rows.reserve(productIds.size());
+    for (int productId : productIds) {
+        Product* product = findProduct(productId);
+        if (!product) {
+            error = "商品[ID:" + std::to_string(productId) + "]不存在";
+            return false;
+        }
+        if (product->getMerchantId() != merchantId) {
+            error = "您没有权限下架商品[ID:" + std::to_string(productId) + "]";
+            return false;
+        }
+        rows.push_back(rowIndex.at(productId));
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
 
-    for (const auto& product : products) {
-        std::string productName = product->getName();
-        std::string productType = product->getProductType();
+    // 先从查找表中摘除，之后进入的读者查不到这些商品；已经拿到指针的读者继续读旧对象
+    for (size_t row : rows) {
+        directory.publish(products[row]->getProductId(), nullptr);
+    }
+    std::vector<std::unique_ptr<Product>> removed;
+    eraseRows(rows, removed);
 
-        std::transform(productName.begin(), productName.end(), productName.begin(), ::tolower);
-        std::transform(productType.begin(), productType.end(), productType.begin(), ::tolower);
+    if (!recordStore) {
+        productLog.beginBatch();
+    }
+    for (const auto& product : removed) {
+        recordRemove(product->getProductId());
+    }
+    if (recordStore) {
+        recordStore->flush();
+    }
+    else {
+        productLog.endBatch();
+    }
+    notifyChangeRecorded();
 
-        if (productName.find(lowerKeyword) != std::string::npos ||
-            productType.find(lowerKeyword) != std::string::npos) {
-            result.emplace_back(*product);
-        }
+    for (auto& product : removed) {
+        epochs.retire(std::move(product));
     }
+    epochs.reclaim();
 
-    return result;
+    std::cout << "商家 [" << merchantName << "] 下架 " << removed.size() << " 个商品，目录版本 "
+        << catalogVersion.load() << std::endl;
+    return true;
 }
 
-std::vector<ProductInfo> ProductManager::getProductsByType(const std::string& type) const {
+bool ProductManager::replaceProduct(const std::string& merchantName, int productId, const std::string& type,
+    const std::string& name, Money price, int stock, double discount, std::string& error) {
+    // 与下架相同，先取分段锁再加productsMutex，替换前后的库存操作不会落在旧对象上
+    auto stripe = stockLocks.lockProduct(productId);
     std::lock_guard<std::mutex> lock(productsMutex);
 
-    std::vector<ProductInfo> result;
-    for (const auto& product : products) {
-        if (product->getProductType() == type) {
-            result.emplace_back(*product);
+    auto it = rowIndex.find(productId);
+    if (it == rowIndex.end()) {
+        error = "商品不存在";
+        return false;
+    }
+    size_t row = it->second;
+    if (products[row]->getMerchantName() != merchantName) {
+        error = "您没有权限修改此商品";
+        return false;
+    }
+
+    std::unique_ptr<Product> replacement;
+    try {
+        replacement = createProduct(type, productId, name, price, stock, merchantName, discount);
+        if (!replacement) {
+            error = "无效的商品类型: " + type;
+            return false;
         }
+        replacement->setFrozenStock(products[row]->getFrozenStock());
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+        return false;
     }
 
-    return result;
+    // 行号不变；名称和类别可能改变，只更新这一行在各索引中的项
+    std::unique_ptr<Product> previous = std::move(products[row]);
+    products[row] = std::move(replacement);
+    directory.publish(productId, products[row].get());
+    reindexReplacedRow(row, *previous);
+    recordReplace(*products[row]);
+    notifyChangeRecorded();
+
+    epochs.retire(std::move(previous));
+    epochs.reclaim();
+
+    std::cout << "商品替换成功: " << name << " (ID: " << productId << ", 类型: " << type << ")" << std::endl;
+    return true;
 }
 
-Product* ProductManager::getProductById(int productId) {
+size_t ProductManager::applyScheduledDiscounts(std::vector<DiscountAssignment>& assignments) {
     std::lock_guard<std::mutex> lock(productsMutex);
 
-    for (auto& product : products) {
-        if (product->getProductId() == productId) {
-            return product.get();
+    // 数量较多时最后整体重建排序索引，否则每项改完立即按旧键移动该行
+    bool rebuildSort = assignments.size() > REBUILD_SORT_THRESHOLD;
+    if (!recordStore) {
+        productLog.beginBatch();
+    }
+    size_t changed = 0;
+    for (auto& assignment : assignments) {
+        assignment.applied = false;
+        Product* product = findProduct(assignment.productId);
+        if (!product) {
+            assignment.previous = -1;
+            continue;
+        }
+        assignment.previous = product->getDiscount();
+        if (assignment.expected >= 0 && assignment.previous != assignment.expected) {
+            continue;
+        }
+        if (assignment.previous == assignment.discount) {
+            continue;
+        }
+        try {
+            product->setDiscount(assignment.discount);
         }
+        catch (const std::exception& e) {
+            std::cout << "定时折扣设置失败: 商品ID " << assignment.productId << ", " << e.what() << std::endl;
+            continue;
+        }
+        size_t row = rowIndex.at(assignment.productId);
+        SortKeys previousKeys = sortKeysOf(row);
+        recordDiscount(assignment.productId, assignment.discount);
+        if (!rebuildSort) {
+            refreshSortOrders(row, previousKeys);
+        }
+        changed++;
+        assignment.applied = true;
+    }
+    if (recordStore) {
+        recordStore->flush();
+    }
+    else {
+        productLog.endBatch();
     }
-    return nullptr;
-}
-
-size_t ProductManager::getProductCount() const {
-    std::lock_guard<std::mutex> lock(productsMutex);
-    return products.size();
-}
 
-int ProductManager::getTotalPages(int pageSize) const {
-    size_t count = getProductCount();
-    return static_cast<int>((count + pageSize - 1) / pageSize);
+    if (changed == 0) {
+        return 0;
+    }
+    if (rebuildSort) {
+        rebuildSortOrders();
+    }
+    notifyChangeRecorded();
+    return changed;
 }
 
-void ProductManager::loadProducts() {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cout << "ƷļڣʾƷ: " << filename << std::endl;
-
-        // ʾƷ - ÿ3Ʒ
-        // ʳƷ
-        addProduct("ʳƷ", "ƻ", 8.50, 100, "B", 1.0);
-        addProduct("ʳƷ", "ţ", 15.80, 50, "B", 0.9); // 9
-        addProduct("ʳƷ", "", 12.00, 80, "B", 1.0);
-
-        // 鼮
-        addProduct("鼮", "C++ Primer", 89.00, 30, "B", 0.85); // 85
-        addProduct("鼮", "Effective C++", 68.00, 25, "B", 1.0);
-        addProduct("鼮", "ϵͳ", 139.00, 15, "B", 0.9); // 9
+bool ProductManager::adjustStock(int productId, int delta) {
+    if (delta == 0) {
+        return false;
+    }
 
-        // ·
-        addProduct("·", "T", 89.00, 200, "B", 0.7); // 7
-        addProduct("·", "ţп", 299.00, 150, "B", 1.0);
-        addProduct("·", "˶Ь", 499.00, 100, "B", 0.8); // 8
+    // 库存本身由CAS更新，只持有该商品的分段锁；写变更记录时才加productsMutex。
+    // 下架和替换也持有分段锁，因此持锁后再查找，记录前商品对象不会被换掉。
+    // 加锁后重新读取当前值再记录，并发修改同一商品时最后一条记录总是最新状态
+    auto stripe = stockLocks.lockProduct(productId);
+    ProductRef product = getProductById(productId);
+    if (!product) {
+        return false;
+    }
+    bool ok = (delta < 0) ? product->reduceStock(-delta) : product->increaseStock(delta);
+    if (ok) {
+        std::lock_guard<std::mutex> lock(productsMutex);
+        recordStock(productId, product->getStock());
+        notifyChangeRecorded();
+    }
+    return ok;
+}
 
-        return;
+bool ProductManager::freezeStock(int productId, int quantity) {
+    auto stripe = stockLocks.lockProduct(productId);
+    ProductRef product = getProductById(productId);
+    if (!product || !product->freezeStock(quantity)) {
+        return false;
     }
+    std::lock_guard<std::mutex> lock(productsMutex);
+    recordFreeze(productId, product->getFrozenStock());
+    notifyChangeRecorded();
+    return true;
+}
 
-    products.clear();
+bool ProductManager::unfreezeStock(int productId, int quantity) {
+    auto stripe = stockLocks.lockProduct(productId);
+    ProductRef product = getProductById(productId);
+    if (!product || !product->unfreezeStock(quantity)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(productsMutex);
+    recordFreeze(productId, product->getFrozenStock());
+    notifyChangeRecorded();
+    return true;
+}
 
-    try {
-        // ļС
-        file.seekg(0, std::ios::end);
-        std::streamsize fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        if (fileSize < sizeof(int) + sizeof(size_t)) {
-            std::cerr << "Ʒļʽļ𻵣´" << std::endl;
-            file.close();
-            // ɾ𻵵ļ
-            std::remove(filename.c_str());
-            loadProducts(); // ݹ´
-            return;
+bool ProductManager::reserveStock(const std::vector<std::pair<int, int>>& items, int& failedProductId) {
+    // 同一商品出现多次时合并数量；std::map 按商品ID升序，即规范顺序
+    std::map<int, int> totals;
+    for (const auto& item : items) {
+        if (item.second <= 0) {
+            failedProductId = item.first;
+            return false;
         }
+        totals[item.first] += item.second;
+    }
 
-        // ȡһƷID
-        file.read(reinterpret_cast<char*>(&nextProductId), sizeof(nextProductId));
-        if (file.fail()) {
-            throw std::runtime_error("ȡƷIDʧ");
+    std::vector<int> productIds;
+    for (const auto& total : totals) {
+        productIds.push_back(total.first);
+    }
+    auto stripes = stockLocks.lockProducts(productIds);
+
+    // 持有分段锁后先全部检查，再全部扣减
+    EpochGuard guard(epochs);
+    std::vector<std::pair<Product*, int>> targets;
+    for (const auto& total : totals) {
+        Product* product = directory.find(total.first);
+        if (!product || !product->isAvailable(total.second)) {
+            failedProductId = total.first;
+            return false;
         }
+        targets.push_back({ product, total.second });
+    }
 
-        // ȡƷ
-        size_t productCount;
-        file.read(reinterpret_cast<char*>(&productCount), sizeof(productCount));
-        if (file.fail() || productCount > 10000) { // ӺԼ
-            throw std::runtime_error("ȡƷʧܻ쳣");
+    // 直接调用 Product 的修改不经过分段锁，扣减仍可能失败，失败时归还已扣的部分
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (!targets[i].first->reduceStock(targets[i].second)) {
+            for (size_t j = 0; j < i; ++j) {
+                targets[j].first->increaseStock(targets[j].second);
+            }
+            failedProductId = targets[i].first->getProductId();
+            return false;
         }
+    }
 
-        std::cout << "׼ " << productCount << " Ʒ..." << std::endl;
+    std::lock_guard<std::mutex> lock(productsMutex);
+    for (const auto& target : targets) {
+        recordStock(target.first->getProductId(), target.first->getStock());
+    }
+    notifyChangeRecorded();
+    return true;
+}
 
-        for (size_t i = 0; i < productCount; ++i) {
-            try {
-                // ȶȡƷ
-                uint32_t typeLen;
-                file.read(reinterpret_cast<char*>(&typeLen), sizeof(typeLen));
-                if (file.fail() || typeLen > 1000) {
-                    std::cerr << "ȡ " << (i + 1) << " Ʒͳʧܣ" << std::endl;
-                    break;
-                }
+void ProductManager::releaseStock(const std::vector<std::pair<int, int>>& items) {
+    std::vector<int> productIds;
+    for (const auto& item : items) {
+        productIds.push_back(item.first);
+    }
+    auto stripes = stockLocks.lockProducts(productIds);
+
+    EpochGuard guard(epochs);
+    std::vector<Product*> released;
+    for (const auto& item : items) {
+        Product* product = directory.find(item.first);
+        if (product && product->increaseStock(item.second)) {
+            released.push_back(product);
+        }
+    }
 
-                std::string type;
-                if (typeLen > 0) {
-                    type.resize(typeLen);
-                    file.read(&type[0], typeLen);
-                    if (file.fail()) {
-                        std::cerr << "ȡ " << (i + 1) << " Ʒʧܣ" << std::endl;
-                        break;
-                    }
-                }
+    std::lock_guard<std::mutex> lock(productsMutex);
+    for (Product* product : released) {
+        recordStock(product->getProductId(), product->getStock());
+    }
+    notifyChangeRecorded();
+}
 
-                // Ӧ͵Ʒ
-                auto product = createProduct(type, 0, "", 0.0, 0, "");
-                if (product) {
-                    // ¶λͳλÿʼл
-                    file.seekg(-(static_cast<std::streamoff>(sizeof(uint32_t) + typeLen)), std::ios::cur);
-                    product->deserialize(file);
-                    products.push_back(std::move(product));
-                    std::cout << "ɹƷ " << (i + 1) << "/" << productCount << std::endl;
-                }
-                else {
-                    std::cerr << "޷Ʒ: " << type << " " << (i + 1) << " Ʒ" << std::endl;
-                    break;
-                }
-            }
-            catch (const std::exception& e) {
-                std::cerr << "ص " << (i + 1) << " Ʒʱ: " << e.what() << "" << std::endl;
-                break;
-            }
+void ProductManager::recordSales(const std::vector<std::pair<int, int>>& items) {
+    std::lock_guard<std::mutex> lock(productsMutex);
+    for (const auto& item : items) {
+        auto it = rowIndex.find(item.first);
+        if (it != rowIndex.end() && item.second > 0) {
+            suggestIndex.addPopularity(it->second, static_cast<uint32_t>(item.second));
         }
+    }
+}
 
-        std::cout << "ɹ " << products.size() << " Ʒ" << std::endl;
+std::vector<ProductInfo> ProductManager::getAllProducts() const {
+    std::lock_guard<std::mutex> lock(productsMutex);
 
+    std::vector<ProductInfo> result;
+    for (const auto& product : products) {
+        result.emplace_back(*product);
     }
-    catch (const std::exception& e) {
-        std::cerr << "Ʒļʱ: " << e.what() << std::endl;
-        std::cerr << "ɾ𻵵ļ´" << std::endl;
-        products.clear();
-        nextProductId = 1;
-        file.close();
+    return result;
+}
 
-        // ɾ𻵵ļ
-        std::remove(filename.c_str());
+std::vector<ProductInfo> ProductManager::getProductsByPage(int page, int pageSize, ProductSortKey sortKey) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
 
-        // ´ʾƷ
-        loadProducts();
-        return;
+    std::vector<ProductInfo> result;
+    if (page < 1 || pageSize <= 0) {
+        return result;
     }
+    size_t startIndex = static_cast<size_t>(page - 1) * pageSize;
+    size_t endIndex = std::min(startIndex + pageSize, products.size());
 
-    file.close();
-}
+    // 排序索引已维护好，只取本页的位置
+    for (size_t i = startIndex; i < endIndex; ++i) {
+        result.emplace_back(*products[sortedRow(sortKey, i)]);
+    }
 
-void ProductManager::saveProducts() {
-    std::lock_guard<std::mutex> lock(productsMutex);
-    saveProductsToFile();
+    return result;
 }
 
-void ProductManager::saveProductsToFile() {
-    // ȱ浽ʱļ
-    std::string tempFilename = filename + ".tmp";
-    std::ofstream file(tempFilename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "޷ʱļд: " << tempFilename << std::endl;
-        return;
-    }
+std::vector<ProductInfo> ProductManager::searchProducts(const std::string& keyword,
+    ProductSortKey sortKey, size_t limit, bool fuzzy, FacetCounts* resultFacets) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
 
-    try {
-        // дһƷID
-        file.write(reinterpret_cast<const char*>(&nextProductId), sizeof(nextProductId));
+    std::vector<size_t> rows;
+    std::vector<int> distances;     // 容错搜索时与 rows 一一对应的编辑距离
+    if (!fuzzy || !fuzzyMatchRows(keyword, rows, distances)) {
+        std::string lowerKeyword = keyword;
+        std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
 
-        // дƷ
-        size_t productCount = products.size();
-        file.write(reinterpret_cast<const char*>(&productCount), sizeof(productCount));
+        for (size_t row = 0; row < products.size(); ++row) {
+            std::string productName = products[row]->getName();
+            std::transform(productName.begin(), productName.end(), productName.begin(), ::tolower);
 
-        // дƷ
-        for (size_t i = 0; i < products.size(); ++i) {
-            try {
-                products[i]->serialize(file);
-                if (file.fail()) {
-                    throw std::runtime_error("д " + std::to_string(i + 1) + " Ʒʧ");
-                }
-            }
-            catch (const std::exception& e) {
-                std::cerr << "л " << (i + 1) << " Ʒʱ: " << e.what() << std::endl;
-                throw;
+            // 类别名是固定的中文，不需要转小写，直接比较驻留的字符串
+            if (productName.find(lowerKeyword) != std::string::npos ||
+                products[row]->getProductType().find(lowerKeyword) != std::string::npos) {
+                rows.push_back(row);
             }
         }
+    }
 
-        file.close();
+    // 分面按全部匹配结果统计（截断前），此时行号仍是升序，可以直接与倒排表求交
+    if (resultFacets) {
+        *resultFacets = ProductFacets::countRows(columns, rows, categoryRows);
+    }
 
-        // ɹдʱļ滻ԭļ
-        std::remove(filename.c_str());
-        if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
-            std::cerr << "޷滻Ʒļ" << std::endl;
+    // 默认排序下容错结果按编辑距离从小到大，距离相同时保持上架顺序
+    if (!distances.empty() && sortKey == ProductSortKey::DEFAULT) {
+        std::vector<size_t> order(rows.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
         }
-        else {
-            std::cout << "ɹ " << products.size() << " Ʒļ" << std::endl;
+        std::stable_sort(order.begin(), order.end(),
+            [&distances](size_t a, size_t b) { return distances[a] < distances[b]; });
+        std::vector<size_t> ranked;
+        ranked.reserve(order.size());
+        for (size_t i : order) {
+            ranked.push_back(rows[i]);
         }
+        rows.swap(ranked);
+        if (limit > 0 && limit < rows.size()) {
+            rows.resize(limit);
+        }
+        return collectRows(rows);
+    }
 
+    // 匹配结果是任意子集，用不上维护的索引：只要前K个时用 partial_sort
+    auto before = [this, sortKey](size_t a, size_t b) { return rowBefore(sortKey, a, b); };
+    if (limit > 0 && limit < rows.size()) {
+        if (sortKey != ProductSortKey::DEFAULT) {
+            std::partial_sort(rows.begin(), rows.begin() + limit, rows.end(), before);
+        }
+        rows.resize(limit);
     }
-    catch (const std::exception& e) {
-        std::cerr << "Ʒļʱ: " << e.what() << std::endl;
-        file.close();
-        std::remove(tempFilename.c_str()); // ɾʱļ
+    else if (sortKey != ProductSortKey::DEFAULT) {
+        std::sort(rows.begin(), rows.end(), before);
     }
+
+    return collectRows(rows);
 }
 
-std::vector<ProductInfo> ProductManager::getProductsByMerchant(const std::string& merchantName) const {
-    std::lock_guard<std::mutex> lock(productsMutex);
+bool ProductManager::fuzzyMatchRows(const std::string& keyword, std::vector<size_t>& rows,
+    std::vector<int>& distances) const {
+    std::string pattern = ProductTrigramIndex::normalize(keyword);
+    int maxEdits = ProductTrigramIndex::maxEditsFor(pattern);
 
-    std::vector<ProductInfo> result;
-    for (const auto& product : products) {
-        if (product->getMerchantName() == merchantName) {
-            result.emplace_back(*product);
-        }
+    std::vector<size_t> candidates;
+    if (!nameIndex.candidates(pattern, maxEdits, products.size(), candidates)) {
+        return false;
     }
 
-    return result;
-}
+    // 类别名精确包含关键字时，该类别全部商品视为距离0的匹配
+    std::vector<bool> categoryMatched(CATEGORY_COUNT, false);
+    bool anyCategoryMatched = false;
+    for (size_t category = 0; category < CATEGORY_COUNT; ++category) {
+        categoryMatched[category] = std::string(CATEGORY_POLICIES[category].typeName).find(keyword) != std::string::npos;
+        anyCategoryMatched = anyCategoryMatched || categoryMatched[category];
+    }
 
-std::vector<ProductInfo> ProductManager::getMerchantProductsByPage(const std::string& merchantName, int page, int pageSize) const {
-    std::lock_guard<std::mutex> lock(productsMutex);
+    // 结果保持行号升序；只对候选行做编辑距离验证
+    rows.clear();
+    distances.clear();
+    auto verify = [&](size_t row) {
+        int distance = ProductTrigramIndex::substringDistance(pattern, products[row]->getName(), maxEdits);
+        if (distance <= maxEdits) {
+            rows.push_back(row);
+            distances.push_back(distance);
+        }
+    };
 
-    // ɸѡ̼ҵƷ
-    std::vector<Product*> merchantProducts;
-    for (const auto& product : products) {
-        if (product->getMerchantName() == merchantName) {
-            merchantProducts.push_back(product.get());
+    if (!anyCategoryMatched) {
+        for (size_t row : candidates) {
+            verify(row);
         }
+        return true;
     }
 
-    // ҳ
-    std::vector<ProductInfo> result;
-    int startIndex = (page - 1) * pageSize;
-    int endIndex = std::min(startIndex + pageSize, static_cast<int>(merchantProducts.size()));
-
-    for (int i = startIndex; i < endIndex; ++i) {
-        result.emplace_back(*merchantProducts[i]);
+    size_t next = 0;
+    for (size_t row = 0; row < products.size(); ++row) {
+        bool isCandidate = next < candidates.size() && candidates[next] == row;
+        if (isCandidate) {
+            next++;
+        }
+        if (categoryMatched[columns.typeTags[row]]) {
+            rows.push_back(row);
+            distances.push_back(0);
+        }
+        else if (isCandidate) {
+            verify(row);
+        }
     }
-
-    return result;
+    return true;
 }
 
-int ProductManager::getMerchantProductCount(const std::string& merchantName) const {
+std::vector<std::string> ProductManager::suggestNames(const std::string& prefix, size_t limit) const {
     std::lock_guard<std::mutex> lock(productsMutex);
+    return suggestIndex.suggest(products, prefix, limit);
+}
+
+std::vector<ProductInfo> ProductManager::getProductsByType(const std::string& type) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+
+    uint8_t typeTag = typeTagOf(type);
+    if (typeTag == TYPE_TAG_UNKNOWN) {
+        return {};
+    }
+    return collectRows(columns.filterByType(typeTag));
+}
+
+std::vector<ProductInfo> ProductManager::getProductsByPriceRange(Money minPrice, Money maxPrice) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+    return collectRows(columns.filterByPriceRange(minPrice, maxPrice));
+}
+
+std::vector<ProductInfo> ProductManager::getAvailableProducts() const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+    return collectRows(columns.filterInStock());
+}
+
+std::vector<int> ProductManager::filterProductIds(Money minPrice, Money maxPrice, bool inStockOnly) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+    std::vector<size_t> rows = columns.filter(ProductFilterQuery(minPrice, maxPrice, inStockOnly));
+
+    std::vector<int> ids;
+    ids.reserve(rows.size());
+    for (size_t row : rows) {
+        ids.push_back(columns.ids[row]);
+    }
+    return ids;
+}
+
+std::vector<ProductInfo> ProductManager::collectRows(const std::vector<size_t>& rows) const {
+    std::vector<ProductInfo> result;
+    result.reserve(rows.size());
+    for (size_t row : rows) {
+        result.emplace_back(*products[row]);
+    }
+    return result;
+}
+
+ProductManager::SortKeys ProductManager::sortKeysOf(size_t row) const {
+    return SortKeys{ priceOrder.keyOf(columns, row), discountOrder.keyOf(columns, row) };
+}
+
+void ProductManager::refreshSortOrders(size_t row, const SortKeys& previous) {
+    priceOrder.erase(columns, row, previous.price);
+    priceOrder.insert(columns, row);
+    discountOrder.erase(columns, row, previous.discount);
+    discountOrder.insert(columns, row);
+}
+
+void ProductManager::rebuildSortOrders() {
+    priceOrder.rebuild(columns);
+    discountOrder.rebuild(columns);
+}
+
+size_t ProductManager::sortedRow(ProductSortKey sortKey, size_t position) const {
+    switch (sortKey) {
+    case ProductSortKey::PRICE_ASC: return priceOrder.at(position);
+    case ProductSortKey::PRICE_DESC: return priceOrder.at(priceOrder.size() - 1 - position);
+    case ProductSortKey::DISCOUNT: return discountOrder.at(position);
+    case ProductSortKey::NEWEST: return products.size() - 1 - position;
+    default: return position;
+    }
+}
+
+bool ProductManager::rowBefore(ProductSortKey sortKey, size_t a, size_t b) const {
+    switch (sortKey) {
+    case ProductSortKey::PRICE_ASC:
+        if (columns.effectivePrice(a) != columns.effectivePrice(b)) {
+            return columns.effectivePrice(a) < columns.effectivePrice(b);
+        }
+        break;
+    case ProductSortKey::PRICE_DESC:
+        // 列表倒序遍历按现价升序的索引，同价时为商品ID降序，搜索结果保持同样的顺序
+        if (columns.effectivePrice(a) != columns.effectivePrice(b)) {
+            return columns.effectivePrice(a) > columns.effectivePrice(b);
+        }
+        return columns.ids[a] > columns.ids[b];
+    case ProductSortKey::DISCOUNT:
+        if (columns.effectiveDiscount(a) != columns.effectiveDiscount(b)) {
+            return columns.effectiveDiscount(a) < columns.effectiveDiscount(b);
+        }
+        break;
+    case ProductSortKey::NEWEST:
+        return columns.ids[a] > columns.ids[b];
+    default:
+        break;
+    }
+    return columns.ids[a] < columns.ids[b];
+}
+
+bool ProductManager::getProductsAfterCursor(const std::string& cursor, int pageSize, ProductSortKey sortKey,
+    std::vector<ProductInfo>& result, std::string& nextCursor) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+
+    result.clear();
+    nextCursor.clear();
+
+    size_t start = 0;
+    if (!cursor.empty()) {
+        ProductCursor position;
+        if (!ProductCursor::decode(cursor, position) || position.sortKey != sortKey) {
+            return false;
+        }
+        start = cursorPosition(position);
+    }
+    if (pageSize <= 0) {
+        return true;
+    }
+
+    size_t end = std::min(start + pageSize, products.size());
+    for (size_t i = start; i < end; ++i) {
+        result.emplace_back(*products[sortedRow(sortKey, i)]);
+    }
+    if (end < products.size()) {
+        size_t lastRow = sortedRow(sortKey, end - 1);
+        nextCursor = ProductCursor{ sortKey, sortKeyValue(sortKey, lastRow), columns.ids[lastRow] }.encode();
+    }
+    return true;
+}
+
+double ProductManager::sortKeyValue(ProductSortKey sortKey, size_t row) const {
+    switch (sortKey) {
+    case ProductSortKey::PRICE_ASC:
+    case ProductSortKey::PRICE_DESC:
+        return ProductSortIndex::byEffectivePrice(columns, row);
+    case ProductSortKey::DISCOUNT:
+        return columns.effectiveDiscount(row);
+    default:
+        return 0.0;     // 按ID排序，只用商品ID定位
+    }
+}
+
+size_t ProductManager::cursorPosition(const ProductCursor& cursor) const {
+    // 行号与商品ID同序，按ID的两种顺序直接在ID列上二分
+    const std::vector<int>& ids = columns.ids;
+    switch (cursor.sortKey) {
+    case ProductSortKey::PRICE_ASC:
+        return priceOrder.upperBound(columns, cursor.lastKey, cursor.lastProductId);
+    case ProductSortKey::PRICE_DESC:
+        return priceOrder.size() - priceOrder.lowerBound(columns, cursor.lastKey, cursor.lastProductId);
+    case ProductSortKey::DISCOUNT:
+        return discountOrder.upperBound(columns, cursor.lastKey, cursor.lastProductId);
+    case ProductSortKey::NEWEST:
+        return ids.size() - static_cast<size_t>(std::lower_bound(ids.begin(), ids.end(), cursor.lastProductId) - ids.begin());
+    default:
+        return static_cast<size_t>(std::upper_bound(ids.begin(), ids.end(), cursor.lastProductId) - ids.begin());
+    }
+}
+
+ProductRef ProductManager::getProductById(int productId) {
+    return ProductRef(epochs, directory, productId);
+}
+
+Product* ProductManager::findProduct(int productId) const {
+    auto it = rowIndex.find(productId);
+    if (it == rowIndex.end()) {
+        return nullptr;
+    }
+    return products[it->second].get();
+}
+
+void ProductManager::appendProduct(std::unique_ptr<Product> product) {
+    products.push_back(std::move(product));
+    size_t row = products.size() - 1;
+    indexRow(row);
+    priceOrder.insert(columns, row);
+    discountOrder.insert(columns, row);
+    suggestIndex.insert(products, row);
+}
+
+void ProductManager::indexRow(size_t row) {
+    indexColumns(row);
+    nameIndex.add(row, products[row]->getName());
+}
+
+void ProductManager::indexColumns(size_t row) {
+    const Product& product = *products[row];
+    rowIndex[product.getProductId()] = row;
+    directory.publish(product.getProductId(), products[row].get());
+    int merchantId = merchantSlot(product);
+    uint8_t typeTag = static_cast<uint8_t>(product.getCategory());
+    columns.append(product, typeTag, merchantId);
+    merchantRows[merchantId].push_back(row);
+    categoryRows[typeTag].push_back(row);
+    facets.addRow(columns, row);
+}
+
+void ProductManager::rebuildIndexes() {
+    columns.clear();
+    rowIndex.clear();
+    facets.clear();
+    nameIndex.clear();
+    nameIndex.reserve(products.size());
+    columns.reserve(products.size());
+    for (auto& rows : merchantRows) {
+        rows.clear();
+    }
+    for (auto& rows : categoryRows) {
+        rows.clear();
+    }
+    if (products.size() < PARALLEL_REBUILD_THRESHOLD) {
+        for (size_t row = 0; row < products.size(); ++row) {
+            indexRow(row);
+        }
+        rebuildSortOrders();
+        suggestIndex.rebuild(products);
+        return;
+    }
+
+    for (size_t row = 0; row < products.size(); ++row) {
+        indexColumns(row);
+    }
+    // 以下索引互不依赖，只读取列数据和商品对象，各自在独立线程中重建
+    std::thread priceThread([this] { priceOrder.rebuild(columns); });
+    std::thread discountThread([this] { discountOrder.rebuild(columns); });
+    std::thread nameThread([this] {
+        for (size_t row = 0; row < products.size(); ++row) {
+            nameIndex.add(row, products[row]->getName());
+        }
+    });
+    suggestIndex.rebuild(products);
+    priceThread.join();
+    discountThread.join();
+    nameThread.join();
+}
+
+void ProductManager::eraseRows(const std::vector<size_t>& rows, std::vector<std::unique_ptr<Product>>& removed) {
+    if (rows.empty()) {
+        return;
+    }
+
+    // 被删行自己的分面计数和ID查找项直接摘除
+    for (size_t row : rows) {
+        facets.removeRow(columns, row);
+        rowIndex.erase(columns.ids[row]);
+    }
+    takeRows(rows, removed);
+
+    // 其余行按商品ID的相对顺序不变，各索引只需删掉被删行并把后面的行号前移
+    columns.eraseRows(rows);
+    for (auto& merchantList : merchantRows) {
+        eraseAndShiftRows(merchantList, rows);
+    }
+    for (auto& categoryList : categoryRows) {
+        eraseAndShiftRows(categoryList, rows);
+    }
+    priceOrder.eraseRows(rows);
+    discountOrder.eraseRows(rows);
+    nameIndex.eraseRows(rows);
+    suggestIndex.eraseRows(rows);
+    for (size_t row = rows.front(); row < products.size(); ++row) {
+        rowIndex[columns.ids[row]] = row;
+    }
+}
+
+void ProductManager::reindexReplacedRow(size_t row, const Product& previous) {
+    const Product& product = *products[row];
+    uint8_t previousTag = columns.typeTags[row];
+    uint8_t typeTag = static_cast<uint8_t>(product.getCategory());
+
+    // 先按旧值摘除，更新列数据后再按新值加入
+    facets.removeRow(columns, row);
+    SortKeys previousKeys = sortKeysOf(row);
+    priceOrder.erase(columns, row, previousKeys.price);
+    discountOrder.erase(columns, row, previousKeys.discount);
+    columns.assign(row, product, typeTag, columns.merchantIds[row]);
+    facets.addRow(columns, row);
+    priceOrder.insert(columns, row);
+    discountOrder.insert(columns, row);
+
+    if (typeTag != previousTag) {
+        std::vector<size_t>& previousRows = categoryRows[previousTag];
+        previousRows.erase(std::lower_bound(previousRows.begin(), previousRows.end(), row));
+        std::vector<size_t>& rows = categoryRows[typeTag];
+        rows.insert(std::lower_bound(rows.begin(), rows.end(), row), row);
+    }
+    if (product.getName() != previous.getName()) {
+        nameIndex.remove(row, previous.getName());
+        nameIndex.insert(row, product.getName());
+        suggestIndex.rename(products, row);
+    }
+}
+
+void ProductManager::takeRows(const std::vector<size_t>& rows, std::vector<std::unique_ptr<Product>>& removed) {
+    size_t kept = 0;
+    size_t next = 0;
+    for (size_t row = 0; row < products.size(); ++row) {
+        if (next < rows.size() && rows[next] == row) {
+            removed.push_back(std::move(products[row]));
+            next++;
+        }
+        else {
+            if (kept != row) {
+                products[kept] = std::move(products[row]);
+            }
+            kept++;
+        }
+    }
+    products.resize(kept);
+}
+
+int ProductManager::merchantSlot(const Product& product) {
+    // 商家编号来自全局驻留表，按编号直接索引 merchantRows
+    uint32_t merchantId = product.getMerchantId();
+    if (merchantId >= merchantRows.size()) {
+        merchantRows.resize(merchantId + 1);
+    }
+    return static_cast<int>(merchantId);
+}
+
+int ProductManager::findMerchantId(const std::string& merchantName) const {
+    uint32_t merchantId;
+    if (!SymbolTable::merchants().find(merchantName, merchantId) || merchantId >= merchantRows.size()) {
+        return -1;
+    }
+    return static_cast<int>(merchantId);
+}
+
+FacetCounts ProductManager::getFacets() const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+    return facets.getCounts();
+}
+
+size_t ProductManager::getProductCount() const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+    return products.size();
+}
+
+int ProductManager::getTotalPages(int pageSize) const {
+    size_t count = getProductCount();
+    return static_cast<int>((count + pageSize - 1) / pageSize);
+}
+
+std::unique_ptr<Product> ProductManager::readProduct(std::ifstream& in, PriceEncoding encoding) {
+    // 先读取商品类型
+    uint32_t typeLen;
+    in.read(reinterpret_cast<char*>(&typeLen), sizeof(typeLen));
+    if (in.fail() || typeLen > 1000) {
+        throw std::runtime_error("读取商品类型长度失败");
+    }
+
+    std::string type;
+    if (typeLen > 0) {
+        type.resize(typeLen);
+        in.read(&type[0], typeLen);
+        if (in.fail()) {
+            throw std::runtime_error("读取商品类型失败");
+        }
+    }
+
+    // 创建对应类型的商品对象
+    auto product = createProduct(type, 0, "", Money(), 0, "");
+    if (!product) {
+        throw std::runtime_error("无法创建商品类型: " + type);
+    }
+
+    // 重新定位到类型长度位置开始反序列化
+    in.seekg(-(static_cast<std::streamoff>(sizeof(uint32_t) + typeLen)), std::ios::cur);
+    product->deserialize(in, encoding);
+    return product;
+}
+
+void ProductManager::createSampleProducts() {
+    std::cout << "商品库为空，将创建示例商品" << std::endl;
+
+    // 添加示例商品 - 每类3个商品
+    // 食品类
+    addProduct("食品", "苹果", Money::fromCents(850), 100, "B", 1.0);
+    addProduct("食品", "牛奶", Money::fromCents(1580), 50, "B", 0.9); // 9折
+    addProduct("食品", "面包", Money::fromCents(1200), 80, "B", 1.0);
+
+    // 书籍类
+    addProduct("书籍", "C++ Primer", Money::fromCents(8900), 30, "B", 0.85); // 85折
+    addProduct("书籍", "Effective C++", Money::fromCents(6800), 25, "B", 1.0);
+    addProduct("书籍", "深入理解计算机系统", Money::fromCents(13900), 15, "B", 0.9); // 9折
+
+    // 衣服类
+    addProduct("衣服", "T恤", Money::fromCents(8900), 200, "B", 0.7); // 7折
+    addProduct("衣服", "牛仔裤", Money::fromCents(29900), 150, "B", 1.0);
+    addProduct("衣服", "运动鞋", Money::fromCents(49900), 100, "B", 0.8); // 8折
+}
+
+namespace {
+
+// 每个加载分段最多记录的错误条数，整个快照最多打印的错误条数
+const size_t MAX_SEGMENT_ERRORS = 8;
+const size_t MAX_LOGGED_ERRORS = 20;
+
+}
+
+// 加载进度，多个线程共同累加，每跨过一档（约10%）打印一次
+class ProductManager::LoadProgress {
+private:
+    size_t total;
+    size_t step;
+    std::atomic<size_t> loaded;
+    std::mutex outputMutex;
+
+public:
+    explicit LoadProgress(size_t total)
+        : total(total), step(std::max<size_t>(total / 10, 100000)), loaded(0) {}
+
+    void add(size_t count) {
+        size_t before = loaded.fetch_add(count);
+        size_t after = before + count;
+        if (after / step != before / step) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "已加载 " << after << "/" << total << " 个商品" << std::endl;
+        }
+    }
+};
+
+// 快照中一段连续记录的解码结果，并行加载时每个块一个
+struct ProductManager::SnapshotSegment {
+    std::vector<std::unique_ptr<Product>> products;
+    int maxProductId = 0;
+    size_t skipped = 0;
+    size_t errorCount = 0;
+    bool intact = true;
+    std::vector<std::string> errors;
+
+    void fail(const std::string& message) {
+        intact = false;
+        if (errors.size() < MAX_SEGMENT_ERRORS) {
+            errors.push_back(message);
+        }
+        errorCount++;
+    }
+};
+
+void ProductManager::decodeRecords(ProductSnapshotReader& reader, uint64_t firstIndex, uint64_t count,
+    uint64_t endOffset, SnapshotSegment& segment, LoadProgress& progress) {
+    // 数量只用来预留空间，按实际字节数封顶，防止损坏的文件头导致巨量分配
+    uint64_t available = endOffset > reader.getOffset() ? endOffset - reader.getOffset() : 0;
+    segment.products.reserve(static_cast<size_t>(
+        std::min<uint64_t>(count, available / ProductSnapshotReader::MIN_RECORD_SIZE)));
+
+    ProductSnapshotRecord record;
+    uint64_t decoded = 0;
+    for (; decoded < count; ++decoded) {
+        uint64_t index = firstIndex + decoded + 1;
+        uint64_t offset = reader.getOffset();
+        try {
+            if (offset >= endOffset || !reader.next(record)) {
+                segment.fail("商品快照在第 " + std::to_string(index) + " 个商品处提前结束");
+                break;
+            }
+        }
+        catch (const std::exception& e) {
+            // 记录边界已经无法确定，本段之后的内容不再解析
+            segment.fail("第 " + std::to_string(index) + " 个商品（偏移 " + std::to_string(offset) + "）损坏: " + e.what());
+            break;
+        }
+
+        try {
+            auto product = createProduct(record.type, record.productId, record.name, record.price,
+                record.stock, record.merchantName, record.discount);
+            if (!product) {
+                throw std::runtime_error("未知的商品类型: " + record.type);
+            }
+            product->setFrozenStock(record.frozenStock);
+            segment.maxProductId = std::max(segment.maxProductId, record.productId);
+            segment.products.push_back(std::move(product));
+        }
+        catch (const std::exception& e) {
+            // 记录边界完整，只是字段取值非法，跳过这一条继续读取
+            segment.fail("第 " + std::to_string(index) + " 个商品（ID " + std::to_string(record.productId) +
+                "）无效: " + e.what() + "，跳过");
+            segment.skipped++;
+        }
+    }
+    progress.add(static_cast<size_t>(decoded));
+
+    if (segment.intact && reader.getOffset() != endOffset) {
+        segment.fail("第 " + std::to_string(firstIndex + 1) + " 个商品起的记录段结束位置与预期不符（偏移 " +
+            std::to_string(reader.getOffset()) + "，应为 " + std::to_string(endOffset) + "）");
+    }
+}
+
+void ProductManager::decodeBlocks(const std::vector<SnapshotBlock>& blocks, PriceEncoding encoding,
+    std::vector<SnapshotSegment>& segments, LoadProgress& progress) {
+    size_t blockCount = blocks.size();
+    segments.resize(blockCount);
+
+    // 每个线程负责一段连续的块，直接解析映射内存
+    auto worker = [&](size_t firstBlock, size_t endBlock) {
+        for (size_t index = firstBlock; index < endBlock; ++index) {
+            const SnapshotBlock& block = blocks[index];
+            ProductSnapshotReader reader(block.data, block.size, encoding);
+            try {
+                decodeRecords(reader, block.firstRecord, block.recordCount, block.size, segments[index], progress);
+            }
+            catch (const std::exception& e) {
+                segments[index].fail(std::string("解码商品块失败: ") + e.what());
+            }
+        }
+    };
+
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), blockCount);
+    if (threadCount <= 1) {
+        worker(0, blockCount);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back(worker, blockCount * t / threadCount, blockCount * (t + 1) / threadCount);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool ProductManager::readLegacySnapshot(std::vector<SnapshotSegment>& segments) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    // 第2版带魔数和偏移表，第1版直接以 nextProductId 开头；两者的记录布局相同，都按顺序读取
+    ProductSnapshotHeader header;
+    bool indexed = false;
+    if (fileSize >= sizeof(header)) {
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        indexed = !file.fail() && std::memcmp(header.magic, "PSNP", 4) == 0;
+    }
+    if (indexed && header.version != ProductSnapshotReader::SNAPSHOT_VERSION) {
+        std::cerr << "不支持的商品快照版本: " << header.version << std::endl;
+        return false;
+    }
+
+    // 旧版快照的原价都是 double 元
+    ProductSnapshotReader reader(file, PriceEncoding::LEGACY_YUAN);
+    size_t productCount = 0;
+    uint64_t endOffset = fileSize;
+    if (indexed) {
+        productCount = static_cast<size_t>(header.productCount);
+        nextProductId = header.nextProductId;
+        if (header.tableOffset >= sizeof(header) && header.tableOffset <= fileSize) {
+            endOffset = header.tableOffset;
+        }
+        reader.seek(sizeof(header));
+    }
+    else {
+        reader.seek(0);
+        if (!reader.readHeader(nextProductId, productCount)) {
+            nextProductId = 1;
+            std::cerr << "商品快照文件头不完整（" << fileSize << " 字节）" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "准备加载 " << productCount << " 个商品（旧版快照，" << fileSize / 1024 << " KB）..." << std::endl;
+
+    LoadProgress progress(productCount);
+    segments.resize(1);
+    decodeRecords(reader, 0, productCount, endOffset, segments[0], progress);
+    return true;
+}
+
+bool ProductManager::loadProducts() {
+    products.clear();
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<SnapshotSegment> segments;
+    bool intact = true;
+    bool migrateLegacy = false;
+    {
+        // 映射在解析完所有块之前保持打开
+        SnapshotReader snapshot;
+        SnapshotReader::Status status = snapshot.open(filename, "PROD");
+        if (status == SnapshotReader::Status::MISSING) {
+            std::cout << "商品快照文件不存在: " << filename << std::endl;
+            return true;
+        }
+
+        if (status == SnapshotReader::Status::LEGACY) {
+            intact = readLegacySnapshot(segments);
+            migrateLegacy = intact;
+        }
+        else {
+            intact = status == SnapshotReader::Status::VALID;
+            for (const auto& error : snapshot.getErrors()) {
+                std::cerr << error << std::endl;
+            }
+            uint32_t version = snapshot.getKindVersion();
+            if (version == PRODUCT_RECORD_VERSION || version == LEGACY_PRICE_VERSION) {
+                migrateLegacy = version == LEGACY_PRICE_VERSION;
+                nextProductId = static_cast<int>(snapshot.getExtra());
+                size_t productCount = static_cast<size_t>(snapshot.getRecordCount());
+                std::cout << "准备加载 " << productCount << " 个商品（" << snapshot.getBlocks().size()
+                    << " 块）..." << std::endl;
+                LoadProgress progress(productCount);
+                decodeBlocks(snapshot.getBlocks(),
+                    migrateLegacy ? PriceEncoding::LEGACY_YUAN : PriceEncoding::CENTS, segments, progress);
+            }
+            else if (intact) {
+                std::cerr << "不支持的商品记录版本: " << snapshot.getKindVersion() << std::endl;
+                intact = false;
+            }
+        }
+    }
+
+    // 按块顺序合并，行号与快照中的顺序一致
+    size_t loadedCount = 0;
+    for (const auto& segment : segments) {
+        loadedCount += segment.products.size();
+    }
+    products.reserve(loadedCount);
+    size_t skipped = 0;
+    size_t errorCount = 0;
+    size_t loggedErrors = 0;
+    for (auto& segment : segments) {
+        for (auto& product : segment.products) {
+            products.push_back(std::move(product));
+        }
+        nextProductId = std::max(nextProductId, segment.maxProductId + 1);
+        skipped += segment.skipped;
+        errorCount += segment.errorCount;
+        intact = intact && segment.intact;
+        for (const auto& error : segment.errors) {
+            if (loggedErrors < MAX_LOGGED_ERRORS) {
+                std::cerr << error << std::endl;
+                loggedErrors++;
+            }
+        }
+    }
+    if (errorCount > loggedErrors) {
+        std::cerr << "另有 " << (errorCount - loggedErrors) << " 处错误未显示" << std::endl;
+    }
+    auto decodedTime = std::chrono::steady_clock::now();
+
+    rebuildIndexes();
+    auto indexedTime = std::chrono::steady_clock::now();
+
+    std::cout << "成功加载 " << products.size() << " 个商品";
+    if (skipped > 0) {
+        std::cout << "，跳过 " << skipped << " 个无效商品";
+    }
+    std::cout << "（解析 " << std::chrono::duration_cast<std::chrono::milliseconds>(decodedTime - startTime).count()
+        << " ms，建立索引 " << std::chrono::duration_cast<std::chrono::milliseconds>(indexedTime - decodedTime).count()
+        << " ms）" << std::endl;
+
+    if (!intact) {
+        preserveDamagedSnapshot();
+    }
+    else if (migrateLegacy) {
+        // 旧格式（含原价为 double 元的第1版容器）完整读出后立即改写为当前格式
+        std::cout << "将旧格式商品快照转换为新格式" << std::endl;
+        saveProductsToFile();
+    }
+    return intact;
+}
+
+void ProductManager::loadCategoryDiscounts() {
+    SnapshotReader snapshot;
+    SnapshotReader::Status status = snapshot.open(categoryFilename, "CATD");
+    if (status == SnapshotReader::Status::MISSING) {
+        return;
+    }
+    if (status != SnapshotReader::Status::VALID || snapshot.getKindVersion() != CATEGORY_DISCOUNT_VERSION) {
+        // 只有几条记录，损坏时整体忽略，各类别按无折扣处理
+        std::cerr << "类别折扣文件已损坏，忽略: " << categoryFilename << std::endl;
+        return;
+    }
+
+    for (const auto& block : snapshot.getBlocks()) {
+        SnapshotRecordReader reader(block);
+        try {
+            for (uint32_t i = 0; i < block.recordCount; ++i) {
+                uint8_t tag = reader.read<uint8_t>("类别标签");
+                double discount = reader.read<double>("类别折扣");
+                uint8_t composition = reader.read<uint8_t>("组合方式");
+                if (tag >= CATEGORY_COUNT || composition > static_cast<uint8_t>(DiscountComposition::MIN)) {
+                    throw std::runtime_error("类别折扣记录异常");
+                }
+                // 与 setDiscountByType 相同的取值范围，越界（含 NaN）的记录忽略，该类别按无折扣处理
+                if (!isValidDiscount(discount)) {
+                    std::cerr << "类别折扣超出 (0, 1] 范围，忽略: " << typeNameOf(tag) << " " << discount << std::endl;
+                    continue;
+                }
+                CategoryDiscounts::set(static_cast<ProductCategory>(tag), discount,
+                    static_cast<DiscountComposition>(composition));
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "读取类别折扣失败: " << e.what() << std::endl;
+        }
+    }
+}
+
+bool ProductManager::saveCategoryDiscounts() {
+    SnapshotWriter writer(categoryFilename, "CATD", CATEGORY_DISCOUNT_VERSION, CATEGORY_COUNT);
+    if (!writer.open()) {
+        return false;
+    }
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i) {
+        ProductCategory category = static_cast<ProductCategory>(i);
+        writer.put(static_cast<uint8_t>(i));
+        writer.put(CategoryDiscounts::getDiscount(category));
+        writer.put(static_cast<uint8_t>(CategoryDiscounts::getComposition(category)));
+        writer.endRecord();
+    }
+    if (!writer.commit()) {
+        std::cerr << "保存类别折扣失败: " << categoryFilename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ProductManager::preserveDamagedSnapshot() {
+    // 损坏的快照原样改名保留，之后写入的新快照不会覆盖它，便于人工恢复
+    std::string backupName = SnapshotReader::preserveDamaged(filename);
+    if (!backupName.empty()) {
+        std::cerr << "商品快照已损坏，原文件保留为 " << backupName
+            << "，已加载 " << products.size() << " 个商品" << std::endl;
+    }
+    else {
+        std::cerr << "商品快照已损坏，且无法改名保留原文件 " << filename << std::endl;
+    }
+}
+
+void ProductManager::replayLog() {
+    std::ifstream log(productLog.getFilename(), std::ios::binary);
+    if (!log.is_open()) {
+        return;
+    }
+
+    log.seekg(0, std::ios::end);
+    std::streamoff logSize = log.tellg();
+    log.seekg(0, std::ios::beg);
+
+    size_t replayed = 0;
+    std::vector<size_t> removedRows;    // 下架的行在回放结束后统一移除，回放期间行号保持不变
+    std::streamoff validEnd = -1;       // 残缺记录的起始位置，-1 表示日志完整
+    std::streamoff batchStart = -1;     // 正在回放的批量记录的起始位置和结束位置
+    std::streamoff batchEnd = -1;
+    while (true) {
+        uint8_t opByte;
+        int productId;
+        std::streamoff recordStart = log.tellg();
+        if (recordStart >= batchEnd) {
+            batchStart = -1;
+        }
+        log.read(reinterpret_cast<char*>(&opByte), sizeof(opByte));
+        if (log.eof()) {
+            break;
+        }
+        log.read(reinterpret_cast<char*>(&productId), sizeof(productId));
+        if (log.fail()) {
+            std::cerr << "商品日志末尾记录不完整，已忽略" << std::endl;
+            validEnd = recordStart;
+            break;
+        }
+
+        try {
+            ProductLogOp op = static_cast<ProductLogOp>(opByte);
+            if (op == ProductLogOp::BATCH) {
+                // 先读出整批校验，完整时退回批内第一条记录，之后按普通记录逐条回放
+                uint32_t size = 0;
+                uint32_t checksum = 0;
+                log.read(reinterpret_cast<char*>(&size), sizeof(size));
+                log.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+                std::streamoff bodyStart = log.tellg();
+                if (log.fail() || static_cast<std::streamoff>(size) > logSize - bodyStart) {
+                    throw std::runtime_error("批量记录不完整，整批丢弃");
+                }
+                std::string body(size, '\0');
+                if (!log.read(&body[0], static_cast<std::streamsize>(size))) {
+                    throw std::runtime_error("批量记录不完整，整批丢弃");
+                }
+                if (crc32c(0, body.data(), body.size()) != checksum) {
+                    throw std::runtime_error("批量记录校验失败，整批丢弃");
+                }
+                log.seekg(bodyStart);
+                batchStart = recordStart;
+                batchEnd = bodyStart + static_cast<std::streamoff>(size);
+                continue;
+            }
+            if (op == ProductLogOp::ADD || op == ProductLogOp::LEGACY_ADD) {
+                auto product = readProduct(log,
+                    op == ProductLogOp::LEGACY_ADD ? PriceEncoding::LEGACY_YUAN : PriceEncoding::CENTS);
+                if (!findProduct(product->getProductId())) {
+                    nextProductId = std::max(nextProductId, product->getProductId() + 1);
+                    appendProduct(std::move(product));
+                }
+            }
+            else if (op == ProductLogOp::REPLACE) {
+                auto product = readProduct(log, PriceEncoding::CENTS);
+                auto it = rowIndex.find(product->getProductId());
+                if (it == rowIndex.end()) {
+                    std::cerr << "日志替换了不存在的商品 ID " << product->getProductId() << "，跳过" << std::endl;
+                    continue;
+                }
+                products[it->second] = std::move(product);
+                directory.publish(products[it->second]->getProductId(), products[it->second].get());
+            }
+            else if (op == ProductLogOp::REMOVE) {
+                // 快照已经不含该商品时（快照写完但日志未截断）直接忽略
+                auto it = rowIndex.find(productId);
+                if (it != rowIndex.end()) {
+                    removedRows.push_back(it->second);
+                    rowIndex.erase(it);
+                    directory.publish(productId, nullptr);
+                }
+            }
+            else {
+                double doubleValue = 0.0;
+                int64_t centsValue = 0;
+                int intValue = 0;
+                if (op == ProductLogOp::LEGACY_PRICE || op == ProductLogOp::DISCOUNT) {
+                    log.read(reinterpret_cast<char*>(&doubleValue), sizeof(doubleValue));
+                }
+                else if (op == ProductLogOp::PRICE) {
+                    log.read(reinterpret_cast<char*>(&centsValue), sizeof(centsValue));
+                }
+                else if (op == ProductLogOp::STOCK || op == ProductLogOp::FREEZE) {
+                    log.read(reinterpret_cast<char*>(&intValue), sizeof(intValue));
+                }
+                else {
+                    throw std::runtime_error("未知的日志记录类型: " + std::to_string(opByte));
+                }
+                if (log.fail()) {
+                    throw std::runtime_error("日志记录不完整");
+                }
+
+                Product* product = findProduct(productId);
+                if (!product) {
+                    std::cerr << "日志引用了不存在的商品 ID " << productId << "，跳过" << std::endl;
+                    continue;
+                }
+                switch (op) {
+                case ProductLogOp::PRICE:    product->setPrice(Money::fromCents(centsValue)); break;
+                case ProductLogOp::LEGACY_PRICE: product->setPrice(Money::fromYuan(doubleValue)); break;
+                case ProductLogOp::DISCOUNT: product->setDiscount(doubleValue); break;
+                case ProductLogOp::STOCK:    product->setStock(intValue); break;
+                case ProductLogOp::FREEZE:   product->setFrozenStock(intValue); break;
+                default: break;
+                }
+            }
+            replayed++;
+        }
+        catch (const std::exception& e) {
+            // 崩溃可能留下写了一半的记录，之后的内容一律丢弃
+            std::cerr << "回放商品日志时出错: " << e.what() << "，停止回放" << std::endl;
+            validEnd = batchStart >= 0 ? batchStart : recordStart;
+            break;
+        }
+    }
+    log.close();
+
+    // 先截掉残缺尾部：即使没有回放任何记录或下面的合并失败，
+    // 之后追加的记录也不会落在无法解析的内容后面
+    if (validEnd >= 0 && productLog.truncateTo(static_cast<uint64_t>(validEnd))) {
+        std::cout << "商品日志已截断到最后一条完整记录 (" << validEnd << " 字节)" << std::endl;
+    }
+
+    if (replayed > 0) {
+        // 回放时直接修改了商品对象，索引与商品不一致，移除下架的行后整体重建；
+        // 启动期间没有读者，移除的商品直接释放
+        if (!removedRows.empty()) {
+            std::vector<std::unique_ptr<Product>> removed;
+            std::sort(removedRows.begin(), removedRows.end());
+            takeRows(removedRows, removed);
+        }
+        rebuildIndexes();
+        std::cout << "已从商品日志回放 " << replayed << " 条记录" << std::endl;
+        // 立即合并，避免下次启动重复回放
+        if (saveProductsToFile()) {
+            productLog.reset();
+            productLog.close();
+        }
+    }
+}
+
+uint8_t ProductManager::typeTagOf(const std::string& type) {
+    ProductCategory category;
+    if (!categoryFromName(type, category)) {
+        return TYPE_TAG_UNKNOWN;
+    }
+    return static_cast<uint8_t>(category);
+}
+
+const char* ProductManager::typeNameOf(uint8_t tag) {
+    if (tag >= CATEGORY_COUNT) {
+        return "";
+    }
+    return CATEGORY_POLICIES[tag].typeName;
+}
+
+void ProductManager::recordAdd(const Product& product) {
+    if (recordStore) {
+        recordStore->append(product, static_cast<uint8_t>(product.getCategory()));
+    }
+    else {
+        productLog.appendAdd(product);
+    }
+}
+
+void ProductManager::recordPrice(int productId, Money price) {
+    size_t row = rowIndex.at(productId);
+    facets.removeRow(columns, row);
+    columns.prices[row] = static_cast<double>(price.getCents());
+    facets.addRow(columns, row);
+    if (recordStore) recordStore->updatePrice(productId, price);
+    else productLog.appendPrice(productId, price);
+}
+
+void ProductManager::recordStock(int productId, int stock) {
+    size_t row = rowIndex.at(productId);
+    facets.removeRow(columns, row);
+    columns.stocks[row] = stock;
+    facets.addRow(columns, row);
+    if (recordStore) recordStore->updateStock(productId, stock);
+    else productLog.appendStock(productId, stock);
+}
+
+void ProductManager::recordDiscount(int productId, double discount) {
+    size_t row = rowIndex.at(productId);
+    facets.removeRow(columns, row);
+    columns.discounts[row] = discount;
+    facets.addRow(columns, row);
+    if (recordStore) recordStore->updateDiscount(productId, discount);
+    else productLog.appendDiscount(productId, discount);
+}
+
+void ProductManager::recordFreeze(int productId, int frozenStock) {
+    size_t row = rowIndex.at(productId);
+    facets.removeRow(columns, row);
+    columns.frozenStocks[row] = frozenStock;
+    facets.addRow(columns, row);
+    if (recordStore) recordStore->updateFrozenStock(productId, frozenStock);
+    else productLog.appendFreeze(productId, frozenStock);
+}
+
+void ProductManager::recordRemove(int productId) {
+    if (recordStore) recordStore->remove(productId);
+    else productLog.appendRemove(productId);
+}
+
+void ProductManager::recordReplace(const Product& product) {
+    if (recordStore) recordStore->append(product, static_cast<uint8_t>(product.getCategory()));
+    else productLog.appendReplace(product);
+}
+
+size_t ProductManager::pendingChangeCount() const {
+    return recordStore ? recordStore->getPendingUpdates() : productLog.getRecordCount();
+}
+
+void ProductManager::notifyChangeRecorded() {
+    catalogVersion.fetch_add(1, std::memory_order_release);
+    if (pendingChangeCount() >= COMPACTION_THRESHOLD) {
+        compactionCv.notify_one();
+    }
+}
+
+void ProductManager::loadFromRecordStore() {
+    products.clear();
+
+    uint32_t capacity = recordStore->getCapacity();
+    for (uint32_t i = 0; i < capacity; ++i) {
+        const ProductRecord* record = recordStore->getRecord(i);
+        if (!record) {
+            continue;
+        }
+        try {
+            auto product = createProduct(typeNameOf(record->typeTag), record->productId,
+                recordStore->readString(record->nameOffset, record->nameLength),
+                Money::fromCents(record->priceCents), record->stock,
+                recordStore->readString(record->merchantOffset, record->merchantLength),
+                record->discount);
+            if (!product) {
+                throw std::runtime_error("未知的商品类别 " + std::to_string(record->typeTag));
+            }
+            product->setFrozenStock(record->frozenStock);
+            products.push_back(std::move(product));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "商品记录 " << record->productId << " 无效: " << e.what() << "，跳过" << std::endl;
+        }
+    }
+
+    nextProductId = recordStore->getNextProductId();
+    rebuildIndexes();
+    std::cout << "从映射记录文件加载 " << products.size() << " 个商品" << std::endl;
+}
+
+void ProductManager::migrateToRecordStore() {
+    if (products.empty()) {
+        return;
+    }
 
-    int count = 0;
     for (const auto& product : products) {
-        if (product->getMerchantName() == merchantName) {
-            count++;
+        recordStore->append(*product, static_cast<uint8_t>(product->getCategory()));
+    }
+    recordStore->setNextProductId(nextProductId);
+    recordStore->flush();
+    std::cout << "已将 " << products.size() << " 个商品迁移到映射记录文件" << std::endl;
+}
+
+void ProductManager::compactionLoop() {
+    std::unique_lock<std::mutex> lock(compactionMutex);
+    while (!stopCompaction) {
+        compactionCv.wait_for(lock, std::chrono::seconds(COMPACTION_INTERVAL_SECONDS));
+        if (stopCompaction) {
+            break;
         }
+        lock.unlock();
+        compactLog();
+        epochs.reclaim();
+        lock.lock();
     }
+}
 
-    return count;
+void ProductManager::compactLog(bool force) {
+    std::lock_guard<std::mutex> snapshotLock(snapshotMutex);
+
+    std::string records;
+    std::vector<size_t> recordEnds;
+    int snapshotNextId = 0;
+    uint64_t logOffset = 0;
+    size_t logRecords = 0;
+    {
+        std::lock_guard<std::mutex> lock(productsMutex);
+        if (!force && pendingChangeCount() == 0) {
+            return;
+        }
+
+        if (recordStore) {
+            // 映射存储只需把攒下的脏页刷盘
+            recordStore->flush();
+            return;
+        }
+
+        // 持锁期间只复制记录并记下快照覆盖到的日志位置，写盘在锁外进行
+        copySnapshot(records, recordEnds);
+        snapshotNextId = nextProductId;
+        logOffset = productLog.getSize();
+        logRecords = productLog.getRecordCount();
+    }
+
+    // 快照写入成功后才截掉已并入快照的日志，写快照期间追加的记录保留
+    if (writeSnapshot(records, recordEnds, snapshotNextId)) {
+        std::lock_guard<std::mutex> lock(productsMutex);
+        productLog.discardPrefix(logOffset, logRecords);
+    }
+}
+
+void ProductManager::saveProducts() {
+    compactLog(true);
+}
+
+bool ProductManager::saveProductsToFile() {
+    std::string records;
+    std::vector<size_t> recordEnds;
+    copySnapshot(records, recordEnds);
+    return writeSnapshot(records, recordEnds, nextProductId);
+}
+
+void ProductManager::copySnapshot(std::string& records, std::vector<size_t>& recordEnds) const {
+    recordEnds.reserve(products.size());
+    for (const auto& product : products) {
+        product->appendRecord(records);
+        recordEnds.push_back(records.size());
+    }
+}
+
+bool ProductManager::writeSnapshot(const std::string& records, const std::vector<size_t>& recordEnds,
+    int snapshotNextId) {
+    // 写入临时文件，完成后整体替换原文件
+    SnapshotWriter writer(filename, "PROD", PRODUCT_RECORD_VERSION, ProductSnapshotReader::BLOCK_SIZE);
+    if (!writer.open()) {
+        return false;
+    }
+
+    size_t begin = 0;
+    for (size_t end : recordEnds) {
+        writer.putBytes(records.data() + begin, end - begin);
+        writer.endRecord();
+        begin = end;
+    }
+    writer.setExtra(static_cast<uint64_t>(snapshotNextId));
+    if (!writer.commit()) {
+        std::cerr << "保存商品文件失败" << std::endl;
+        return false;
+    }
+
+    std::cout << "成功保存 " << recordEnds.size() << " 个商品到文件" << std::endl;
+    return true;
+}
+
+std::vector<ProductInfo> ProductManager::getProductsByMerchant(const std::string& merchantName) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+
+    int merchantId = findMerchantId(merchantName);
+    if (merchantId < 0) {
+        return {};
+    }
+    return collectRows(merchantRows[merchantId]);
+}
+
+std::vector<ProductInfo> ProductManager::getMerchantProductsByPage(const std::string& merchantName, int page, int pageSize) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+
+    int merchantId = findMerchantId(merchantName);
+    if (merchantId < 0 || page < 1 || pageSize <= 0) {
+        return {};
+    }
+    const std::vector<size_t>& rows = merchantRows[merchantId];
+
+    // 分页
+    std::vector<ProductInfo> result;
+    size_t startIndex = static_cast<size_t>(page - 1) * pageSize;
+    size_t endIndex = std::min(startIndex + pageSize, rows.size());
+
+    for (size_t i = startIndex; i < endIndex; ++i) {
+        result.emplace_back(*products[rows[i]]);
+    }
+
+    return result;
+}
+
+int ProductManager::getMerchantProductCount(const std::string& merchantName) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+
+    int merchantId = findMerchantId(merchantName);
+    if (merchantId < 0) {
+        return 0;
+    }
+    return static_cast<int>(merchantRows[merchantId].size());
+}
+
+std::vector<int> ProductManager::getMerchantProductIds(const std::string& merchantName,
+    const std::string& type) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+
+    int merchantId = findMerchantId(merchantName);
+    uint8_t typeTag = typeTagOf(type);
+    if (merchantId < 0 || typeTag == TYPE_TAG_UNKNOWN) {
+        return {};
+    }
+    std::vector<int> result;
+    for (size_t row : merchantRows[merchantId]) {
+        if (columns.typeTags[row] == typeTag) {
+            result.push_back(columns.ids[row]);
+        }
+    }
+    return result;
+}
+
+bool ProductManager::getMerchantProductsAfterCursor(const std::string& merchantName, const std::string& cursor,
+    int pageSize, std::vector<ProductInfo>& result, std::string& nextCursor) const {
+    std::lock_guard<std::mutex> lock(productsMutex);
+
+    result.clear();
+    nextCursor.clear();
+
+    ProductCursor position{ ProductSortKey::DEFAULT, 0.0, 0 };
+    if (!cursor.empty() && (!ProductCursor::decode(cursor, position) || position.sortKey != ProductSortKey::DEFAULT)) {
+        return false;
+    }
+
+    int merchantId = findMerchantId(merchantName);
+    if (merchantId < 0 || pageSize <= 0) {
+        return true;
+    }
+    const std::vector<size_t>& rows = merchantRows[merchantId];
+
+    // 行号按商品ID升序，二分定位到游标之后
+    auto it = std::upper_bound(rows.begin(), rows.end(), position.lastProductId,
+        [this](int productId, size_t row) { return productId < columns.ids[row]; });
+    size_t start = static_cast<size_t>(it - rows.begin());
+    size_t end = std::min(start + pageSize, rows.size());
+
+    for (size_t i = start; i < end; ++i) {
+        result.emplace_back(*products[rows[i]]);
+    }
+    if (end < rows.size()) {
+        nextCursor = ProductCursor{ ProductSortKey::DEFAULT, 0.0, columns.ids[rows[end - 1]] }.encode();
+    }
+    return true;
 }
\ No newline at end of file
@@ -2,22 +2,40 @@
 #define PRODUCT_MANAGER_H
 
 #include "product.h"
+#include "product_log.h"
+#include "product_record_store.h"
+#include "product_columns.h"
+#include "product_sort_index.h"
+#include "striped_lock_manager.h"
+#include "epoch_manager.h"
+#include "product_directory.h"
+#include "product_import.h"
+#include "product_facets.h"
+#include "product_trigram_index.h"
+#include "product_suggest_index.h"
+#include "product_snapshot_reader.h"
+#include "snapshot_file.h"
+#include "message.h"
 #include <vector>
+#include <unordered_map>
 
 #include <memory>
 #include <string>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
 
-// ڴƷϢĽṹ壨Ƕ̬
+// 用于传输商品信息的结构体（非多态）
 struct ProductInfo {
-    int productId;              // ƷID
-    std::string name;           // Ʒ
-    double originalPrice;       // Ʒԭ
-    double currentPrice;        // Ʒּۣۿۺ
-    int stock;                  // Ʒ
-    std::string merchantName;   // ̼
-    std::string productType;    // Ʒ
-    double discount;            // ۿۣ0.0-1.01.0ʾۿۣ0.8ʾ8ۣ
+    int productId;              // 商品ID
+    std::string name;           // 商品名称
+    Money originalPrice;        // 商品原价
+    Money currentPrice;         // 商品现价（考虑折扣后）
+    int stock;                  // 商品库存
+    std::string merchantName;   // 出售商家
+    std::string productType;    // 商品种类
+    double discount;            // 生效的折扣（含类别折扣，0.0-1.0，1.0表示无折扣，0.8表示8折）
 
     ProductInfo(const Product& product)
         : productId(product.getProductId()),
@@ -27,50 +45,265 @@ struct ProductInfo {
         stock(product.getStock()),
         merchantName(product.getMerchantName()),
         productType(product.getProductType()),
-        discount(product.getDiscount()) {}
+        discount(product.getEffectiveDiscount()) {}
+};
+
+// 批量修改中的一项，字段为负数表示不修改（与 modifyProduct 的约定一致）
+struct ProductChange {
+    int productId;
+    Money price;
+    int stock;
+    double discount;
+};
+
+// 定时折扣中的一项。expected 不小于0时，只有当前折扣仍等于 expected 才修改（撤销时不覆盖期间的手动修改）；
+// previous 和 applied 由 applyScheduledDiscounts 填写
+struct DiscountAssignment {
+    int productId;
+    double discount;
+    double expected;
+    double previous;
+    bool applied;
+};
+
+// 商品持久化方式
+enum class ProductStorageMode {
+    SNAPSHOT_LOG,       // 完整快照 + 只追加变更日志（默认）
+    MAPPED_RECORDS      // 内存映射定长记录，数值字段就地更新
 };
 
 class ProductManager {
 private:
     std::vector<std::unique_ptr<Product>> products;
     std::string filename;
+
+    // 按商品ID无锁查找商品对象；下架或替换的旧对象交给 epochs，没有读者后才释放
+    ProductDirectory directory;
+    EpochManager epochs;
     mutable std::mutex productsMutex;
     int nextProductId;
 
-    void loadProducts();
-    void saveProductsToFile(); // ˽з
+    // 串行化快照写入；写快照期间不持有productsMutex。锁顺序: snapshotMutex -> productsMutex
+    std::mutex snapshotMutex;
+
+    // 变更日志：每次修改只追加一条记录，由后台线程定期合并为快照
+    ProductLog productLog;
+    std::thread compactionThread;
+    std::mutex compactionMutex;
+    std::condition_variable compactionCv;
+    bool stopCompaction;
+
+    // 热点字段的列式副本，行号与products下标一致；rowIndex: 商品ID -> 行号
+    ProductColumns columns;
+    std::unordered_map<int, size_t> rowIndex;
+    std::vector<std::vector<size_t>> merchantRows;     // 商家编号 -> 该商家商品的行号（按商品ID升序）
+    std::vector<std::vector<size_t>> categoryRows;     // 类别标签 -> 该类别商品的行号（升序）
+
+    // 增量维护的全目录分面计数，随列数据一起更新
+    ProductFacets facets;
+
+    // 商品名称的三元组索引，用于容错搜索（名称不会修改，只在新增和重建时维护）
+    ProductTrigramIndex nameIndex;
+
+    // 名称前缀补全索引，按成交数量排序
+    ProductSuggestIndex suggestIndex;
+
+    // 维护的排序索引：按现价、按折扣；"最新上架"直接倒序遍历行号
+    ProductSortIndex priceOrder;
+    ProductSortIndex discountOrder;
+
+    // 库存分段锁：单个商品的库存操作与整单扣减互斥，不同商品之间互不影响
+    StripedLockManager stockLocks;
+
+    // 商品目录版本号，每次逻辑修改（单个或整批）加一，供缓存判断数据是否变化
+    std::atomic<uint64_t> catalogVersion;
+
+    // 映射记录存储，仅在 MAPPED_RECORDS 模式下创建
+    ProductStorageMode storageMode;
+    std::unique_ptr<ProductRecordStore> recordStore;
+
+    static const size_t COMPACTION_THRESHOLD = 1000;    // 日志记录数达到该值时立即合并
+    static const int COMPACTION_INTERVAL_SECONDS = 30;  // 定期合并间隔
+    static const size_t REBUILD_SORT_THRESHOLD = 32;    // 批量改价超过该数量时整体重建排序索引
+    static const size_t PARALLEL_REBUILD_THRESHOLD = 65536; // 商品数达到该值时多线程重建索引
+    static const uint32_t PRODUCT_RECORD_VERSION = 2;   // 快照容器中商品记录的格式版本（第2版起原价为 int64 分）
+    static const uint32_t LEGACY_PRICE_VERSION = 1;     // 原价为 double 元的记录版本，读取后立即重写
+    static const uint32_t CATEGORY_DISCOUNT_VERSION = 1; // 类别折扣文件的记录格式版本
+
+    // 类别折扣单独保存在一个很小的容器文件中，修改时整体替换，与商品数量无关
+    std::string categoryFilename;
+    void loadCategoryDiscounts();
+    bool saveCategoryDiscounts();
+
+    // 读取快照容器：逐块校验后多线程解析，旧格式快照顺序读取。
+    // 快照损坏时加载能读出的部分并改名保留原文件，返回false
+    bool loadProducts();
+    void preserveDamagedSnapshot();
+    struct SnapshotSegment;
+    class LoadProgress;
+    void decodeRecords(ProductSnapshotReader& reader, uint64_t firstIndex, uint64_t count,
+        uint64_t endOffset, SnapshotSegment& segment, LoadProgress& progress);
+    void decodeBlocks(const std::vector<SnapshotBlock>& blocks, PriceEncoding encoding,
+        std::vector<SnapshotSegment>& segments, LoadProgress& progress);
+    bool readLegacySnapshot(std::vector<SnapshotSegment>& segments);
+    void replayLog();
+    void createSampleProducts();
+    bool saveProductsToFile(); // 复制并写出快照，仅在启动期间（没有其他线程）调用
+    void copySnapshot(std::string& records, std::vector<size_t>& recordEnds) const; // 调用方需持有productsMutex
+    bool writeSnapshot(const std::string& records, const std::vector<size_t>& recordEnds, int snapshotNextId);
+    std::unique_ptr<Product> readProduct(std::ifstream& in, PriceEncoding encoding);
+    Product* findProduct(int productId) const; // 调用方需持有productsMutex
+
+    void compactionLoop();
+    void compactLog(bool force = false);    // force: 即使没有待合并的修改也写快照
+
+    // 以下方法调用方需持有productsMutex，按存储方式写日志或就地更新记录
+    void recordAdd(const Product& product);
+    void recordPrice(int productId, Money price);
+    void recordStock(int productId, int stock);
+    void recordDiscount(int productId, double discount);
+    void recordFreeze(int productId, int frozenStock);
+    void recordRemove(int productId);
+    void recordReplace(const Product& product);
+    size_t pendingChangeCount() const;
+    void notifyChangeRecorded();    // 每次逻辑修改调用一次，同时递增目录版本号
+
+    // 以下方法调用方需持有productsMutex
+    void appendProduct(std::unique_ptr<Product> product);
+    void indexRow(size_t row);      // 为 products[row] 建立列数据、倒排表、分面计数和名称索引
+    void indexColumns(size_t row);  // 同 indexRow，但不含名称索引
+    void rebuildIndexes();          // 商品较多时排序索引、名称索引和补全索引并行重建
+    // 删除若干行（升序），被删除的商品从 products 中移出后放入 removed。
+    // 只摘除这些行的索引项，其余行的行号在各索引中就地前移，不重新排序或重建名称索引
+    void eraseRows(const std::vector<size_t>& rows, std::vector<std::unique_ptr<Product>>& removed);
+    // 只移出商品对象、不维护索引（回放日志时使用，之后整体重建）
+    void takeRows(const std::vector<size_t>& rows, std::vector<std::unique_ptr<Product>>& removed);
+    // products[row] 已被替换（商家不变），previous 为旧对象：只更新这一行的索引项
+    void reindexReplacedRow(size_t row, const Product& previous);
+    int merchantSlot(const Product& product);
+    int findMerchantId(const std::string& merchantName) const;
+    std::vector<ProductInfo> collectRows(const std::vector<size_t>& rows) const;
+    // 修改前的排序键：排序索引按旧键二分定位要移动的行，须在修改列数据之前取得
+    struct SortKeys {
+        double price;
+        double discount;
+    };
+    SortKeys sortKeysOf(size_t row) const;
+    void refreshSortOrders(size_t row, const SortKeys& previous);
+    void rebuildSortOrders();
+    size_t sortedRow(ProductSortKey sortKey, size_t position) const;
+    bool rowBefore(ProductSortKey sortKey, size_t a, size_t b) const;
+    double sortKeyValue(ProductSortKey sortKey, size_t row) const;
+    size_t cursorPosition(const ProductCursor& cursor) const;
+    // 容错匹配：关键字太短、索引无法筛选时返回false，由调用方退回精确匹配
+    bool fuzzyMatchRows(const std::string& keyword, std::vector<size_t>& rows, std::vector<int>& distances) const;
+
+    void loadFromRecordStore();
+    void migrateToRecordStore();
+    static const uint8_t TYPE_TAG_UNKNOWN = 0xFF;
+    static uint8_t typeTagOf(const std::string& type);
+    static const char* typeNameOf(uint8_t tag);
 
     std::unique_ptr<Product> createProduct(const std::string& type, int id,
-        const std::string& name, double price,
+        const std::string& name, Money price,
         int stock, const std::string& merchant,
         double discount = 1.0);
 
 public:
     void saveProducts();
-    ProductManager(const std::string& filename);
+    ProductManager(const std::string& filename, ProductStorageMode mode = ProductStorageMode::SNAPSHOT_LOG);
     ~ProductManager();
 
     bool addProduct(const std::string& type, const std::string& name,
-        double price, int stock, const std::string& merchantName,
+        Money price, int stock, const std::string& merchantName,
         double discount = 1.0);
 
-    bool modifyProduct(int productId, double newPrice = -1, int newStock = -1, double newDiscount = -1);
+    // 批量导入：一次加锁分配连续ID，整批只持久化一次；firstProductId 为第一个新商品的ID
+    bool importProducts(const std::string& merchantName, const std::vector<ProductImportRow>& rows,
+        int& firstProductId);
+
+    bool modifyProduct(int productId, Money newPrice = Money::fromCents(-1), int newStock = -1, double newDiscount = -1);
+
+    // 设置类别折扣：只修改类别折扣表中的一项并保存类别折扣文件，不逐个修改商品，也不写商品日志；
+    // 读取现价时按 composition 与商品自身折扣组合。只有写盘与商品数量无关：该类别各行的分面计数
+    // 和排序位置仍要在持锁期间更新，代价与该类别的商品数成正比。count 为该类别的商品数；
+    // 类别无效或折扣不在 (0, 1] 内时返回false，error 为原因，折扣表不变
+    bool setDiscountByType(const std::string& productType, double discount,
+        DiscountComposition composition, int& count, std::string& error);
+
+    // 批量修改：先校验全部商品存在、属于该商家且取值合法，再在一次加锁内全部应用，
+    // 目录版本号只加一，日志中整批作为一条记录写出；校验失败时不修改任何商品，error 为原因。
+    // 整批生效只对持有 productsMutex 的读者（列表、搜索、筛选、分面）成立；
+    // getProductById 返回的 ProductRef 不加锁读取单个商品，应用期间可能看到一部分商品已修改、
+    // 一部分尚未修改（每个商品自身的原价和折扣各自是某次写入之后的值）
+    bool applyChanges(const std::string& merchantName, const std::vector<ProductChange>& changes,
+        std::string& error);
+
+    // 批量下架：先校验全部商品存在且属于该商家，再一次加锁全部移除，各索引就地删除这些行（其后行号前移）。
+    // 移除的商品对象交给纪元回收器，正在读取它们的请求结束后才释放；校验失败时不做修改
+    bool delistProducts(const std::string& merchantName, const std::vector<int>& productIds,
+        std::string& error);
 
-    int setDiscountByType(const std::string& productType, double discount);
+    // 用新的类型、名称等替换商品，商品ID、冻结库存和成交热度不变；旧对象同样延迟释放
+    bool replaceProduct(const std::string& merchantName, int productId, const std::string& type,
+        const std::string& name, Money price, int stock, double discount, std::string& error);
 
-    // ޸ķͣʹProductInfoṹProduct
+    // 定时折扣：一次加锁按顺序应用整批折扣（不存在的商品跳过），目录版本号只加一；返回实际修改的数量
+    size_t applyScheduledDiscounts(std::vector<DiscountAssignment>& assignments);
+
+    uint64_t getCatalogVersion() const { return catalogVersion.load(std::memory_order_acquire); }
+
+    // 库存调整（delta为负表示扣减），库存用CAS无锁更新，成功后写入变更日志
+    bool adjustStock(int productId, int delta);
+    bool freezeStock(int productId, int quantity);
+    bool unfreezeStock(int productId, int quantity);
+
+    // 整单扣减库存，items 为 (商品ID, 数量)。按规范顺序锁住涉及的全部分段，
+    // 所有商品都可售时一起扣减；否则不做任何修改，failedProductId 为第一个不满足的商品
+    bool reserveStock(const std::vector<std::pair<int, int>>& items, int& failedProductId);
+    // 归还 reserveStock 扣减的库存（例如后续扣款失败时）
+    void releaseStock(const std::vector<std::pair<int, int>>& items);
+    // 结算成功后累计成交数量，作为搜索建议的热度
+    void recordSales(const std::vector<std::pair<int, int>>& items);
+
+    // 修改返回类型：使用ProductInfo结构体代替Product对象
     std::vector<ProductInfo> getAllProducts() const;
-    std::vector<ProductInfo> getProductsByPage(int page, int pageSize) const;
-    std::vector<ProductInfo> searchProducts(const std::string& keyword) const;
+    std::vector<ProductInfo> getProductsByPage(int page, int pageSize,
+        ProductSortKey sortKey = ProductSortKey::DEFAULT) const;
+    // 键集分页：cursor 为空表示第一页，返回的 nextCursor 为空表示没有下一页；游标无效时返回false
+    bool getProductsAfterCursor(const std::string& cursor, int pageSize, ProductSortKey sortKey,
+        std::vector<ProductInfo>& result, std::string& nextCursor) const;
+    // limit > 0 时只返回排序后的前 limit 个结果；resultFacets 非空时返回全部匹配结果的分面计数
+    // fuzzy 为 true 时允许拼写错误（纯 ASCII 关键字按长度容忍1-2处编辑，含中文时按精确匹配），默认排序下按匹配程度排列
+    std::vector<ProductInfo> searchProducts(const std::string& keyword,
+        ProductSortKey sortKey = ProductSortKey::DEFAULT, size_t limit = 0,
+        bool fuzzy = false, FacetCounts* resultFacets = nullptr) const;
     std::vector<ProductInfo> getProductsByType(const std::string& type) const;
 
-    // ̼רòѯ
+    // 以 prefix 开头（ASCII 不区分大小写）的商品名称，按热度取前 limit 个，名称不重复
+    std::vector<std::string> suggestNames(const std::string& prefix, size_t limit) const;
+
+    // 基于列式数据的筛选：按现价区间、按可售库存（库存-冻结库存>0）
+    std::vector<ProductInfo> getProductsByPriceRange(Money minPrice, Money maxPrice) const;
+    std::vector<ProductInfo> getAvailableProducts() const;
+
+    // 组合筛选，只返回匹配的商品ID；inStockOnly 为 true 时额外要求有可售库存
+    std::vector<int> filterProductIds(Money minPrice, Money maxPrice, bool inStockOnly) const;
+
+    // 商家专用查询
     std::vector<ProductInfo> getProductsByMerchant(const std::string& merchantName) const;
     std::vector<ProductInfo> getMerchantProductsByPage(const std::string& merchantName, int page, int pageSize) const;
     int getMerchantProductCount(const std::string& merchantName) const;
+    // 商家在指定类型下的全部商品ID，类型无效时返回空
+    std::vector<int> getMerchantProductIds(const std::string& merchantName, const std::string& type) const;
+    bool getMerchantProductsAfterCursor(const std::string& merchantName, const std::string& cursor, int pageSize,
+        std::vector<ProductInfo>& result, std::string& nextCursor) const;
+
+    // 无锁查找，返回值有效期间商品对象不会被释放；商品已下架时为空
+    ProductRef getProductById(int productId);
 
-    // ָ޸Ĳ
-    Product* getProductById(int productId);
+    // 全目录的分面计数（增量维护，不扫描商品）
+    FacetCounts getFacets() const;
 
     size_t getProductCount() const;
     int getTotalPages(int pageSize) const;
@@ -0,0 +1,438 @@
+#include "product_record_store.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// ==================== MappedFile 实现 ====================
+
+MappedFile::MappedFile() : data(nullptr), size(0),
+#ifdef _WIN32
+fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL)
+#else
+fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path, size_t minSize) {
+    size_t fileSize = 0;
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+        NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        std::cerr << "无法打开映射文件: " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER currentSize;
+    if (GetFileSizeEx(fileHandle, &currentSize)) {
+        fileSize = static_cast<size_t>(currentSize.QuadPart);
+    }
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fileDescriptor < 0) {
+        std::cerr << "无法打开映射文件: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fileDescriptor, &st) == 0) {
+        fileSize = static_cast<size_t>(st.st_size);
+    }
+#endif
+    return map(std::max(fileSize, minSize));
+}
+
+bool MappedFile::openReadOnly(const std::string& path) {
+    size_t fileSize = 0;
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER currentSize;
+    if (!GetFileSizeEx(fileHandle, &currentSize)) {
+        close();
+        return false;
+    }
+    fileSize = static_cast<size_t>(currentSize.QuadPart);
+    if (fileSize == 0) {
+        return true;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL) {
+        std::cerr << "创建文件映射失败: " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+    data = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        std::cerr << "映射文件视图失败: " << GetLastError() << std::endl;
+        CloseHandle(mappingHandle);
+        mappingHandle = NULL;
+        close();
+        return false;
+    }
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fileDescriptor, &st) != 0) {
+        close();
+        return false;
+    }
+    fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize == 0) {
+        return true;
+    }
+    void* addr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "映射文件失败" << std::endl;
+        close();
+        return false;
+    }
+    data = static_cast<char*>(addr);
+#endif
+    size = fileSize;
+    return true;
+}
+
+bool MappedFile::map(size_t newSize) {
+#ifdef _WIN32
+    // CreateFileMapping 会按需扩展文件
+    DWORD sizeHigh = static_cast<DWORD>(static_cast<uint64_t>(newSize) >> 32);
+    DWORD sizeLow = static_cast<DWORD>(newSize & 0xFFFFFFFF);
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READWRITE, sizeHigh, sizeLow, NULL);
+    if (mappingHandle == NULL) {
+        std::cerr << "创建文件映射失败: " << GetLastError() << std::endl;
+        return false;
+    }
+    data = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, newSize));
+    if (!data) {
+        std::cerr << "映射文件视图失败: " << GetLastError() << std::endl;
+        CloseHandle(mappingHandle);
+        mappingHandle = NULL;
+        return false;
+    }
+#else
+    struct stat st;
+    if (fstat(fileDescriptor, &st) != 0 || static_cast<size_t>(st.st_size) < newSize) {
+        if (ftruncate(fileDescriptor, static_cast<off_t>(newSize)) != 0) {
+            std::cerr << "扩展映射文件失败" << std::endl;
+            return false;
+        }
+    }
+    void* addr = mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "映射文件失败" << std::endl;
+        return false;
+    }
+    data = static_cast<char*>(addr);
+#endif
+    size = newSize;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (!data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mappingHandle);
+    mappingHandle = NULL;
+#else
+    munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+void MappedFile::close() {
+    unmap();
+#ifdef _WIN32
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+}
+
+bool MappedFile::resize(size_t newSize) {
+    if (newSize <= size) {
+        return true;
+    }
+    unmap();
+    return map(newSize);
+}
+
+void MappedFile::flush(size_t offset, size_t length) {
+    if (!data || length == 0) {
+        return;
+    }
+#ifdef _WIN32
+    FlushViewOfFile(data + offset, length);
+#else
+    // msync 要求起始地址按页对齐
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - offset % pageSize;
+    msync(data + alignedOffset, length + (offset - alignedOffset), MS_SYNC);
+#endif
+}
+
+// ==================== ProductRecordStore 实现 ====================
+
+ProductRecordStore::ProductRecordStore(const std::string& recordFilename, const std::string& heapFilename)
+    : recordFilename(recordFilename), heapFilename(heapFilename),
+    dirtyBegin(0), dirtyEnd(0), pendingUpdates(0), heapFlushed(0) {
+}
+
+ProductRecordStore::~ProductRecordStore() {
+    close();
+}
+
+bool ProductRecordStore::open() {
+    if (!records.open(recordFilename, sizeof(ProductRecordHeader) + INITIAL_CAPACITY * sizeof(ProductRecord))) {
+        return false;
+    }
+
+    ProductRecordHeader* h = header();
+    if (h->magic[0] == 0) {
+        // 新建的文件内容全为0，写入文件头
+        std::memcpy(h->magic, "PRDS", 4);
+        h->version = RECORD_VERSION;
+        h->recordSize = sizeof(ProductRecord);
+        h->capacity = static_cast<uint32_t>((records.getSize() - sizeof(ProductRecordHeader)) / sizeof(ProductRecord));
+        h->nextProductId = 1;
+        h->heapSize = 0;
+        records.flush(0, sizeof(ProductRecordHeader));
+    }
+    else if (std::memcmp(h->magic, "PRDS", 4) != 0 || h->recordSize != sizeof(ProductRecord) ||
+        (h->version != RECORD_VERSION && h->version != LEGACY_PRICE_VERSION)) {
+        std::cerr << "商品记录文件格式不匹配: " << recordFilename << std::endl;
+        records.close();
+        return false;
+    }
+    else if (h->version == LEGACY_PRICE_VERSION) {
+        migrateLegacyPrices();
+    }
+
+    if (!heap.open(heapFilename, std::max<size_t>(INITIAL_HEAP_SIZE, h->heapSize))) {
+        records.close();
+        return false;
+    }
+    heapFlushed = h->heapSize;
+
+    std::cout << "已映射商品记录文件: " << recordFilename << " (容量 " << h->capacity << ")" << std::endl;
+    return true;
+}
+
+void ProductRecordStore::migrateLegacyPrices() {
+    // 记录长度不变，原价字段的8个字节按 double 元读出后就地写回分值。
+    // 全部记录刷盘后才改写版本号；换算中途掉电时文件只换算了一部分，需要从备份恢复
+    ProductRecordHeader* h = header();
+    ProductRecord* first = reinterpret_cast<ProductRecord*>(records.getData() + sizeof(ProductRecordHeader));
+    size_t converted = 0;
+    for (uint32_t i = 0; i < h->capacity; ++i) {
+        ProductRecord& record = first[i];
+        if (record.productId == 0) {
+            continue;
+        }
+        double yuan;
+        std::memcpy(&yuan, &record.priceCents, sizeof(yuan));
+        record.priceCents = Money::fromYuan(yuan).getCents();
+        converted++;
+    }
+    records.flush(sizeof(ProductRecordHeader), static_cast<size_t>(h->capacity) * sizeof(ProductRecord));
+    h->version = RECORD_VERSION;
+    records.flush(0, sizeof(ProductRecordHeader));
+    std::cout << "商品记录文件的原价已换算为分: " << converted << " 条" << std::endl;
+}
+
+void ProductRecordStore::close() {
+    if (records.getData()) {
+        flush();
+    }
+    heap.close();
+    records.close();
+}
+
+bool ProductRecordStore::isEmpty() const {
+    return !records.getData() || header()->nextProductId <= 1;
+}
+
+ProductRecord* ProductRecordStore::slot(int productId) const {
+    if (productId < 1 || static_cast<uint32_t>(productId) > header()->capacity) {
+        return nullptr;
+    }
+    return reinterpret_cast<ProductRecord*>(records.getData() + sizeof(ProductRecordHeader)) + (productId - 1);
+}
+
+const ProductRecord* ProductRecordStore::getRecord(uint32_t index) const {
+    const ProductRecord* record = slot(static_cast<int>(index) + 1);
+    if (!record || record->productId == 0) {
+        return nullptr;
+    }
+    return record;
+}
+
+std::string ProductRecordStore::readString(uint32_t offset, uint32_t length) const {
+    if (static_cast<size_t>(offset) + length > header()->heapSize) {
+        throw std::runtime_error("字符串堆偏移越界");
+    }
+    return std::string(heap.getData() + offset, length);
+}
+
+bool ProductRecordStore::ensureCapacity(uint32_t slots) {
+    uint32_t capacity = header()->capacity;
+    if (slots <= capacity) {
+        return true;
+    }
+
+    // 容量翻倍，减少重新映射次数
+    uint32_t newCapacity = std::max(slots, capacity * 2);
+    flush();
+    if (!records.resize(sizeof(ProductRecordHeader) + static_cast<size_t>(newCapacity) * sizeof(ProductRecord))) {
+        return false;
+    }
+    header()->capacity = newCapacity;
+    return true;
+}
+
+bool ProductRecordStore::appendString(const std::string& value, uint32_t& offset) {
+    uint32_t used = header()->heapSize;
+    size_t needed = static_cast<size_t>(used) + value.size();
+    if (needed > heap.getSize()) {
+        if (!heap.resize(std::max(needed, heap.getSize() * 2))) {
+            return false;
+        }
+    }
+    std::memcpy(heap.getData() + used, value.data(), value.size());
+    offset = used;
+    header()->heapSize = static_cast<uint32_t>(needed);
+    return true;
+}
+
+void ProductRecordStore::markDirty(int productId) {
+    uint32_t index = static_cast<uint32_t>(productId - 1);
+    if (pendingUpdates == 0) {
+        dirtyBegin = index;
+        dirtyEnd = index + 1;
+    }
+    else {
+        dirtyBegin = std::min(dirtyBegin, index);
+        dirtyEnd = std::max(dirtyEnd, index + 1);
+    }
+    pendingUpdates++;
+}
+
+bool ProductRecordStore::append(const Product& product, uint8_t typeTag) {
+    int productId = product.getProductId();
+    if (productId < 1 || !ensureCapacity(static_cast<uint32_t>(productId))) {
+        return false;
+    }
+
+    uint32_t nameOffset = 0;
+    uint32_t merchantOffset = 0;
+    if (!appendString(product.getName(), nameOffset) ||
+        !appendString(product.getMerchantName(), merchantOffset)) {
+        return false;
+    }
+
+    ProductRecord* record = slot(productId);
+    std::memset(record, 0, sizeof(ProductRecord));
+    record->productId = productId;
+    record->stock = product.getStock();
+    record->frozenStock = product.getFrozenStock();
+    record->typeTag = typeTag;
+    record->priceCents = product.getOriginalPrice().getCents();
+    record->discount = product.getDiscount();
+    record->nameOffset = nameOffset;
+    record->nameLength = static_cast<uint32_t>(product.getName().size());
+    record->merchantOffset = merchantOffset;
+    record->merchantLength = static_cast<uint32_t>(product.getMerchantName().size());
+
+    setNextProductId(std::max(header()->nextProductId, productId + 1));
+    markDirty(productId);
+    return true;
+}
+
+void ProductRecordStore::remove(int productId) {
+    ProductRecord* record = slot(productId);
+    if (record) {
+        std::memset(record, 0, sizeof(ProductRecord));
+        markDirty(productId);
+    }
+}
+
+void ProductRecordStore::updatePrice(int productId, Money price) {
+    ProductRecord* record = slot(productId);
+    if (record) {
+        record->priceCents = price.getCents();
+        markDirty(productId);
+    }
+}
+
+void ProductRecordStore::updateStock(int productId, int stock) {
+    ProductRecord* record = slot(productId);
+    if (record) {
+        record->stock = stock;
+        markDirty(productId);
+    }
+}
+
+void ProductRecordStore::updateDiscount(int productId, double discount) {
+    ProductRecord* record = slot(productId);
+    if (record) {
+        record->discount = discount;
+        markDirty(productId);
+    }
+}
+
+void ProductRecordStore::updateFrozenStock(int productId, int frozenStock) {
+    ProductRecord* record = slot(productId);
+    if (record) {
+        record->frozenStock = frozenStock;
+        markDirty(productId);
+    }
+}
+
+void ProductRecordStore::setNextProductId(int nextProductId) {
+    header()->nextProductId = nextProductId;
+}
+
+void ProductRecordStore::flush() {
+    uint32_t heapSize = header()->heapSize;
+    if (pendingUpdates == 0 && heapFlushed == heapSize) {
+        return;
+    }
+
+    // 先刷字符串堆，保证记录引用的字符串已经落盘
+    heap.flush(heapFlushed, heapSize - heapFlushed);
+    heapFlushed = heapSize;
+
+    if (pendingUpdates > 0) {
+        size_t offset = sizeof(ProductRecordHeader) + static_cast<size_t>(dirtyBegin) * sizeof(ProductRecord);
+        records.flush(offset, static_cast<size_t>(dirtyEnd - dirtyBegin) * sizeof(ProductRecord));
+    }
+    records.flush(0, sizeof(ProductRecordHeader));
+    pendingUpdates = 0;
+}
\ No newline at end of file
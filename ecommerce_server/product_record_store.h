@@ -0,0 +1,132 @@
+#ifndef PRODUCT_RECORD_STORE_H
+#define PRODUCT_RECORD_STORE_H
+
+#include "product.h"
+#include <string>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// 定长商品记录：热点数值字段就地更新，名称/商家存放在字符串堆中
+struct ProductRecord {
+    int32_t productId;          // 0 表示空槽位
+    int32_t stock;
+    int32_t frozenStock;
+    uint8_t typeTag;            // 0-食品 1-书籍 2-衣服
+    uint8_t reserved[3];
+    int64_t priceCents;         // 原价（分），第1版文件中这8个字节是 double 元
+    double discount;
+    uint32_t nameOffset;        // 名称在字符串堆中的偏移
+    uint32_t nameLength;
+    uint32_t merchantOffset;    // 商家名在字符串堆中的偏移
+    uint32_t merchantLength;
+};
+
+// 记录文件头
+struct ProductRecordHeader {
+    char magic[4];              // "PRDS"
+    uint32_t version;
+    uint32_t recordSize;        // sizeof(ProductRecord)，用于检测布局变化
+    uint32_t capacity;          // 已分配的槽位数
+    int32_t nextProductId;
+    uint32_t heapSize;          // 字符串堆已使用的字节数
+};
+
+// 可读写的文件映射，封装 Windows / POSIX 差异
+class MappedFile {
+private:
+    char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    bool map(size_t newSize);
+    void unmap();
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // 打开（不存在则创建）并映射至少 minSize 字节
+    bool open(const std::string& path, size_t minSize);
+    // 只读映射已有文件的全部内容（空文件不映射，getData 为 nullptr），不能再 resize
+    bool openReadOnly(const std::string& path);
+    void close();
+
+    // 扩展文件并重新映射，之前取得的指针全部失效
+    bool resize(size_t newSize);
+    void flush(size_t offset, size_t length);
+
+    char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+/**
+ * @brief 内存映射的定长商品记录存储
+ * 记录文件按 productId 分槽（槽位 = productId - 1），价格、库存、折扣、冻结库存
+ * 的修改直接写入映射内存，脏区间攒批后统一 msync / FlushViewOfFile。
+ * 名称和商家名只在新增商品时追加到字符串堆，启动时直接映射两个文件而不再逐字段解析。
+ */
+class ProductRecordStore {
+private:
+    std::string recordFilename;
+    std::string heapFilename;
+    MappedFile records;
+    MappedFile heap;
+
+    // 待刷盘的槽位区间 [dirtyBegin, dirtyEnd)
+    uint32_t dirtyBegin;
+    uint32_t dirtyEnd;
+    size_t pendingUpdates;
+    uint32_t heapFlushed;       // 字符串堆中已刷盘的字节数
+
+    static const uint32_t RECORD_VERSION = 2;
+    static const uint32_t LEGACY_PRICE_VERSION = 1;     // 原价为 double 元，打开时就地换算成分
+    static const uint32_t INITIAL_CAPACITY = 1024;
+    static const uint32_t INITIAL_HEAP_SIZE = 64 * 1024;
+
+    ProductRecordHeader* header() const { return reinterpret_cast<ProductRecordHeader*>(records.getData()); }
+    ProductRecord* slot(int productId) const;
+    bool ensureCapacity(uint32_t slots);
+    void markDirty(int productId);
+    bool appendString(const std::string& value, uint32_t& offset);
+    void migrateLegacyPrices();
+
+public:
+    ProductRecordStore(const std::string& recordFilename, const std::string& heapFilename);
+    ~ProductRecordStore();
+
+    bool open();
+    void close();
+
+    // 是否已有数据（用于判断是否需要从旧快照迁移）
+    bool isEmpty() const;
+    uint32_t getCapacity() const { return records.getData() ? header()->capacity : 0; }
+    int getNextProductId() const { return records.getData() ? header()->nextProductId : 1; }
+
+    // 读取某个槽位，空槽位返回 nullptr
+    const ProductRecord* getRecord(uint32_t index) const;
+    std::string readString(uint32_t offset, uint32_t length) const;
+
+    // 写入（或整体覆盖）商品ID对应的槽位；覆盖时旧的名称和商家名仍留在字符串堆中
+    bool append(const Product& product, uint8_t typeTag);
+    // 清空槽位，之后加载时跳过
+    void remove(int productId);
+    void updatePrice(int productId, Money price);
+    void updateStock(int productId, int stock);
+    void updateDiscount(int productId, double discount);
+    void updateFrozenStock(int productId, int frozenStock);
+    void setNextProductId(int nextProductId);
+
+    // 把攒下的脏页刷到磁盘
+    void flush();
+    size_t getPendingUpdates() const { return pendingUpdates; }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "product_snapshot_reader.h"
+#include <cstring>
+#include <stdexcept>
+
+ProductSnapshotReader::ProductSnapshotReader(std::istream& in, PriceEncoding encoding)
+    : in(&in), encoding(encoding), buffer(CHUNK_SIZE), data(buffer.data()), position(0), available(0), consumed(0) {
+}
+
+ProductSnapshotReader::ProductSnapshotReader(const char* memory, size_t size, PriceEncoding encoding)
+    : in(nullptr), encoding(encoding), data(memory), position(0), available(size), consumed(0) {
+}
+
+bool ProductSnapshotReader::fill(size_t needed) {
+    size_t remaining = available - position;
+    if (remaining >= needed || !in) {
+        return remaining >= needed;
+    }
+
+    // 未解析的尾部移到缓冲区开头，再整块读入
+    std::memmove(buffer.data(), buffer.data() + position, remaining);
+    position = 0;
+    available = remaining;
+    if (buffer.size() < needed) {
+        buffer.resize(needed);
+        data = buffer.data();
+    }
+    while (available < needed && *in) {
+        in->read(buffer.data() + available, static_cast<std::streamsize>(buffer.size() - available));
+        available += static_cast<size_t>(in->gcount());
+    }
+    return available >= needed;
+}
+
+template <typename T>
+T ProductSnapshotReader::readValue(const char* field) {
+    if (!fill(sizeof(T))) {
+        throw std::runtime_error(std::string("读取") + field + "失败，记录不完整");
+    }
+    T value;
+    std::memcpy(&value, data + position, sizeof(T));
+    position += sizeof(T);
+    consumed += sizeof(T);
+    return value;
+}
+
+void ProductSnapshotReader::readString(std::string& value, const char* field) {
+    uint32_t length = readValue<uint32_t>(field);
+    if (length > MAX_FIELD_LENGTH) {
+        throw std::runtime_error(std::string(field) + "长度异常: " + std::to_string(length));
+    }
+    if (!fill(length)) {
+        throw std::runtime_error(std::string("读取") + field + "失败，记录不完整");
+    }
+    value.assign(data + position, length);
+    position += length;
+    consumed += length;
+}
+
+bool ProductSnapshotReader::readHeader(int& nextProductId, size_t& productCount) {
+    if (!fill(HEADER_SIZE)) {
+        return false;
+    }
+    nextProductId = readValue<int>("下一个商品ID");
+    productCount = readValue<size_t>("商品数量");
+    return true;
+}
+
+void ProductSnapshotReader::seek(uint64_t offset) {
+    in->clear();
+    in->seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    position = 0;
+    available = 0;
+    consumed = offset;
+}
+
+bool ProductSnapshotReader::next(ProductSnapshotRecord& record) {
+    if (!fill(1)) {
+        return false;
+    }
+    readString(record.type, "商品类型");
+    record.productId = readValue<int>("商品ID");
+    readString(record.name, "商品名称");
+    record.price = encoding == PriceEncoding::LEGACY_YUAN ? Money::fromYuan(readValue<double>("商品价格"))
+        : Money::fromCents(readValue<int64_t>("商品价格"));
+    record.stock = readValue<int>("商品库存");
+    readString(record.merchantName, "商家名称");
+    record.discount = readValue<double>("商品折扣");
+    record.frozenStock = readValue<int>("冻结库存");
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef PRODUCT_SNAPSHOT_READER_H
+#define PRODUCT_SNAPSHOT_READER_H
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "product.h"
+
+// 快照中一条商品记录的全部字段，布局与 Product::serialize 一致（旧版本的原价为 double 元）
+struct ProductSnapshotRecord {
+    std::string type;
+    int productId;
+    std::string name;
+    Money price;
+    int stock;
+    std::string merchantName;
+    double discount;
+    int frozenStock;
+};
+
+// 第2版快照的文件头，只在迁移旧文件时读取。文件布局：
+// 文件头 | 商品记录... | 偏移表（blockCount 个 uint64，第 i 项为第 i*blockSize 条记录的偏移）
+// 第1版快照以 nextProductId 开头，没有魔数。当前版本改用 SnapshotFile 容器保存
+struct ProductSnapshotHeader {
+    char magic[4];              // "PSNP"
+    uint32_t version;           // 2
+    int32_t nextProductId;
+    uint32_t blockSize;         // 每个块的商品数
+    uint64_t productCount;
+    uint64_t tableOffset;       // 偏移表在文件中的位置
+};
+
+/**
+ * @brief 商品记录的解析
+ * 既可以解析容器快照中已经映射到内存的块，也可以流式读取旧版快照文件：
+ * 记录按块整段读入缓冲区后直接从内存解析字段，不再逐字段 ifstream::read 和 seekg 回退。
+ * 旧版文件头: nextProductId(int) | productCount(size_t)，之后是逐条商品记录。
+ */
+class ProductSnapshotReader {
+public:
+    static const size_t CHUNK_SIZE = 1 << 20;           // 每次从文件读入的字节数
+    static const uint32_t MAX_FIELD_LENGTH = 1000;      // 类型/名称/商家名长度上限，超过视为损坏
+    static const size_t HEADER_SIZE = sizeof(int) + sizeof(size_t);     // 旧版文件头字节数
+    // 一条记录的最小字节数（所有字符串为空），用于估算文件最多能容纳的商品数
+    static const size_t MIN_RECORD_SIZE = 3 * sizeof(uint32_t) + 3 * sizeof(int) + 2 * sizeof(double);
+
+    static const uint32_t SNAPSHOT_VERSION = 2;         // 带偏移表的旧版快照
+    static const uint32_t BLOCK_SIZE = 8192;            // 每块的商品数（偏移表和容器快照相同）
+
+    ProductSnapshotReader(std::istream& in, PriceEncoding encoding);
+    // 直接解析内存中的 [memory, memory + size)，偏移从0开始计
+    ProductSnapshotReader(const char* memory, size_t size, PriceEncoding encoding);
+
+    // 读取旧版文件头，文件不足一个文件头时返回false
+    bool readHeader(int& nextProductId, size_t& productCount);
+
+    // 跳到文件中的指定偏移继续读取（仅流式读取）
+    void seek(uint64_t offset);
+
+    // 读取下一条记录；文件恰好结束时返回false，记录不完整或字段异常时抛出 std::runtime_error
+    bool next(ProductSnapshotRecord& record);
+
+    // 已解析的字节数（即下一条记录在文件中的偏移）
+    uint64_t getOffset() const { return consumed; }
+
+private:
+    std::istream* in;       // 解析内存时为空
+    PriceEncoding encoding;
+    std::vector<char> buffer;
+    const char* data;       // 流式读取时指向 buffer
+    size_t position;        // 缓冲区中下一个未解析的字节
+    size_t available;       // 缓冲区中有效数据的末尾
+    uint64_t consumed;
+
+    // 保证缓冲区中至少有 needed 字节未解析，文件剩余不足时返回false
+    bool fill(size_t needed);
+    template <typename T> T readValue(const char* field);
+    void readString(std::string& value, const char* field);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "product_sort_index.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+struct RowLess {
+    const ProductColumns& columns;
+    ProductSortIndex::KeyFunction key;
+
+    bool operator()(size_t a, size_t b) const {
+        double keyA = key(columns, a);
+        double keyB = key(columns, b);
+        if (keyA != keyB) {
+            return keyA < keyB;
+        }
+        return columns.ids[a] < columns.ids[b];
+    }
+};
+
+}
+
+std::string ProductCursor::encode() const {
+    // 排序键按位写成十六进制，解码后与索引中的值完全相等
+    uint64_t bits;
+    std::memcpy(&bits, &lastKey, sizeof(bits));
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%d.%d.%016llx", static_cast<int>(sortKey), lastProductId,
+        static_cast<unsigned long long>(bits));
+    return buffer;
+}
+
+bool ProductCursor::decode(const std::string& token, ProductCursor& cursor) {
+    std::istringstream iss(token);
+    std::string sortKeyStr, idStr, keyStr;
+    if (!std::getline(iss, sortKeyStr, '.') || !std::getline(iss, idStr, '.') ||
+        !std::getline(iss, keyStr) || keyStr.size() != 16) {
+        return false;
+    }
+
+    try {
+        int sortKey = std::stoi(sortKeyStr);
+        if (sortKey < static_cast<int>(ProductSortKey::DEFAULT) || sortKey > static_cast<int>(ProductSortKey::NEWEST)) {
+            return false;
+        }
+        uint64_t bits = std::stoull(keyStr, nullptr, 16);
+        cursor.sortKey = static_cast<ProductSortKey>(sortKey);
+        cursor.lastProductId = std::stoi(idStr);
+        std::memcpy(&cursor.lastKey, &bits, sizeof(bits));
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+ProductSortIndex::ProductSortIndex(KeyFunction key) : key(key) {
+}
+
+void ProductSortIndex::rebuild(const ProductColumns& columns) {
+    // 先算出每行的键再排序，比较时不再反复调用键函数、随机访问列数据
+    struct Entry {
+        double key;
+        int productId;
+        size_t row;
+    };
+    std::vector<Entry> entries(columns.size());
+    for (size_t row = 0; row < entries.size(); ++row) {
+        entries[row] = { key(columns, row), columns.ids[row], row };
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.key != b.key) {
+            return a.key < b.key;
+        }
+        return a.productId < b.productId;
+    });
+
+    rows.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        rows[i] = entries[i].row;
+    }
+}
+
+void ProductSortIndex::resortRows(const ProductColumns& columns, const std::vector<size_t>& changedRows) {
+    if (changedRows.empty()) {
+        return;
+    }
+
+    // 按行号顺序先算出全部行的键（顺序访问列数据），归并时按排序顺序随机访问的只有这一个数组
+    std::vector<double> rowKeys(columns.size());
+    std::vector<char> changed(columns.size(), 0);
+    for (size_t row = 0; row < rowKeys.size(); ++row) {
+        rowKeys[row] = key(columns, row);
+    }
+    for (size_t row : changedRows) {
+        changed[row] = 1;
+    }
+
+    // 键改变的行摘出来单独排序，其余行保持原有顺序
+    struct Entry {
+        double key;
+        int productId;
+        size_t row;
+    };
+    std::vector<Entry> moved;
+    moved.reserve(changedRows.size());
+    for (size_t row : changedRows) {
+        moved.push_back({ rowKeys[row], columns.ids[row], row });
+    }
+    std::sort(moved.begin(), moved.end(), [](const Entry& a, const Entry& b) {
+        if (a.key != b.key) {
+            return a.key < b.key;
+        }
+        return a.productId < b.productId;
+    });
+
+    // 两个有序序列归并到新数组
+    std::vector<size_t> merged;
+    merged.reserve(rows.size());
+    size_t next = 0;
+    for (size_t row : rows) {
+        if (changed[row]) {
+            continue;
+        }
+        double rowKey = rowKeys[row];
+        int productId = columns.ids[row];
+        while (next < moved.size() &&
+            (moved[next].key < rowKey || (moved[next].key == rowKey && moved[next].productId < productId))) {
+            merged.push_back(moved[next++].row);
+        }
+        merged.push_back(row);
+    }
+    for (; next < moved.size(); ++next) {
+        merged.push_back(moved[next].row);
+    }
+    rows.swap(merged);
+}
+
+void ProductSortIndex::insert(const ProductColumns& columns, size_t row) {
+    auto it = std::lower_bound(rows.begin(), rows.end(), row, RowLess{ columns, key });
+    rows.insert(it, row);
+}
+
+size_t ProductSortIndex::lowerBound(const ProductColumns& columns, double value, int productId) const {
+    auto it = std::lower_bound(rows.begin(), rows.end(), 0, [&](size_t row, int) {
+        double rowKey = key(columns, row);
+        return rowKey < value || (rowKey == value && columns.ids[row] < productId);
+    });
+    return static_cast<size_t>(it - rows.begin());
+}
+
+size_t ProductSortIndex::upperBound(const ProductColumns& columns, double value, int productId) const {
+    auto it = std::upper_bound(rows.begin(), rows.end(), 0, [&](int, size_t row) {
+        double rowKey = key(columns, row);
+        return value < rowKey || (value == rowKey && productId < columns.ids[row]);
+    });
+    return static_cast<size_t>(it - rows.begin());
+}
+
+void ProductSortIndex::erase(const ProductColumns& columns, size_t row, double rowKey) {
+    // 列数据可能已经改成新值，按调用方给出的旧键二分定位；二分途中遇到该行自己时也按旧键比较
+    int productId = columns.ids[row];
+    auto position = std::lower_bound(rows.begin(), rows.end(), row, [&](size_t current, size_t) {
+        double currentKey = current == row ? rowKey : key(columns, current);
+        return currentKey < rowKey || (currentKey == rowKey && columns.ids[current] < productId);
+    });
+    if (position != rows.end() && *position == row) {
+        rows.erase(position);
+        return;
+    }
+    // 旧键与索引不一致时退回按行号查找，保证不会留下重复的行
+    auto it = std::find(rows.begin(), rows.end(), row);
+    if (it != rows.end()) {
+        rows.erase(it);
+    }
+}
+
+double ProductSortIndex::byEffectivePrice(const ProductColumns& columns, size_t row) {
+    // 分值不超过 2^53，转成 double 后仍是精确的整数
+    return static_cast<double>(columns.effectivePrice(row).getCents());
+}
+
+double ProductSortIndex::byDiscount(const ProductColumns& columns, size_t row) {
+    return columns.effectiveDiscount(row);
+}
\ No newline at end of file
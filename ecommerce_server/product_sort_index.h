@@ -0,0 +1,64 @@
+#ifndef PRODUCT_SORT_INDEX_H
+#define PRODUCT_SORT_INDEX_H
+
+#include "product_columns.h"
+#include "message.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief 键集分页游标：记录上一页最后一个商品的排序键和ID
+ * 编码为不含 '|' 和 ';' 的字符串交给客户端，客户端原样带回即可。
+ * 翻页时从该位置之后继续取，新增商品不会导致后续页内容错位。
+ */
+struct ProductCursor {
+    ProductSortKey sortKey;
+    double lastKey;
+    int lastProductId;
+
+    std::string encode() const;
+    static bool decode(const std::string& token, ProductCursor& cursor);
+};
+
+/**
+ * @brief 按某个排序键维护的有序行号数组
+ * 键相同的行按商品ID升序排列。排序列表第 N 页直接按位置取行号，
+ * 不需要每次请求都对整个商品目录排序。
+ * 单个商品的键变化时先按修改前的键 erase，修改后再 insert：两次都是二分定位，
+ * 之后移动其后的元素（一次 memmove，代价与目录大小成正比但常数很小）；批量修改后调用 rebuild。
+ */
+class ProductSortIndex {
+public:
+    typedef double (*KeyFunction)(const ProductColumns& columns, size_t row);
+
+    explicit ProductSortIndex(KeyFunction key);
+
+    void rebuild(const ProductColumns& columns);
+    void insert(const ProductColumns& columns, size_t row);
+    // rowKey 为该行修改前的键（其余行的键必须与索引一致）
+    void erase(const ProductColumns& columns, size_t row, double rowKey);
+    // changedRows（升序）中各行的键已改变、其余行不变：只对这些行按新键排序，再与其余行归并，
+    // 代价为 O(n + k log k)，k 为改变的行数
+    void resortRows(const ProductColumns& columns, const std::vector<size_t>& changedRows);
+    // 删除若干行（升序）后修正其余行号，相对顺序不变，不需要重新排序
+    void eraseRows(const std::vector<size_t>& erasedRows) { eraseAndShiftRows(rows, erasedRows); }
+
+    size_t size() const { return rows.size(); }
+    size_t at(size_t position) const { return rows[position]; }
+    double keyOf(const ProductColumns& columns, size_t row) const { return key(columns, row); }
+
+    // 第一个 (键, 商品ID) 不小于 / 大于给定值的位置
+    size_t lowerBound(const ProductColumns& columns, double key, int productId) const;
+    size_t upperBound(const ProductColumns& columns, double key, int productId) const;
+
+    // 常用排序键
+    static double byEffectivePrice(const ProductColumns& columns, size_t row);
+    static double byDiscount(const ProductColumns& columns, size_t row);
+
+private:
+    KeyFunction key;
+    std::vector<size_t> rows;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "product_suggest_index.h"
+#include "product_columns.h"
+#include <algorithm>
+#include <queue>
+
+namespace {
+
+inline unsigned char foldCase(char c) {
+    return static_cast<unsigned char>((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+}
+
+// 按字节比较，ASCII 字母不区分大小写
+int compareFolded(const std::string& a, const std::string& b) {
+    size_t length = std::min(a.size(), b.size());
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char x = foldCase(a[i]);
+        unsigned char y = foldCase(b[i]);
+        if (x != y) {
+            return x < y ? -1 : 1;
+        }
+    }
+    if (a.size() == b.size()) {
+        return 0;
+    }
+    return a.size() < b.size() ? -1 : 1;
+}
+
+bool startsWithFolded(const std::string& text, const std::string& prefix) {
+    if (text.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (foldCase(text[i]) != foldCase(prefix[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct SuggestRange {
+    uint32_t best;      // 区间内热度最高的位置
+    uint32_t first;
+    uint32_t last;
+};
+
+}
+
+const uint32_t ProductSuggestIndex::NOT_INDEXED;
+
+ProductSuggestIndex::ProductSuggestIndex() : leafCount(0) {
+}
+
+void ProductSuggestIndex::rebuild(const ProductList& products) {
+    size_t count = products.size();
+    popularity.resize(count, 0);
+    positionOf.assign(count, NOT_INDEXED);
+    pending.clear();
+
+    sortedRows.resize(count);
+    for (size_t row = 0; row < count; ++row) {
+        sortedRows[row] = static_cast<uint32_t>(row);
+    }
+    std::sort(sortedRows.begin(), sortedRows.end(), [&products](uint32_t a, uint32_t b) {
+        int order = compareFolded(products[a]->getName(), products[b]->getName());
+        return order != 0 ? order < 0 : a < b;
+    });
+    for (size_t position = 0; position < count; ++position) {
+        positionOf[sortedRows[position]] = static_cast<uint32_t>(position);
+    }
+    buildTree();
+}
+
+void ProductSuggestIndex::buildTree() {
+    // 自底向上建树：叶子在 [leafCount, 2*leafCount)
+    leafCount = sortedRows.size();
+    tree.assign(2 * leafCount, 0);
+    for (size_t position = 0; position < leafCount; ++position) {
+        tree[leafCount + position] = static_cast<uint32_t>(position);
+    }
+    for (size_t node = leafCount - 1; node >= 1 && leafCount > 1; --node) {
+        tree[node] = better(tree[2 * node], tree[2 * node + 1]);
+    }
+}
+
+void ProductSuggestIndex::insert(const ProductList& products, size_t row) {
+    if (row >= popularity.size()) {
+        popularity.resize(row + 1, 0);
+        positionOf.resize(row + 1, NOT_INDEXED);
+    }
+    pending.push_back(static_cast<uint32_t>(row));
+    if (pending.size() >= PENDING_LIMIT) {
+        rebuild(products);
+    }
+}
+
+void ProductSuggestIndex::eraseRows(const std::vector<size_t>& rows) {
+    size_t kept = 0;
+    size_t next = 0;
+    for (size_t row = 0; row < popularity.size(); ++row) {
+        if (next < rows.size() && rows[next] == row) {
+            next++;
+            continue;
+        }
+        popularity[kept++] = popularity[row];
+    }
+    popularity.resize(kept);
+
+    eraseAndShiftRows(sortedRows, rows);
+    eraseAndShiftRows(pending, rows);
+    positionOf.assign(kept, NOT_INDEXED);
+    for (size_t position = 0; position < sortedRows.size(); ++position) {
+        positionOf[sortedRows[position]] = static_cast<uint32_t>(position);
+    }
+    buildTree();
+}
+
+void ProductSuggestIndex::rename(const ProductList& products, size_t row) {
+    if (row >= positionOf.size() || positionOf[row] == NOT_INDEXED) {
+        return;     // 待合并的行查询时直接读取当前名称
+    }
+
+    // 先取出该行，再按新名称找到插入位置；只有两个位置之间的行位置变化
+    uint32_t from = positionOf[row];
+    sortedRows.erase(sortedRows.begin() + from);
+    const std::string& name = products[row]->getName();
+    uint32_t to = static_cast<uint32_t>(std::partition_point(sortedRows.begin(), sortedRows.end(),
+        [&](uint32_t other) {
+            int order = compareFolded(products[other]->getName(), name);
+            return order != 0 ? order < 0 : other < row;
+        }) - sortedRows.begin());
+    sortedRows.insert(sortedRows.begin() + to, static_cast<uint32_t>(row));
+
+    uint32_t first = std::min(from, to);
+    uint32_t last = std::max(from, to);
+    for (uint32_t position = first; position <= last; ++position) {
+        positionOf[sortedRows[position]] = position;
+    }
+    updateLeaves(first, last);
+}
+
+void ProductSuggestIndex::addPopularity(size_t row, uint32_t amount) {
+    if (row >= popularity.size()) {
+        return;
+    }
+    popularity[row] += amount;
+    if (positionOf[row] != NOT_INDEXED) {
+        updateLeaf(positionOf[row]);
+    }
+}
+
+uint32_t ProductSuggestIndex::better(uint32_t a, uint32_t b) const {
+    uint32_t popularityA = popularity[sortedRows[a]];
+    uint32_t popularityB = popularity[sortedRows[b]];
+    if (popularityA != popularityB) {
+        return popularityA > popularityB ? a : b;
+    }
+    return std::min(a, b);
+}
+
+void ProductSuggestIndex::updateLeaf(uint32_t position) {
+    for (size_t node = (leafCount + position) / 2; node >= 1; node /= 2) {
+        tree[node] = better(tree[2 * node], tree[2 * node + 1]);
+    }
+}
+
+void ProductSuggestIndex::updateLeaves(uint32_t first, uint32_t last) {
+    // 叶子存的是位置本身，不需要修改；逐层向上重算覆盖该区间的节点
+    // 同一层里父节点可能先于子节点重算，下一层会再算一次，最终结果不受影响
+    for (size_t left = (leafCount + first) / 2, right = (leafCount + last) / 2; right >= 1; left /= 2, right /= 2) {
+        for (size_t node = std::max<size_t>(left, 1); node <= right; ++node) {
+            tree[node] = better(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+}
+
+uint32_t ProductSuggestIndex::rangeBest(uint32_t first, uint32_t last) const {
+    uint32_t best = first;
+    for (size_t left = first + leafCount, right = last + leafCount; left < right; left /= 2, right /= 2) {
+        if (left & 1) {
+            best = better(best, tree[left++]);
+        }
+        if (right & 1) {
+            best = better(best, tree[--right]);
+        }
+    }
+    return best;
+}
+
+std::vector<std::string> ProductSuggestIndex::suggest(const ProductList& products, const std::string& prefix,
+    size_t limit) const {
+    std::vector<std::string> result;
+    if (limit == 0) {
+        return result;
+    }
+
+    // 前缀对应 sortedRows 中的连续一段 [first, last)
+    auto nameAt = [&](uint32_t position) -> const std::string& { return products[sortedRows[position]]->getName(); };
+    uint32_t first = static_cast<uint32_t>(std::partition_point(sortedRows.begin(), sortedRows.end(),
+        [&](uint32_t row) { return compareFolded(products[row]->getName(), prefix) < 0; }) - sortedRows.begin());
+    uint32_t last = static_cast<uint32_t>(std::partition_point(sortedRows.begin() + first, sortedRows.end(),
+        [&](uint32_t row) { return startsWithFolded(products[row]->getName(), prefix); }) - sortedRows.begin());
+
+    // 待合并的新商品直接扫描，按热度从高到低
+    std::vector<uint32_t> pendingMatches;
+    for (uint32_t row : pending) {
+        if (startsWithFolded(products[row]->getName(), prefix)) {
+            pendingMatches.push_back(row);
+        }
+    }
+    std::stable_sort(pendingMatches.begin(), pendingMatches.end(),
+        [this](uint32_t a, uint32_t b) { return popularity[a] > popularity[b]; });
+
+    // 堆中每个区间以其最热的位置为键；弹出一个位置后把左右两段放回
+    auto rangeLess = [this](const SuggestRange& a, const SuggestRange& b) { return better(a.best, b.best) != a.best; };
+    std::priority_queue<SuggestRange, std::vector<SuggestRange>, decltype(rangeLess)> ranges(rangeLess);
+    if (first < last) {
+        ranges.push({ rangeBest(first, last), first, last });
+    }
+
+    // 名称去重；重名很多时最多检查 limit * 8 个商品
+    size_t pendingNext = 0;
+    for (size_t examined = 0; result.size() < limit && examined < limit * 8; ++examined) {
+        bool fromRanges = !ranges.empty() && (pendingNext >= pendingMatches.size() ||
+            popularity[sortedRows[ranges.top().best]] >= popularity[pendingMatches[pendingNext]]);
+        const std::string* name = nullptr;
+        if (fromRanges) {
+            SuggestRange range = ranges.top();
+            ranges.pop();
+            name = &nameAt(range.best);
+            if (range.first < range.best) {
+                ranges.push({ rangeBest(range.first, range.best), range.first, range.best });
+            }
+            if (range.best + 1 < range.last) {
+                ranges.push({ rangeBest(range.best + 1, range.last), range.best + 1, range.last });
+            }
+        }
+        else if (pendingNext < pendingMatches.size()) {
+            name = &products[pendingMatches[pendingNext++]]->getName();
+        }
+        else {
+            break;
+        }
+
+        if (std::find(result.begin(), result.end(), *name) == result.end()) {
+            result.push_back(*name);
+        }
+    }
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef PRODUCT_SUGGEST_INDEX_H
+#define PRODUCT_SUGGEST_INDEX_H
+
+#include "product.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 商品名称前缀补全索引
+ * 行号按名称（ASCII 不区分大小写）排序存放，前缀对应其中连续的一段，二分查找即可定位；
+ * 段内按热度取前N个由一棵最大值线段树完成，每次取一个只需 O(log n)。
+ * 热度来自结算时的成交数量。新增的单个商品先放在待合并列表中，查询时顺带扫描，
+ * 积累到 PENDING_LIMIT 个后整体重建。
+ */
+class ProductSuggestIndex {
+public:
+    typedef std::vector<std::unique_ptr<Product>> ProductList;
+
+    static const size_t PENDING_LIMIT = 256;
+
+    ProductSuggestIndex();
+
+    void rebuild(const ProductList& products);
+    void insert(const ProductList& products, size_t row);
+    void addPopularity(size_t row, uint32_t amount);
+    // 删除若干行（升序）：其余行的热度随行号前移，名称顺序不变，不需要重新排序
+    void eraseRows(const std::vector<size_t>& rows);
+    // 第 row 行的名称已改变：只移动该行在名称顺序中的位置
+    void rename(const ProductList& products, size_t row);
+
+    // 以 prefix 开头的名称中热度最高的 limit 个（名称去重），热度相同时按名称顺序
+    std::vector<std::string> suggest(const ProductList& products, const std::string& prefix, size_t limit) const;
+
+private:
+    std::vector<uint32_t> sortedRows;       // 按名称排序的行号
+    std::vector<uint32_t> positionOf;       // 行号 -> sortedRows 中的位置，待合并的行为 NOT_INDEXED
+    std::vector<uint32_t> popularity;       // 行号 -> 热度
+    std::vector<uint32_t> tree;             // 线段树，叶子为 sortedRows 的位置，节点存区间内热度最高的位置
+    std::vector<uint32_t> pending;          // 尚未合并进 sortedRows 的行号
+    size_t leafCount;
+
+    static const uint32_t NOT_INDEXED = 0xFFFFFFFFu;
+
+    uint32_t better(uint32_t a, uint32_t b) const;
+    void buildTree();
+    void updateLeaf(uint32_t position);
+    void updateLeaves(uint32_t first, uint32_t last);          // 重算覆盖 [first, last] 的节点
+    uint32_t rangeBest(uint32_t first, uint32_t last) const;    // [first, last) 内热度最高的位置
+};
+
+#endif
\ No newline at end of file
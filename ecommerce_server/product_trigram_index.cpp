@@ -0,0 +1,166 @@
+#include "product_trigram_index.h"
+#include "product_columns.h"
+#include <algorithm>
+
+void ProductTrigramIndex::clear() {
+    postings.clear();
+}
+
+void ProductTrigramIndex::reserve(size_t rows) {
+    // 经验值：平均每个名称带来约一个新的三元组
+    postings.reserve(rows);
+}
+
+std::string ProductTrigramIndex::normalize(const std::string& text) {
+    std::string result = text;
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+void ProductTrigramIndex::trigramsOf(const std::string& text, std::vector<uint32_t>& grams) {
+    grams.clear();
+    if (text.size() < 3) {
+        return;
+    }
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        grams.push_back((static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8) |
+            static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2])));
+    }
+    // 同一名称中重复的三元组只计一次
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+void ProductTrigramIndex::add(size_t row, const std::string& name) {
+    std::vector<uint32_t> grams;
+    trigramsOf(normalize(name), grams);
+    for (uint32_t gram : grams) {
+        postings[gram].push_back(static_cast<uint32_t>(row));
+    }
+}
+
+void ProductTrigramIndex::remove(size_t row, const std::string& name) {
+    std::vector<uint32_t> grams;
+    trigramsOf(normalize(name), grams);
+    for (uint32_t gram : grams) {
+        auto it = postings.find(gram);
+        if (it == postings.end()) {
+            continue;
+        }
+        std::vector<uint32_t>& rows = it->second;
+        auto position = std::lower_bound(rows.begin(), rows.end(), static_cast<uint32_t>(row));
+        if (position != rows.end() && *position == row) {
+            rows.erase(position);
+        }
+        if (rows.empty()) {
+            postings.erase(it);
+        }
+    }
+}
+
+void ProductTrigramIndex::insert(size_t row, const std::string& name) {
+    std::vector<uint32_t> grams;
+    trigramsOf(normalize(name), grams);
+    for (uint32_t gram : grams) {
+        std::vector<uint32_t>& rows = postings[gram];
+        rows.insert(std::lower_bound(rows.begin(), rows.end(), static_cast<uint32_t>(row)), static_cast<uint32_t>(row));
+    }
+}
+
+void ProductTrigramIndex::eraseRows(const std::vector<size_t>& rows) {
+    for (auto it = postings.begin(); it != postings.end();) {
+        eraseAndShiftRows(it->second, rows);
+        if (it->second.empty()) {
+            it = postings.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+int ProductTrigramIndex::maxEditsFor(const std::string& keyword) {
+    // 多字节字符的一处字节编辑可能把一个字变成另一个字的半截，只对纯 ASCII 关键字容错
+    for (char c : keyword) {
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            return 0;
+        }
+    }
+    if (keyword.size() >= 12) {
+        return 2;
+    }
+    if (keyword.size() >= 6) {
+        return 1;
+    }
+    return 0;
+}
+
+bool ProductTrigramIndex::candidates(const std::string& keyword, int maxEdits, size_t rowCount,
+    std::vector<size_t>& rows) const {
+    rows.clear();
+    std::vector<uint32_t> grams;
+    trigramsOf(normalize(keyword), grams);
+
+    // 关键字去重后的三元组数，每处编辑最多破坏3个
+    int threshold = static_cast<int>(grams.size()) - 3 * maxEdits;
+    if (threshold <= 0) {
+        return false;
+    }
+
+    // 命中次数按行计数，只访问出现过的三元组的倒排表
+    std::vector<uint16_t> hits(rowCount, 0);
+    for (uint32_t gram : grams) {
+        auto it = postings.find(gram);
+        if (it == postings.end()) {
+            continue;
+        }
+        for (uint32_t row : it->second) {
+            if (row < rowCount && ++hits[row] == threshold) {
+                rows.push_back(row);
+            }
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    return true;
+}
+
+int ProductTrigramIndex::substringDistance(const std::string& keyword, const std::string& text, int maxEdits) {
+    // Sellers 算法：匹配可以从 text 的任意位置开始，第0行全为0。
+    // 加 Ukkonen 截断：只计算到最后一个不超过 maxEdits 的行（top）的下一行，其余格子视为 maxEdits + 1
+    size_t m = keyword.size();
+    std::vector<int> column(m + 1);
+    for (size_t i = 0; i <= m; ++i) {
+        column[i] = static_cast<int>(i);
+    }
+    size_t top = std::min(m, static_cast<size_t>(maxEdits));
+    int best = (top == m) ? column[m] : maxEdits + 1;
+
+    for (char raw : text) {
+        char c = (raw >= 'A' && raw <= 'Z') ? static_cast<char>(raw - 'A' + 'a') : raw;
+        size_t last = std::min(top + 1, m);
+        int diagonal = 0;     // 上一列的 column[i-1]
+        column[0] = 0;
+        for (size_t i = 1; i <= last; ++i) {
+            int previous = (i > top) ? maxEdits + 1 : column[i];
+            int cost = (keyword[i - 1] == c) ? 0 : 1;
+            column[i] = std::min({ diagonal + cost, previous + 1, column[i - 1] + 1 });
+            diagonal = previous;
+        }
+        top = last;
+        while (top > 0 && column[top] > maxEdits) {
+            top--;
+        }
+        if (top == m) {
+            best = std::min(best, column[m]);
+            if (best == 0) {
+                break;
+            }
+        }
+    }
+    return best <= maxEdits ? best : maxEdits + 1;
+}
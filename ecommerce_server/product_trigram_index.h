@@ -0,0 +1,50 @@
+#ifndef PRODUCT_TRIGRAM_INDEX_H
+#define PRODUCT_TRIGRAM_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 商品名称的三元组倒排索引，用于容错搜索
+ * 名称按字节（ASCII 字母转小写）切成三元组，每个三元组记录包含它的行号（升序）。
+ * 查询时先按 q-gram 引理筛候选：编辑距离不超过 k 的匹配至少共享 (m-2)-3k 个三元组，
+ * 再对候选用有界的近似子串编辑距离逐个验证。
+ * 按字节处理，与服务端使用的字符编码无关。一个汉字占多个字节，字节级编辑距离无法对应到字，
+ * 因此只有纯 ASCII 关键字允许编辑，含非 ASCII 字符的关键字按精确子串匹配。
+ */
+class ProductTrigramIndex {
+public:
+    void clear();
+    void reserve(size_t rows);
+
+    // 行号必须递增添加
+    void add(size_t row, const std::string& name);
+    // 单个商品改名：按旧名称移除、按新名称插入（倒排表保持升序）
+    void remove(size_t row, const std::string& name);
+    void insert(size_t row, const std::string& name);
+    // 删除若干行（升序）后修正其余行号
+    void eraseRows(const std::vector<size_t>& rows);
+
+    // 按关键字长度决定允许的编辑次数：短词要求精确，长词允许1-2处错误；含非 ASCII 字节时不允许编辑
+    static int maxEditsFor(const std::string& keyword);
+
+    // 共享三元组数达到阈值的候选行（升序）。阈值不为正时索引无法筛选，返回false
+    bool candidates(const std::string& keyword, int maxEdits, size_t rowCount,
+        std::vector<size_t>& rows) const;
+
+    // keyword 与 text 的某个子串之间的最小编辑距离，超过 maxEdits 时返回 maxEdits + 1；
+    // keyword 应先经过 normalize，text 在比较时逐字节转小写
+    static int substringDistance(const std::string& keyword, const std::string& text, int maxEdits);
+
+    static std::string normalize(const std::string& text);
+
+private:
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+
+    static void trigramsOf(const std::string& text, std::vector<uint32_t>& grams);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "response_cache.h"
+
+ResponseCache::ResponseCache(size_t budgetBytes)
+    : version(0), usedBytes(0), budgetBytes(budgetBytes), hitCount(0), missCount(0) {
+}
+
+size_t ResponseCache::entrySize(const Entry& entry) {
+    // 键存了两份（链表和哈希表），另加少量节点开销
+    return entry.buffer->size() + 2 * entry.key.size() + 64;
+}
+
+void ResponseCache::resetIfStale(uint64_t currentVersion) {
+    if (currentVersion == version) {
+        return;
+    }
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+    version = currentVersion;
+}
+
+ResponseCache::Buffer ResponseCache::find(const std::string& key, uint64_t currentVersion) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    resetIfStale(currentVersion);
+
+    auto it = index.find(key);
+    if (it == index.end()) {
+        missCount++;
+        return nullptr;
+    }
+    // 移到表头
+    entries.splice(entries.begin(), entries, it->second);
+    hitCount++;
+    return it->second->buffer;
+}
+
+void ResponseCache::store(const std::string& key, uint64_t bufferVersion, Buffer buffer) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    // 生成期间目录已经变化的响应不再缓存；缓存自身落后时先按新版本清空
+    if (bufferVersion < version) {
+        return;
+    }
+    resetIfStale(bufferVersion);
+
+    Entry entry{ key, buffer };
+    size_t size = entrySize(entry);
+    if (size > budgetBytes) {
+        return;
+    }
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        usedBytes -= entrySize(*it->second);
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    usedBytes += size;
+
+    while (usedBytes > budgetBytes && !entries.empty()) {
+        usedBytes -= entrySize(entries.back());
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+size_t ResponseCache::getHitCount() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return hitCount;
+}
+
+size_t ResponseCache::getMissCount() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return missCount;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+/**
+ * @brief 已编码响应的缓存
+ * 以请求内容为键，保存可以直接发送的字节流（消息头 + 数据）。
+ * 每个缓存都对应一个商品目录版本号，版本号变化后第一次访问时整体清空；
+ * 总字节数超过预算时按最近最少使用淘汰。
+ */
+class ResponseCache {
+public:
+    typedef std::shared_ptr<const std::vector<char>> Buffer;
+
+    explicit ResponseCache(size_t budgetBytes);
+
+    // 命中且版本一致时返回缓冲区，否则返回空指针
+    Buffer find(const std::string& key, uint64_t version);
+
+    // version 应在生成响应之前读取，生成期间目录若有修改，这条缓存在下次访问时即失效
+    void store(const std::string& key, uint64_t version, Buffer buffer);
+
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+
+private:
+    struct Entry {
+        std::string key;
+        Buffer buffer;
+    };
+
+    std::list<Entry> entries;       // 表头为最近使用
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    uint64_t version;
+    size_t usedBytes;
+    size_t budgetBytes;
+    size_t hitCount;
+    size_t missCount;
+    mutable std::mutex cacheMutex;
+
+    void resetIfStale(uint64_t currentVersion);     // 调用方需持有cacheMutex
+    static size_t entrySize(const Entry& entry);
+};
+
+#endif
\ No newline at end of file
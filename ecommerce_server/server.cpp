@@ -3,10 +3,13 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <limits>
+#include <cstring>
 
-Server::Server(int port) : port(port), running(false), serverSocket(INVALID_SOCKET),
-userManager("users.txt"), productManager("products.txt"),
-cartManager("carts.txt") {
+Server::Server(int port, ProductStorageMode storageMode) : port(port), running(false), serverSocket(INVALID_SOCKET),
+userManager("users.txt"), productManager("products.txt", storageMode),
+cartManager("carts.txt"), discountScheduler(productManager, "discount_schedules.txt"),
+productListCache(PRODUCT_LIST_CACHE_BYTES) {
     // 初始化Winsock
     WSADATA wsaData;
     int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -79,6 +82,8 @@ void Server::run() {
 
 void Server::handleClient(SOCKET clientSocket) {
     char buffer[4096];
+    // TCP 是字节流：一次 recv 可能只有半条消息，也可能包含多条，按消息头中的长度重新分帧
+    std::vector<char> pending;
 
     while (running) {
         int bytesReceived = recv(clientSocket, buffer, sizeof(buffer), 0);
@@ -88,12 +93,34 @@ void Server::handleClient(SOCKET clientSocket) {
             std::cout << "客户端断开连接: " << clientInfo[clientSocket] << std::endl;
             break;
         }
+        pending.insert(pending.end(), buffer, buffer + bytesReceived);
+
+        size_t consumed = 0;
+        bool invalidFrame = false;
+        while (pending.size() - consumed >= NetworkMessage::HEADER_SIZE) {
+            int length = 0;
+            std::memcpy(&length, pending.data() + consumed + sizeof(int), sizeof(int));
+            if (length < 0 || length > NetworkMessage::MAX_DATA_LENGTH) {
+                invalidFrame = true;
+                break;
+            }
+            size_t frameSize = NetworkMessage::HEADER_SIZE + static_cast<size_t>(length);
+            if (pending.size() - consumed < frameSize) {
+                break;
+            }
 
-        // 解析消息
-        std::vector<char> messageBuffer(buffer, buffer + bytesReceived);
-        NetworkMessage message = NetworkMessage::deserialize(messageBuffer);
+            // 解析消息
+            std::vector<char> messageBuffer(pending.begin() + consumed, pending.begin() + consumed + frameSize);
+            NetworkMessage message = NetworkMessage::deserialize(messageBuffer);
+            consumed += frameSize;
 
-        handleMessage(clientSocket, message);
+            handleMessage(clientSocket, message);
+        }
+        if (invalidFrame) {
+            std::cerr << "消息长度非法，断开连接: " << clientInfo[clientSocket] << std::endl;
+            break;
+        }
+        pending.erase(pending.begin(), pending.begin() + consumed);
     }
 
     // 清理客户端连接
@@ -115,8 +142,14 @@ void Server::handleClient(SOCKET clientSocket) {
 }
 
 void Server::handleMessage(SOCKET clientSocket, const NetworkMessage& message) {
-    std::cout << "收到消息 - 类型: " << static_cast<int>(message.type)
-        << ", 数据: " << message.data << std::endl;
+    // 批量导入等大消息只打印长度
+    std::cout << "收到消息 - 类型: " << static_cast<int>(message.type) << ", 数据: ";
+    if (message.data.size() <= 512) {
+        std::cout << message.data << std::endl;
+    }
+    else {
+        std::cout << "<" << message.data.size() << " 字节>" << std::endl;
+    }
 
     NetworkMessage response;
 
@@ -154,6 +187,14 @@ void Server::handleMessage(SOCKET clientSocket, const NetworkMessage& message) {
         handleProductDetailRequest(clientSocket, message.data);
         break;
 
+    case MessageType::PRODUCT_FILTER_REQUEST:
+        handleProductFilterRequest(clientSocket, message.data);
+        break;
+
+    case MessageType::PRODUCT_SUGGEST_REQUEST:
+        handleProductSuggestRequest(clientSocket, message.data);
+        break;
+
     case MessageType::MERCHANT_ADD_PRODUCT_REQUEST:
         handleMerchantAddProductRequest(clientSocket, message.data);
         break;
@@ -170,6 +211,26 @@ void Server::handleMessage(SOCKET clientSocket, const NetworkMessage& message) {
         handleMerchantSetDiscountRequest(clientSocket, message.data);
         break;
 
+    case MessageType::MERCHANT_IMPORT_PRODUCTS_REQUEST:
+        handleMerchantImportProductsRequest(clientSocket, message.data);
+        break;
+
+    case MessageType::MERCHANT_BATCH_MODIFY_REQUEST:
+        handleMerchantBatchModifyRequest(clientSocket, message.data);
+        break;
+
+    case MessageType::MERCHANT_SCHEDULE_DISCOUNT_REQUEST:
+        handleMerchantScheduleDiscountRequest(clientSocket, message.data);
+        break;
+
+    case MessageType::MERCHANT_DELIST_PRODUCTS_REQUEST:
+        handleMerchantDelistProductsRequest(clientSocket, message.data);
+        break;
+
+    case MessageType::MERCHANT_REPLACE_PRODUCT_REQUEST:
+        handleMerchantReplaceProductRequest(clientSocket, message.data);
+        break;
+
         // 购物车相关消息处理 - 这里是缺失的部分
     case MessageType::CART_ADD_ITEM_REQUEST:
         handleCartAddItemRequest(clientSocket, message.data);
@@ -250,62 +311,36 @@ void Server::handleLoginRequest(SOCKET clientSocket, const std::string& data) {
                 std::ifstream file(merchantOrderFile);
 
                 if (file.is_open()) {
-                    double totalEarnings = 0.0;
+                    Money totalEarnings;
                     int orderCount = 0;
                     std::string line;
 
                     while (std::getline(file, line)) {
                         if (line.find("收入:") == 0) {
-                            try {
-                                std::string amountStr = line.substr(3); // 去掉"收入:"
-
-                                // 调试输出
-                                std::cout << "解析收入行: [" << line << "]" << std::endl;
-                                std::cout << "提取金额字符串: [" << amountStr << "]" << std::endl;
-
-                                double amount = std::stod(amountStr);
+                            // 金额按 "元.分" 精确解析；旧版本按默认精度写出的浮点数（如 1.23457e+06）取整到分
+                            std::string amountStr = line.substr(std::string("收入:").size());
+                            Money amount;
+                            if (Money::parseLenient(amountStr, amount)) {
                                 totalEarnings += amount;
                                 orderCount++;
-
-                                std::cout << "解析成功，金额: " << amount << std::endl;
                             }
-                            catch (const std::exception& e) {
-                                std::cerr << "解析商家收入记录时出错: " << e.what() << std::endl;
-                                std::cerr << "问题行内容: [" << line << "]" << std::endl;
-
-                                // 尝试手动解析
-                                size_t colonPos = line.find(':');
-                                if (colonPos != std::string::npos) {
-                                    std::string manualAmountStr = line.substr(colonPos + 1);
-                                    std::cout << "手动提取: [" << manualAmountStr << "]" << std::endl;
-                                    try {
-                                        double amount = std::stod(manualAmountStr);
-                                        totalEarnings += amount;
-                                        orderCount++;
-                                        std::cout << "手动解析成功，金额: " << amount << std::endl;
-                                    }
-                                    catch (const std::exception& e2) {
-                                        std::cerr << "手动解析也失败: " << e2.what() << std::endl;
-                                    }
-                                }
+                            else {
+                                std::cerr << "解析商家收入记录时出错，问题行内容: [" << line << "]" << std::endl;
                             }
                         }
                     }
                     file.close();
 
-                    // 将累计收入设置为商家余额
-                    user->setBalance(totalEarnings);
+                    // 将累计收入设置为商家余额（有变化时追加一条用户日志）
+                    userManager.updateBalance(username, totalEarnings);
 
                     std::cout << "商家 [" << username << "] 登录时计算余额:" << std::endl;
                     std::cout << "  订单数量: " << orderCount << std::endl;
                     std::cout << "  累计收入: " << totalEarnings << " 元" << std::endl;
-
-                    // 保存用户数据
-                    userManager.saveUsers();
                 }
                 else {
                     std::cout << "商家 [" << username << "] 没有订单记录，余额为0" << std::endl;
-                    user->setBalance(0.0);
+                    userManager.updateBalance(username, Money());
                 }
             }
 
@@ -316,7 +351,7 @@ void Server::handleLoginRequest(SOCKET clientSocket, const std::string& data) {
             }
 
             std::string userTypeStr = (user->getUserType() == UserType::CONSUMER) ? "消费者" : "商家";
-            std::string response = "SUCCESS|登录成功|" + userTypeStr + "|" + std::to_string(user->getBalance());
+            std::string response = "SUCCESS|登录成功|" + userTypeStr + "|" + user->getBalance().toString();
             sendMessage(clientSocket, NetworkMessage(MessageType::LOGIN_RESPONSE, response));
 
             std::cout << "用户 [" << username << "] 登录成功，当前余额: " << user->getBalance() << " 元" << std::endl;
@@ -381,27 +416,103 @@ void Server::handleChangePasswordRequest(SOCKET clientSocket, const std::string&
     }
 }
 
+ProductSortKey Server::parseSortKey(const std::string& value) {
+    try {
+        int key = std::stoi(value);
+        if (key >= static_cast<int>(ProductSortKey::DEFAULT) && key <= static_cast<int>(ProductSortKey::NEWEST)) {
+            return static_cast<ProductSortKey>(key);
+        }
+    }
+    catch (const std::exception&) {
+        // 无效值按默认顺序处理
+    }
+    return ProductSortKey::DEFAULT;
+}
+
+std::string Server::formatFacets(const FacetCounts& facets) {
+    // 格式: FACETS#total=N#inStock=N#category:食品=N,...#merchant:商家=N,...#price:0-50=N,...
+    // 不含 ';'，旧客户端按商品解析时会直接忽略这一段
+    std::ostringstream out;
+    out << "FACETS#total=" << facets.total << "#inStock=" << facets.inStock << "#category:";
+    for (size_t category = 0; category < facets.categories.size(); ++category) {
+        out << (category > 0 ? "," : "") << CATEGORY_POLICIES[category].typeName << "=" << facets.categories[category];
+    }
+    out << "#merchant:";
+    bool first = true;
+    for (size_t merchantId = 0; merchantId < facets.merchants.size(); ++merchantId) {
+        if (facets.merchants[merchantId] == 0) {
+            continue;
+        }
+        out << (first ? "" : ",") << SymbolTable::merchants().lookup(static_cast<uint32_t>(merchantId))
+            << "=" << facets.merchants[merchantId];
+        first = false;
+    }
+    out << "#price:";
+    for (size_t bucket = 0; bucket < facets.priceBuckets.size(); ++bucket) {
+        out << (bucket > 0 ? "," : "") << ProductFacets::bucketLabel(bucket) << "=" << facets.priceBuckets[bucket];
+    }
+    return out.str();
+}
+
 void Server::handleProductListRequest(SOCKET clientSocket, const std::string& data) {
-    // 解析数据: page|pageSize
+    // 解析数据: page|pageSize[|sortKey[|cursor[|withTotals[|withFacets]]]]
+    // 带游标时从游标之后继续取，page 只原样回传；带游标的请求只有 withTotals 为 1 时才统计总页数
+    // withFacets 为 1 时在末尾附加全目录的分面计数
+    // 目录未变化时相同请求的响应完全相同，直接发送缓存的编码结果。
+    // 版本号必须在读取商品之前取得，生成期间若有修改，这条缓存下次访问即失效
+    uint64_t catalogVersion = productManager.getCatalogVersion();
+    ResponseCache::Buffer cached = productListCache.find(data, catalogVersion);
+    if (cached) {
+        sendBuffer(clientSocket, *cached);
+        return;
+    }
+
     std::istringstream iss(data);
-    std::string pageStr, pageSizeStr;
+    std::string pageStr, pageSizeStr, sortKeyStr, cursor, withTotalsStr, withFacetsStr;
 
     int page = 1;
     int pageSize = 5;
+    ProductSortKey sortKey = ProductSortKey::DEFAULT;
 
-    if (std::getline(iss, pageStr, '|') && std::getline(iss, pageSizeStr)) {
+    if (std::getline(iss, pageStr, '|') && std::getline(iss, pageSizeStr, '|')) {
         page = std::stoi(pageStr);
         pageSize = std::stoi(pageSizeStr);
     }
+    if (std::getline(iss, sortKeyStr, '|')) {
+        sortKey = parseSortKey(sortKeyStr);
+    }
+    bool hasCursor = static_cast<bool>(std::getline(iss, cursor, '|'));
+    bool withTotals = !hasCursor;
+    if (std::getline(iss, withTotalsStr, '|')) {
+        withTotals = withTotalsStr == "1";
+    }
+    bool withFacets = std::getline(iss, withFacetsStr) && withFacetsStr == "1";
 
-    std::vector<ProductInfo> products = productManager.getProductsByPage(page, pageSize);
-    int totalPages = productManager.getTotalPages(pageSize);
-    size_t totalCount = productManager.getProductCount();
+    std::vector<ProductInfo> products;
+    std::string nextCursor;
+    if (hasCursor || page == 1) {
+        // 第一页也走游标查询，顺便返回下一页的游标
+        if (!productManager.getProductsAfterCursor(cursor, pageSize, sortKey, products, nextCursor)) {
+            sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_LIST_RESPONSE, "ERROR|无效的分页游标"));
+            return;
+        }
+    }
+    else {
+        products = productManager.getProductsByPage(page, pageSize, sortKey);
+    }
+
+    int totalPages = -1;
+    long long totalCount = -1;
+    if (withTotals) {
+        totalPages = productManager.getTotalPages(pageSize);
+        totalCount = static_cast<long long>(productManager.getProductCount());
+    }
 
-    // 构建响应数据: totalPages|totalCount|currentPage|product1|product2|...
+    // 构建响应数据: totalPages|totalCount|currentPage|nextCursor|product1|product2|...
+    // 未统计总数时 totalPages/totalCount 为 -1；nextCursor 为空表示没有下一页
     // 每个商品格式: productId;name;originalPrice;currentPrice;stock;merchantName;productType;discount
     std::ostringstream response;
-    response << totalPages << "|" << totalCount << "|" << page;
+    response << totalPages << "|" << totalCount << "|" << page << "|" << nextCursor;
 
     for (const auto& product : products) {
         response << "|" << product.productId << ";"
@@ -413,12 +524,44 @@ void Server::handleProductListRequest(SOCKET clientSocket, const std::string& da
             << product.productType << ";"
             << product.discount;
     }
+    if (withFacets) {
+        response << "|" << formatFacets(productManager.getFacets());
+    }
 
-    sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_LIST_RESPONSE, response.str()));
+    auto buffer = std::make_shared<const std::vector<char>>(
+        NetworkMessage(MessageType::PRODUCT_LIST_RESPONSE, response.str()).serialize());
+    productListCache.store(data, catalogVersion, buffer);
+    sendBuffer(clientSocket, *buffer);
 }
 
 void Server::handleProductSearchRequest(SOCKET clientSocket, const std::string& data) {
-    std::vector<ProductInfo> products = productManager.searchProducts(data);
+    // 解析数据: keyword[|sortKey[|limit[|withFacets[|fuzzy]]]]，fuzzy 为 1 时允许拼写错误
+    std::istringstream iss(data);
+    std::string keyword, sortKeyStr, limitStr, withFacetsStr, fuzzyStr;
+    std::getline(iss, keyword, '|');
+
+    ProductSortKey sortKey = ProductSortKey::DEFAULT;
+    size_t limit = 0;
+    if (std::getline(iss, sortKeyStr, '|')) {
+        sortKey = parseSortKey(sortKeyStr);
+    }
+    if (std::getline(iss, limitStr, '|')) {
+        try {
+            int value = std::stoi(limitStr);
+            if (value > 0) {
+                limit = static_cast<size_t>(value);
+            }
+        }
+        catch (const std::exception&) {
+            // 忽略无效的数量限制
+        }
+    }
+    bool withFacets = std::getline(iss, withFacetsStr, '|') && withFacetsStr == "1";
+    bool fuzzy = std::getline(iss, fuzzyStr) && fuzzyStr == "1";
+
+    FacetCounts facets;
+    std::vector<ProductInfo> products = productManager.searchProducts(keyword, sortKey, limit, fuzzy,
+        withFacets ? &facets : nullptr);
 
     // 构建响应数据: count|product1|product2|...
     // 每个商品格式: productId;name;originalPrice;currentPrice;stock;merchantName;productType;discount
@@ -435,13 +578,50 @@ void Server::handleProductSearchRequest(SOCKET clientSocket, const std::string&
             << product.productType << ";"
             << product.discount;
     }
+    if (withFacets) {
+        response << "|" << formatFacets(facets);
+    }
 
     sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_SEARCH_RESPONSE, response.str()));
 }
 
+void Server::handleProductSuggestRequest(SOCKET clientSocket, const std::string& data) {
+    // 解析数据: prefix[|limit]，limit 默认 8，最多 20
+    std::istringstream iss(data);
+    std::string prefix, limitStr;
+    std::getline(iss, prefix, '|');
+
+    size_t limit = 8;
+    if (std::getline(iss, limitStr)) {
+        try {
+            int value = std::stoi(limitStr);
+            if (value > 0) {
+                limit = std::min(static_cast<size_t>(value), static_cast<size_t>(20));
+            }
+        }
+        catch (const std::exception&) {
+            // 忽略无效的数量限制
+        }
+    }
+
+    std::vector<std::string> names;
+    if (!prefix.empty()) {
+        names = productManager.suggestNames(prefix, limit);
+    }
+
+    // 构建响应数据: count|name1|name2|...
+    std::ostringstream response;
+    response << names.size();
+    for (const auto& name : names) {
+        response << "|" << name;
+    }
+
+    sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_SUGGEST_RESPONSE, response.str()));
+}
+
 void Server::handleProductDetailRequest(SOCKET clientSocket, const std::string& data) {
     int productId = std::stoi(data);
-    Product* product = productManager.getProductById(productId);
+    ProductRef product = productManager.getProductById(productId);
 
     if (product) {
         // 构建详细信息响应
@@ -454,7 +634,7 @@ void Server::handleProductDetailRequest(SOCKET clientSocket, const std::string&
             << product->getStock() << "|"
             << product->getMerchantName() << "|"
             << product->getProductType() << "|"
-            << product->getDiscount();
+            << product->getEffectiveDiscount();
 
         sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_DETAIL_RESPONSE, response.str()));
     }
@@ -464,6 +644,59 @@ void Server::handleProductDetailRequest(SOCKET clientSocket, const std::string&
     }
 }
 
+void Server::handleProductFilterRequest(SOCKET clientSocket, const std::string& data) {
+    // 解析数据: minPrice|maxPrice|inStockOnly[|maxResults]
+    // 价格传 -1 表示该侧不限，inStockOnly 为 1 时只返回有可售库存的商品
+    std::istringstream iss(data);
+    std::string minPriceStr, maxPriceStr, inStockStr, maxResultsStr;
+
+    if (!std::getline(iss, minPriceStr, '|') ||
+        !std::getline(iss, maxPriceStr, '|') ||
+        !std::getline(iss, inStockStr, '|')) {
+        sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_FILTER_RESPONSE, "ERROR|请求格式错误"));
+        return;
+    }
+
+    Money minPrice, maxPrice;
+    bool inStockOnly;
+    size_t maxResults = 200;
+    try {
+        if (!Money::parse(minPriceStr, minPrice) || !Money::parse(maxPriceStr, maxPrice)) {
+            throw std::invalid_argument("价格格式错误");
+        }
+        inStockOnly = std::stoi(inStockStr) != 0;
+        if (std::getline(iss, maxResultsStr) && !maxResultsStr.empty()) {
+            int value = std::stoi(maxResultsStr);
+            if (value > 0) {
+                maxResults = static_cast<size_t>(value);
+            }
+        }
+    }
+    catch (const std::exception&) {
+        sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_FILTER_RESPONSE, "ERROR|筛选参数格式错误"));
+        return;
+    }
+
+    if (minPrice < Money()) {
+        minPrice = Money::fromCents(std::numeric_limits<int64_t>::min());
+    }
+    if (maxPrice < Money()) {
+        maxPrice = Money::fromCents(std::numeric_limits<int64_t>::max());
+    }
+
+    std::vector<int> ids = productManager.filterProductIds(minPrice, maxPrice, inStockOnly);
+
+    // 构建响应数据: SUCCESS|totalCount|id1|id2|...（最多返回 maxResults 个ID）
+    std::ostringstream response;
+    response << "SUCCESS|" << ids.size();
+    size_t count = std::min(ids.size(), maxResults);
+    for (size_t i = 0; i < count; ++i) {
+        response << "|" << ids[i];
+    }
+
+    sendMessage(clientSocket, NetworkMessage(MessageType::PRODUCT_FILTER_RESPONSE, response.str()));
+}
+
 void Server::handleMerchantAddProductRequest(SOCKET clientSocket, const std::string& data) {
     // 检查用户是否已登录且为商家
     std::lock_guard<std::mutex> lock(clientsMutex);
@@ -494,7 +727,7 @@ void Server::handleMerchantAddProductRequest(SOCKET clientSocket, const std::str
         std::getline(iss, discountStr, '|')) {
 
         try {
-            double price = std::stod(priceStr);
+            Money price = parsePrice(priceStr);
             int stock = std::stoi(stockStr);
             double discount = std::stod(discountStr);
 
@@ -518,6 +751,223 @@ void Server::handleMerchantAddProductRequest(SOCKET clientSocket, const std::str
     }
 }
 
+void Server::handleMerchantImportProductsRequest(SOCKET clientSocket, const std::string& data) {
+    // 检查用户是否已登录且为商家（只在取用户名时持有clientsMutex）
+    std::string merchantName;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        auto it = loggedInUsers.find(clientSocket);
+        if (it == loggedInUsers.end()) {
+            std::string response = "ERROR|请先登录";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_IMPORT_PRODUCTS_RESPONSE, response));
+            return;
+        }
+        if (it->second->getUserType() != UserType::MERCHANT) {
+            std::string response = "ERROR|只有商家才能导入商品";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_IMPORT_PRODUCTS_RESPONSE, response));
+            return;
+        }
+        merchantName = it->second->getUsername();
+    }
+
+    // 解析数据: CSV 文本，整批校验通过才导入
+    std::vector<ProductImportRow> rows;
+    std::vector<std::string> errors;
+    if (!ProductImportParser::parse(data, rows, errors)) {
+        std::string response = "ERROR|导入数据有误，未导入任何商品";
+        for (const auto& error : errors) {
+            response += "|" + error;
+        }
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_IMPORT_PRODUCTS_RESPONSE, response));
+        return;
+    }
+    if (rows.empty()) {
+        std::string response = "ERROR|导入数据为空";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_IMPORT_PRODUCTS_RESPONSE, response));
+        return;
+    }
+
+    int firstProductId = 0;
+    if (productManager.importProducts(merchantName, rows, firstProductId)) {
+        // 响应: SUCCESS|导入数量|第一个商品ID，新商品ID连续
+        std::string response = "SUCCESS|" + std::to_string(rows.size()) + "|" + std::to_string(firstProductId);
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_IMPORT_PRODUCTS_RESPONSE, response));
+    }
+    else {
+        std::string response = "ERROR|商品导入失败";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_IMPORT_PRODUCTS_RESPONSE, response));
+    }
+}
+
+void Server::handleMerchantBatchModifyRequest(SOCKET clientSocket, const std::string& data) {
+    // 检查用户是否已登录且为商家（只在取用户名时持有clientsMutex）
+    std::string merchantName;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        auto it = loggedInUsers.find(clientSocket);
+        if (it == loggedInUsers.end()) {
+            std::string response = "ERROR|请先登录";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_BATCH_MODIFY_RESPONSE, response));
+            return;
+        }
+        if (it->second->getUserType() != UserType::MERCHANT) {
+            std::string response = "ERROR|只有商家才能修改商品";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_BATCH_MODIFY_RESPONSE, response));
+            return;
+        }
+        merchantName = it->second->getUsername();
+    }
+
+    // 解析数据: productId;price;stock;discount|productId;price;stock;discount|...
+    std::vector<ProductChange> changes;
+    std::istringstream iss(data);
+    std::string entry;
+    try {
+        while (std::getline(iss, entry, '|')) {
+            if (entry.empty()) {
+                continue;
+            }
+            std::istringstream entryStream(entry);
+            std::string idStr, priceStr, stockStr, discountStr;
+            if (!(std::getline(entryStream, idStr, ';') &&
+                std::getline(entryStream, priceStr, ';') &&
+                std::getline(entryStream, stockStr, ';') &&
+                std::getline(entryStream, discountStr, ';'))) {
+                std::string response = "ERROR|修改数据格式错误: " + entry;
+                sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_BATCH_MODIFY_RESPONSE, response));
+                return;
+            }
+            ProductChange change;
+            change.productId = std::stoi(idStr);
+            change.price = parsePrice(priceStr);
+            change.stock = std::stoi(stockStr);
+            change.discount = std::stod(discountStr);
+            changes.push_back(change);
+        }
+    }
+    catch (const std::exception& e) {
+        std::string response = "ERROR|数据格式错误: " + std::string(e.what());
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_BATCH_MODIFY_RESPONSE, response));
+        return;
+    }
+
+    if (changes.empty()) {
+        std::string response = "ERROR|没有需要修改的商品";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_BATCH_MODIFY_RESPONSE, response));
+        return;
+    }
+
+    std::string error;
+    if (productManager.applyChanges(merchantName, changes, error)) {
+        // 响应: SUCCESS|修改数量|目录版本号
+        std::string response = "SUCCESS|" + std::to_string(changes.size()) + "|" +
+            std::to_string(productManager.getCatalogVersion());
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_BATCH_MODIFY_RESPONSE, response));
+    }
+    else {
+        std::string response = "ERROR|" + error + "，未修改任何商品";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_BATCH_MODIFY_RESPONSE, response));
+    }
+}
+
+Money Server::parsePrice(const std::string& value) {
+    Money price;
+    if (!Money::parse(value, price)) {
+        throw std::invalid_argument("无效的金额: " + value);
+    }
+    return price;
+}
+
+int64_t Server::parseScheduleTime(const std::string& value, int64_t nowMillis) {
+    // "+N" 为 N 秒后，否则为 Unix 秒；返回毫秒
+    if (!value.empty() && value[0] == '+') {
+        return nowMillis + std::stoll(value.substr(1)) * 1000;
+    }
+    return std::stoll(value) * 1000;
+}
+
+void Server::handleMerchantScheduleDiscountRequest(SOCKET clientSocket, const std::string& data) {
+    std::string merchantName;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        auto it = loggedInUsers.find(clientSocket);
+        if (it == loggedInUsers.end()) {
+            std::string response = "ERROR|请先登录";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SCHEDULE_DISCOUNT_RESPONSE, response));
+            return;
+        }
+        if (it->second->getUserType() != UserType::MERCHANT) {
+            std::string response = "ERROR|只有商家才能设置折扣";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SCHEDULE_DISCOUNT_RESPONSE, response));
+            return;
+        }
+        merchantName = it->second->getUsername();
+    }
+
+    // 解析数据: 类型或商品ID;商品ID;...|discount|startTime|endTime
+    std::istringstream iss(data);
+    std::string target, discountStr, startStr, endStr;
+    if (!(std::getline(iss, target, '|') && std::getline(iss, discountStr, '|') &&
+        std::getline(iss, startStr, '|') && std::getline(iss, endStr))) {
+        std::string response = "ERROR|定时折扣数据格式错误";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SCHEDULE_DISCOUNT_RESPONSE, response));
+        return;
+    }
+
+    std::string productType;
+    std::vector<int> productIds;
+    double discount;
+    int64_t startTime, endTime;
+    try {
+        discount = std::stod(discountStr);
+        int64_t now = DiscountScheduler::nowMillis();
+        startTime = parseScheduleTime(startStr, now);
+        endTime = parseScheduleTime(endStr, now);
+
+        if (target == "食品" || target == "书籍" || target == "衣服") {
+            // 按类型设置：开始时只展开为该商家该类型的商品
+            productType = target;
+        }
+        else {
+            std::istringstream idStream(target);
+            std::string idStr;
+            while (std::getline(idStream, idStr, ';')) {
+                if (!idStr.empty()) {
+                    productIds.push_back(std::stoi(idStr));
+                }
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::string response = "ERROR|数据格式错误: " + std::string(e.what());
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SCHEDULE_DISCOUNT_RESPONSE, response));
+        return;
+    }
+
+    // 验证商品是否属于该商家
+    for (int productId : productIds) {
+        ProductRef product = productManager.getProductById(productId);
+        if (!product || product->getMerchantName() != merchantName) {
+            std::string response = "ERROR|商品[ID:" + std::to_string(productId) + "]不存在或不属于您";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SCHEDULE_DISCOUNT_RESPONSE, response));
+            return;
+        }
+    }
+
+    uint64_t windowId = 0;
+    std::string error;
+    if (discountScheduler.scheduleWindow(merchantName, productType, productIds, discount, startTime, endTime,
+        windowId, error)) {
+        // 响应: SUCCESS|定时折扣编号
+        std::string response = "SUCCESS|" + std::to_string(windowId);
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SCHEDULE_DISCOUNT_RESPONSE, response));
+    }
+    else {
+        std::string response = "ERROR|" + error;
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SCHEDULE_DISCOUNT_RESPONSE, response));
+    }
+}
+
 void Server::handleMerchantModifyProductRequest(SOCKET clientSocket, const std::string& data) {
     // 检查用户是否已登录且为商家
     std::lock_guard<std::mutex> lock(clientsMutex);
@@ -550,7 +1000,7 @@ void Server::handleMerchantModifyProductRequest(SOCKET clientSocket, const std::
             int productId = std::stoi(idStr);
 
             // 验证商品是否属于该商家（在修改前就验证）
-            Product* product = productManager.getProductById(productId);
+            ProductRef product = productManager.getProductById(productId);
             if (!product) {
                 std::string response = "ERROR|商品不存在";
                 sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_MODIFY_PRODUCT_RESPONSE, response));
@@ -565,7 +1015,7 @@ void Server::handleMerchantModifyProductRequest(SOCKET clientSocket, const std::
             }
 
             // 解析修改参数
-            double price = (priceStr == "-1") ? -1 : std::stod(priceStr);
+            Money price = (priceStr == "-1") ? Money::fromCents(-1) : parsePrice(priceStr);
             int stock = (stockStr == "-1") ? -1 : std::stoi(stockStr);
             double discount = (discountStr == "-1") ? -1 : std::stod(discountStr);
 
@@ -614,26 +1064,47 @@ void Server::handleMerchantProductListRequest(SOCKET clientSocket, const std::st
 
     std::string merchantName = user->getUsername();
 
-    // 解析数据: page|pageSize
+    // 解析数据: page|pageSize[|cursor[|withTotals]]
     std::istringstream iss(data);
-    std::string pageStr, pageSizeStr;
+    std::string pageStr, pageSizeStr, cursor, withTotalsStr;
 
     int page = 1;
     int pageSize = 10;
 
-    if (std::getline(iss, pageStr, '|') && std::getline(iss, pageSizeStr)) {
+    if (std::getline(iss, pageStr, '|') && std::getline(iss, pageSizeStr, '|')) {
         page = std::stoi(pageStr);
         pageSize = std::stoi(pageSizeStr);
     }
+    bool hasCursor = static_cast<bool>(std::getline(iss, cursor, '|'));
+    bool withTotals = !hasCursor;
+    if (std::getline(iss, withTotalsStr)) {
+        withTotals = withTotalsStr == "1";
+    }
 
-    std::vector<ProductInfo> products = productManager.getMerchantProductsByPage(merchantName, page, pageSize);
-    int totalCount = productManager.getMerchantProductCount(merchantName);
-    int totalPages = (totalCount + pageSize - 1) / pageSize;
+    std::vector<ProductInfo> products;
+    std::string nextCursor;
+    if (hasCursor || page == 1) {
+        // 第一页也走游标查询，顺便返回下一页的游标
+        if (!productManager.getMerchantProductsAfterCursor(merchantName, cursor, pageSize, products, nextCursor)) {
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_PRODUCT_LIST_RESPONSE, "ERROR|无效的分页游标"));
+            return;
+        }
+    }
+    else {
+        products = productManager.getMerchantProductsByPage(merchantName, page, pageSize);
+    }
 
-    // 构建响应数据: totalPages|totalCount|currentPage|product1|product2|...
+    int totalPages = -1;
+    int totalCount = -1;
+    if (withTotals) {
+        totalCount = productManager.getMerchantProductCount(merchantName);
+        totalPages = (totalCount + pageSize - 1) / pageSize;
+    }
+
+    // 构建响应数据: totalPages|totalCount|currentPage|nextCursor|product1|product2|...
     // 每个商品格式: productId;name;originalPrice;currentPrice;stock;productType;discount
     std::ostringstream response;
-    response << totalPages << "|" << totalCount << "|" << page;
+    response << totalPages << "|" << totalCount << "|" << page << "|" << nextCursor;
 
     for (const auto& product : products) {
         response << "|" << product.productId << ";"
@@ -665,21 +1136,29 @@ void Server::handleMerchantSetDiscountRequest(SOCKET clientSocket, const std::st
         return;
     }
 
-    // 解析数据: type|discount 或 productId|discount
+    // 解析数据: type|discount[|min 或 multiply] 或 productId|discount
     std::istringstream iss(data);
-    std::string param1, discountStr;
+    std::string param1, discountStr, compositionStr;
 
-    if (std::getline(iss, param1, '|') && std::getline(iss, discountStr)) {
+    if (std::getline(iss, param1, '|') && std::getline(iss, discountStr, '|')) {
+        std::getline(iss, compositionStr);
         try {
             double discount = std::stod(discountStr);
 
             // 判断是按类型设置还是按商品ID设置
             if (param1 == "食品" || param1 == "书籍" || param1 == "衣服") {
-                // 按类型设置折扣，但只对该商家的商品生效
-                // 这里需要扩展功能，目前先设置所有该类型商品
-                int count = productManager.setDiscountByType(param1, discount);
-
-                std::string response = "SUCCESS|成功为 " + std::to_string(count) + " 个" + param1 + "商品设置折扣";
+                // 按类型设置类别折扣（全类别生效），默认与商品自身折扣取低，multiply 表示叠加
+                DiscountComposition composition = compositionStr == "multiply"
+                    ? DiscountComposition::MULTIPLY : DiscountComposition::MIN;
+                int count = 0;
+                std::string error;
+                std::string response;
+                if (productManager.setDiscountByType(param1, discount, composition, count, error)) {
+                    response = "SUCCESS|成功为 " + std::to_string(count) + " 个" + param1 + "商品设置折扣";
+                }
+                else {
+                    response = "ERROR|" + error;
+                }
                 sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SET_DISCOUNT_RESPONSE, response));
             }
             else {
@@ -687,14 +1166,14 @@ void Server::handleMerchantSetDiscountRequest(SOCKET clientSocket, const std::st
                 int productId = std::stoi(param1);
 
                 // 验证商品是否属于该商家
-                Product* product = productManager.getProductById(productId);
+                ProductRef product = productManager.getProductById(productId);
                 if (!product || product->getMerchantName() != user->getUsername()) {
                     std::string response = "ERROR|商品不存在或不属于您";
                     sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SET_DISCOUNT_RESPONSE, response));
                     return;
                 }
 
-                if (productManager.modifyProduct(productId, -1, -1, discount)) {
+                if (productManager.modifyProduct(productId, Money::fromCents(-1), -1, discount)) {
                     std::string response = "SUCCESS|商品折扣设置成功";
                     sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_SET_DISCOUNT_RESPONSE, response));
                 }
@@ -715,6 +1194,121 @@ void Server::handleMerchantSetDiscountRequest(SOCKET clientSocket, const std::st
     }
 }
 
+void Server::handleMerchantDelistProductsRequest(SOCKET clientSocket, const std::string& data) {
+    // 检查用户是否已登录且为商家（只在取用户名时持有clientsMutex）
+    std::string merchantName;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        auto it = loggedInUsers.find(clientSocket);
+        if (it == loggedInUsers.end()) {
+            std::string response = "ERROR|请先登录";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_DELIST_PRODUCTS_RESPONSE, response));
+            return;
+        }
+        if (it->second->getUserType() != UserType::MERCHANT) {
+            std::string response = "ERROR|只有商家才能下架商品";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_DELIST_PRODUCTS_RESPONSE, response));
+            return;
+        }
+        merchantName = it->second->getUsername();
+    }
+
+    // 解析数据: productId;productId;...
+    std::vector<int> productIds;
+    std::istringstream iss(data);
+    std::string idStr;
+    try {
+        while (std::getline(iss, idStr, ';')) {
+            if (!idStr.empty()) {
+                productIds.push_back(std::stoi(idStr));
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::string response = "ERROR|数据格式错误: " + std::string(e.what());
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_DELIST_PRODUCTS_RESPONSE, response));
+        return;
+    }
+
+    if (productIds.empty()) {
+        std::string response = "ERROR|没有需要下架的商品";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_DELIST_PRODUCTS_RESPONSE, response));
+        return;
+    }
+
+    std::string error;
+    if (productManager.delistProducts(merchantName, productIds, error)) {
+        // 响应: SUCCESS|下架数量|目录版本号
+        std::string response = "SUCCESS|" + std::to_string(productIds.size()) + "|" +
+            std::to_string(productManager.getCatalogVersion());
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_DELIST_PRODUCTS_RESPONSE, response));
+    }
+    else {
+        std::string response = "ERROR|" + error + "，未下架任何商品";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_DELIST_PRODUCTS_RESPONSE, response));
+    }
+}
+
+void Server::handleMerchantReplaceProductRequest(SOCKET clientSocket, const std::string& data) {
+    // 检查用户是否已登录且为商家（只在取用户名时持有clientsMutex）
+    std::string merchantName;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        auto it = loggedInUsers.find(clientSocket);
+        if (it == loggedInUsers.end()) {
+            std::string response = "ERROR|请先登录";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_REPLACE_PRODUCT_RESPONSE, response));
+            return;
+        }
+        if (it->second->getUserType() != UserType::MERCHANT) {
+            std::string response = "ERROR|只有商家才能修改商品";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_REPLACE_PRODUCT_RESPONSE, response));
+            return;
+        }
+        merchantName = it->second->getUsername();
+    }
+
+    // 解析数据: productId|type|name|price|stock|discount
+    std::istringstream iss(data);
+    std::string idStr, type, name, priceStr, stockStr, discountStr;
+    if (!(std::getline(iss, idStr, '|') &&
+        std::getline(iss, type, '|') &&
+        std::getline(iss, name, '|') &&
+        std::getline(iss, priceStr, '|') &&
+        std::getline(iss, stockStr, '|') &&
+        std::getline(iss, discountStr, '|'))) {
+        std::string response = "ERROR|商品数据格式错误";
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_REPLACE_PRODUCT_RESPONSE, response));
+        return;
+    }
+
+    try {
+        int productId = std::stoi(idStr);
+        Money price = parsePrice(priceStr);
+        int stock = std::stoi(stockStr);
+        double discount = std::stod(discountStr);
+        if (stock < 0 || discount <= 0.0 || discount > 1.0) {
+            std::string response = "ERROR|库存不能为负数，折扣必须在0.0到1.0之间";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_REPLACE_PRODUCT_RESPONSE, response));
+            return;
+        }
+
+        std::string error;
+        if (productManager.replaceProduct(merchantName, productId, type, name, price, stock, discount, error)) {
+            std::string response = "SUCCESS|商品替换成功";
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_REPLACE_PRODUCT_RESPONSE, response));
+        }
+        else {
+            std::string response = "ERROR|" + error;
+            sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_REPLACE_PRODUCT_RESPONSE, response));
+        }
+    }
+    catch (const std::exception& e) {
+        std::string response = "ERROR|数据格式错误: " + std::string(e.what());
+        sendMessage(clientSocket, NetworkMessage(MessageType::MERCHANT_REPLACE_PRODUCT_RESPONSE, response));
+    }
+}
+
 void Server::handleCartAddItemRequest(SOCKET clientSocket, const std::string& data) {
     std::cout << "处理添加到购物车请求: " << data << std::endl;
 
@@ -758,7 +1352,7 @@ void Server::handleCartAddItemRequest(SOCKET clientSocket, const std::string& da
             }
 
             // 获取商品信息
-            Product* product = productManager.getProductById(productId);
+            ProductRef product = productManager.getProductById(productId);
             if (!product) {
                 std::string response = "ERROR|商品不存在";
                 std::cout << "[DEBUG] 商品不存在，发送错误响应" << std::endl;
@@ -785,7 +1379,7 @@ void Server::handleCartAddItemRequest(SOCKET clientSocket, const std::string& da
             item.currentPrice = product->getPrice();
             item.quantity = quantity;
             item.merchantName = product->getMerchantName();
-            item.discount = product->getDiscount();
+            item.discount = product->getEffectiveDiscount();
 
             std::cout << "[DEBUG] 创建购物车项目完成，准备添加到购物车" << std::endl;
 
@@ -842,7 +1436,7 @@ void Server::handleCartViewRequest(SOCKET clientSocket, const std::string& data)
 
     // 获取用户购物车
     std::vector<CartItem> cartItems = cartManager.getUserCartItems(username);
-    double totalPrice = cartManager.getUserCartTotalPrice(username);
+    Money totalPrice = cartManager.getUserCartTotalPrice(username);
     int totalCount = cartManager.getUserCartItemCount(username);
 
     // 构建响应数据: SUCCESS|totalCount|totalPrice|item1|item2|...
@@ -912,7 +1506,7 @@ void Server::handleCartUpdateItemRequest(SOCKET clientSocket, const std::string&
             }
 
             // 检查商品是否存在以及库存
-            Product* product = productManager.getProductById(productId);
+            ProductRef product = productManager.getProductById(productId);
             if (!product) {
                 std::string response = "ERROR|商品不存在";
                 sendMessage(clientSocket, NetworkMessage(MessageType::CART_UPDATE_ITEM_RESPONSE, response));
@@ -1020,8 +1614,8 @@ void Server::handleCartClearRequest(SOCKET clientSocket, const std::string& data
 void Server::handleOrderCheckoutRequest(SOCKET clientSocket, const std::string& data) {
     std::cout << "处理订单结算请求" << std::endl;
 
-    // 检查用户是否已登录且为消费者
-    std::lock_guard<std::mutex> lock(clientsMutex);
+    // 检查用户是否已登录且为消费者；clientsMutex 只保护会话和余额，扣库存期间释放
+    std::unique_lock<std::mutex> lock(clientsMutex);
     auto it = loggedInUsers.find(clientSocket);
     if (it == loggedInUsers.end()) {
         std::string response = "ERROR|请先登录";
@@ -1047,62 +1641,61 @@ void Server::handleOrderCheckoutRequest(SOCKET clientSocket, const std::string&
     }
 
     // 计算总价
-    double totalPrice = cartManager.getUserCartTotalPrice(username);
+    Money totalPrice = cartManager.getUserCartTotalPrice(username);
 
     // 检查用户余额
     if (user->getBalance() < totalPrice) {
-        std::string response = "ERROR|余额不足，当前余额：" + std::to_string(user->getBalance()) +
-            "，需要：" + std::to_string(totalPrice);
+        std::string response = "ERROR|余额不足，当前余额：" + user->getBalance().toString() +
+            "，需要：" + totalPrice.toString();
+        sendMessage(clientSocket, NetworkMessage(MessageType::ORDER_CHECKOUT_RESPONSE, response));
+        return;
+    }
+
+    // 整单扣减库存：按商品ID顺序锁住涉及的分段，全部满足才扣减，
+    // 不涉及相同商品的结算可以并行进行
+    lock.unlock();
+    std::vector<std::pair<int, int>> stockItems;
+    for (const auto& item : cartItems) {
+        stockItems.push_back({ item.productId, item.quantity });
+    }
+
+    int failedProductId = 0;
+    if (!productManager.reserveStock(stockItems, failedProductId)) {
+        ProductRef product = productManager.getProductById(failedProductId);
+        std::string response = product
+            ? "ERROR|商品[" + product->getName() + "]库存不足，当前库存：" + std::to_string(product->getStock())
+            : "ERROR|商品[ID:" + std::to_string(failedProductId) + "]不存在";
+        sendMessage(clientSocket, NetworkMessage(MessageType::ORDER_CHECKOUT_RESPONSE, response));
+        return;
+    }
+
+    // 扣库存期间余额可能被其他请求修改，重新加锁后再次检查
+    lock.lock();
+    if (user->getBalance() < totalPrice) {
+        productManager.releaseStock(stockItems);
+        std::string response = "ERROR|余额不足，当前余额：" + user->getBalance().toString() +
+            "，需要：" + totalPrice.toString();
         sendMessage(clientSocket, NetworkMessage(MessageType::ORDER_CHECKOUT_RESPONSE, response));
         return;
     }
 
     // 记录各商家应得金额和订单商品（只定义一次）
-    std::map<std::string, double> merchantEarnings;
+    std::map<std::string, Money> merchantEarnings;
     std::map<std::string, std::vector<std::string>> merchantOrderItems;
 
-    // 检查库存并预扣除，同时计算商家收入
-    std::vector<std::pair<int, int>> stockOperations; // 记录库存操作，以便回滚
-
     for (const auto& item : cartItems) {
-        Product* product = productManager.getProductById(item.productId);
+        ProductRef product = productManager.getProductById(item.productId);
         if (!product) {
-            // 回滚之前的库存操作
-            for (auto& op : stockOperations) {
-                Product* rollbackProduct = productManager.getProductById(op.first);
-                if (rollbackProduct) {
-                    rollbackProduct->setStock(rollbackProduct->getStock() + op.second);
-                }
-            }
-
-            std::string response = "ERROR|商品[ID:" + std::to_string(item.productId) + "]不存在";
-            sendMessage(clientSocket, NetworkMessage(MessageType::ORDER_CHECKOUT_RESPONSE, response));
-            return;
-        }
-
-        if (!product->isAvailable(item.quantity)) {
-            // 回滚之前的库存操作
-            for (auto& op : stockOperations) {
-                Product* rollbackProduct = productManager.getProductById(op.first);
-                if (rollbackProduct) {
-                    rollbackProduct->setStock(rollbackProduct->getStock() + op.second);
-                }
-            }
-
-            std::string response = "ERROR|商品[" + product->getName() + "]库存不足，当前库存：" +
-                std::to_string(product->getStock());
+            // 扣库存之后商品被下架，整单撤销
+            productManager.releaseStock(stockItems);
+            std::string response = "ERROR|商品[ID:" + std::to_string(item.productId) + "]已下架";
             sendMessage(clientSocket, NetworkMessage(MessageType::ORDER_CHECKOUT_RESPONSE, response));
             return;
         }
 
-        // 扣除库存
-        int newStock = product->getStock() - item.quantity;
-        product->setStock(newStock);
-        stockOperations.push_back({ item.productId, item.quantity });
-
         // 计算商家收入
         std::string merchantName = product->getMerchantName();
-        double itemTotal = item.currentPrice * item.quantity;
+        Money itemTotal = item.getTotalPrice();
         merchantEarnings[merchantName] += itemTotal;
 
         std::cout << "商品: " << product->getName()
@@ -1111,15 +1704,20 @@ void Server::handleOrderCheckoutRequest(SOCKET clientSocket, const std::string&
 
         // 记录商家的订单商品
         std::string itemInfo = product->getName() + "|数量:" + std::to_string(item.quantity) +
-            "|单价:" + std::to_string(item.currentPrice) +
-            "|小计:" + std::to_string(itemTotal) +
+            "|单价:" + item.currentPrice.toString() +
+            "|小计:" + itemTotal.toString() +
             "|客户:" + username;
         merchantOrderItems[merchantName].push_back(itemInfo);
     }
 
-    // 扣除消费者余额
-    double newBalance = user->getBalance() - totalPrice;
-    user->setBalance(newBalance);
+    // 扣除消费者余额，余额记录落盘后才继续；写入失败时余额未变，归还库存后整单失败
+    Money newBalance = user->getBalance() - totalPrice;
+    if (!userManager.updateBalance(username, newBalance)) {
+        productManager.releaseStock(stockItems);
+        std::string response = "ERROR|结算失败：无法保存余额变更，请稍后重试";
+        sendMessage(clientSocket, NetworkMessage(MessageType::ORDER_CHECKOUT_RESPONSE, response));
+        return;
+    }
 
     // 生成订单时间和订单ID
     time_t now = time(0);
@@ -1142,12 +1740,12 @@ void Server::handleOrderCheckoutRequest(SOCKET clientSocket, const std::string&
 
         // 写入商品详情
         for (const auto& item : cartItems) {
-            Product* product = productManager.getProductById(item.productId);
+            ProductRef product = productManager.getProductById(item.productId);
             if (product) {
                 customerFile << "  " << product->getName()
                     << "|数量:" << item.quantity
                     << "|单价:" << item.currentPrice
-                    << "|小计:" << (item.currentPrice * item.quantity)
+                    << "|小计:" << item.getTotalPrice()
                     << "|商家:" << product->getMerchantName() << std::endl;
             }
         }
@@ -1160,7 +1758,7 @@ void Server::handleOrderCheckoutRequest(SOCKET clientSocket, const std::string&
     // 为每个商家写入订单记录：orders_商家用户名.txt
     for (const auto& earning : merchantEarnings) {
         std::string merchantName = earning.first;
-        double amount = earning.second;
+        Money amount = earning.second;
 
         std::cout << "为商家 [" << merchantName << "] 写入收入记录: " << amount << " 元" << std::endl;
 
@@ -1198,16 +1796,15 @@ void Server::handleOrderCheckoutRequest(SOCKET clientSocket, const std::string&
     std::cout << "总价: " << totalPrice << std::endl;
     std::cout << "商品数量: " << cartItems.size() << std::endl;
 
+    // 成交数量计入商品热度，用于搜索建议排序
+    productManager.recordSales(stockItems);
+
     // 清空用户购物车
     cartManager.clearUserCart(username);
 
-    // 保存数据
-    userManager.saveUsers();
-    productManager.saveProducts();
-
     std::string response = "SUCCESS|订单创建成功，订单ID：" + std::to_string(orderId) +
-        "，订单金额：" + std::to_string(totalPrice) +
-        "，余额：" + std::to_string(newBalance);
+        "，订单金额：" + totalPrice.toString() +
+        "，余额：" + newBalance.toString();
     sendMessage(clientSocket, NetworkMessage(MessageType::ORDER_CHECKOUT_RESPONSE, response));
 
     std::cout << "用户 [" << username << "] 完成订单结算，订单ID: " << orderId << std::endl;
@@ -1355,8 +1952,10 @@ bool Server::sendMessage(SOCKET clientSocket, const NetworkMessage& message) {
     std::cout << "[DEBUG] 服务器发送消息类型: " << static_cast<int>(message.type)
         << ", 数据: " << message.data << std::endl;
 
-    std::vector<char> buffer = message.serialize();
+    return sendBuffer(clientSocket, message.serialize());
+}
 
+bool Server::sendBuffer(SOCKET clientSocket, const std::vector<char>& buffer) {
     int totalSent = 0;
     int bufferSize = static_cast<int>(buffer.size());
 
@@ -14,6 +14,8 @@
 #include "user_manager.h"
 #include "product_manager.h"
 #include "cart_manager.h"  // 确保包含购物车管理器
+#include "response_cache.h"
+#include "discount_scheduler.h"
 
 #pragma comment(lib, "ws2_32.lib")
 
@@ -30,6 +32,11 @@ private:
     UserManager userManager;
     ProductManager productManager;
     CartManager cartManager; // 购物车管理器
+    DiscountScheduler discountScheduler;   // 定时折扣，依赖 productManager，须在其后声明
+
+    // 商品列表响应缓存：键为请求内容，目录版本号变化后失效
+    ResponseCache productListCache;
+    static const size_t PRODUCT_LIST_CACHE_BYTES = 4 * 1024 * 1024;
 
     // 处理客户端连接的线程函数
     void handleClient(SOCKET clientSocket);
@@ -42,15 +49,27 @@ private:
     void handleLoginRequest(SOCKET clientSocket, const std::string& data);
     void handleLogoutRequest(SOCKET clientSocket);
     void handleChangePasswordRequest(SOCKET clientSocket, const std::string& data);
+    static ProductSortKey parseSortKey(const std::string& value);
+    static std::string formatFacets(const FacetCounts& facets);
     void handleProductListRequest(SOCKET clientSocket, const std::string& data);
     void handleProductSearchRequest(SOCKET clientSocket, const std::string& data);
     void handleProductDetailRequest(SOCKET clientSocket, const std::string& data);
+    void handleProductFilterRequest(SOCKET clientSocket, const std::string& data);
+    void handleProductSuggestRequest(SOCKET clientSocket, const std::string& data);
 
     // 商家商品管理
     void handleMerchantAddProductRequest(SOCKET clientSocket, const std::string& data);
     void handleMerchantModifyProductRequest(SOCKET clientSocket, const std::string& data);
     void handleMerchantProductListRequest(SOCKET clientSocket, const std::string& data);
     void handleMerchantSetDiscountRequest(SOCKET clientSocket, const std::string& data);
+    void handleMerchantImportProductsRequest(SOCKET clientSocket, const std::string& data);
+    void handleMerchantBatchModifyRequest(SOCKET clientSocket, const std::string& data);
+    void handleMerchantScheduleDiscountRequest(SOCKET clientSocket, const std::string& data);
+    void handleMerchantDelistProductsRequest(SOCKET clientSocket, const std::string& data);
+    void handleMerchantReplaceProductRequest(SOCKET clientSocket, const std::string& data);
+    static int64_t parseScheduleTime(const std::string& value, int64_t nowMillis);
+    // 解析请求中的金额（"元.分"，最多两位小数），格式错误时抛出 std::invalid_argument
+    static Money parsePrice(const std::string& value);
 
     // 购物车管理
     void handleCartAddItemRequest(SOCKET clientSocket, const std::string& data);
@@ -64,6 +83,8 @@ private:
 
     // 发送消息给客户端
     bool sendMessage(SOCKET clientSocket, const NetworkMessage& message);
+    // 发送已经编码好的消息
+    bool sendBuffer(SOCKET clientSocket, const std::vector<char>& buffer);
 
     // 广播消息给所有客户端
     void broadcastMessage(const NetworkMessage& message);
@@ -72,7 +93,7 @@ private:
     void handleOrderListRequest(SOCKET clientSocket, const std::string& data);
 
 public:
-    Server(int port = 8080);
+    Server(int port = 8080, ProductStorageMode storageMode = ProductStorageMode::SNAPSHOT_LOG);
     ~Server();
 
     // 启动服务器
@@ -2,39 +2,311 @@
 #include <iostream>
 #include <string>
 #include <thread>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
 
-int main() {
-    std::cout << "=== ̽ƽ̨ ===" << std::endl;
-    std::cout << "ڳʼ..." << std::endl;
+// 基准测试使用的独立商品文件，开始前和结束后删除，不影响正式数据
+static const char* BENCHMARK_CATALOG = "benchmark_products.txt";
 
-    Server server(8080);
+static void removeBenchmarkCatalog() {
+    const std::string base = BENCHMARK_CATALOG;
+    const char* suffixes[] = { "", ".tmp", ".log", ".log.tmp", ".categories", ".categories.tmp", ".dat", ".str" };
+    for (const char* suffix : suffixes) {
+        std::remove((base + suffix).c_str());
+    }
+}
+
+// 批量导入 count 个测试商品（分属3个类别、4个商家），返回第一个商品的ID
+static int fillBenchmarkCatalog(ProductManager& productManager, size_t count) {
+    const char* merchants[] = { "bench_a", "bench_b", "bench_c", "bench_d" };
+    const size_t batchSize = 100000;
+    int firstProductId = -1;
+    for (size_t done = 0; done < count; done += batchSize) {
+        size_t batchEnd = std::min(count, done + batchSize);
+        std::vector<ProductImportRow> rows;
+        rows.reserve(batchEnd - done);
+        for (size_t i = done; i < batchEnd; ++i) {
+            rows.push_back({ static_cast<ProductCategory>(i % CATEGORY_COUNT), "商品" + std::to_string(i),
+                Money::fromCents(100 + static_cast<int64_t>(i * 7919 % 100000)), 1000, 1.0 });
+        }
+        int batchFirstId = 0;
+        productManager.importProducts(merchants[(done / batchSize) % 4], rows, batchFirstId);
+        if (firstProductId < 0) {
+            firstProductId = batchFirstId;
+        }
+    }
+    return firstProductId;
+}
+
+static long long elapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 单次修改的耗时：在不同规模的目录上做同样次数的库存修改，只追加日志时耗时应与目录规模无关
+static void benchmarkMutations(ProductStorageMode storageMode) {
+    const size_t catalogSizes[] = { 10000, 100000, 1000000 };
+    const int mutations = 100000;
+    for (size_t catalogSize : catalogSizes) {
+        removeBenchmarkCatalog();
+        {
+            ProductManager productManager(BENCHMARK_CATALOG, storageMode);
+            int firstProductId = fillBenchmarkCatalog(productManager, catalogSize);
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < mutations; ++i) {
+                int productId = firstProductId + static_cast<int>((static_cast<size_t>(i) * 7919) % catalogSize);
+                productManager.adjustStock(productId, (i % 2 == 0) ? -1 : 1);
+            }
+            long long elapsed = elapsedMicroseconds(start);
+            std::cout << "[基准] 目录 " << catalogSize << " 个商品: " << mutations << " 次库存修改耗时 "
+                << elapsed / 1000 << " ms，平均每次 " << static_cast<double>(elapsed) / mutations << " us" << std::endl;
+        }
+        removeBenchmarkCatalog();
+    }
+}
+
+// 价格区间与有货筛选：在 1M、10M 行合成列数据上比较 ProductFilter 的向量化实现与逐行计算现价
+static void benchmarkFilter() {
+    const size_t rowCounts[] = { 1000000, 10000000 };
+    const int repeats = 10;
+    std::cout << "[基准] 筛选实现: " << ProductFilter::getKernelName() << std::endl;
+    for (size_t rowCount : rowCounts) {
+        ProductColumns columns;
+        columns.reserve(rowCount);
+        for (size_t i = 0; i < rowCount; ++i) {
+            uint8_t typeTag = static_cast<uint8_t>(i % CATEGORY_COUNT);
+            columns.ids.push_back(static_cast<int>(i + 1));
+            columns.prices.push_back(static_cast<double>(100 + (i * 7919) % 100000));
+            columns.discounts.push_back((i % 5 == 0) ? 0.8 : 1.0);
+            columns.priceFactors.push_back(CATEGORY_POLICIES[typeTag].priceFactor);
+            columns.stocks.push_back(static_cast<int>(i % 7));
+            columns.frozenStocks.push_back(static_cast<int>(i % 3));
+            columns.typeTags.push_back(typeTag);
+            columns.merchantIds.push_back(0);
+        }
+
+        // 约 10% 的行落在价格区间内
+        ProductFilterQuery query(Money::fromCents(20000), Money::fromCents(30000), true);
+        size_t matched = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            matched = columns.filter(query).size();
+        }
+        long long vectorized = elapsedMicroseconds(start) / repeats;
+
+        size_t scalarMatched = 0;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            std::vector<size_t> rows;
+            for (size_t row = 0; row < rowCount; ++row) {
+                Money price = columns.effectivePrice(row);
+                if (price.getCents() >= 20000 && price.getCents() <= 30000
+                    && columns.stocks[row] - columns.frozenStocks[row] > 0) {
+                    rows.push_back(row);
+                }
+            }
+            scalarMatched = rows.size();
+        }
+        long long scalar = elapsedMicroseconds(start) / repeats;
+
+        std::cout << "[基准] " << rowCount << " 行: 匹配 " << matched << " 行，向量化 " << vectorized / 1000.0
+            << " ms，逐行计算 " << scalar / 1000.0 << " ms" << (matched == scalarMatched ? "" : "（结果不一致!）")
+            << std::endl;
+    }
+}
+
+// 超卖压力测试：多个线程同时抢购少量热门商品（单件扣减与多商品整单扣减混合），
+// 总需求远大于库存，结束后核对每个商品的售出数量与剩余库存
+static bool benchmarkOversell(ProductStorageMode storageMode) {
+    const int hotProducts = 16;
+    const int initialStock = 20000;
+    const int attemptsPerThread = 100000;
+    const int threadCount = std::max(8, static_cast<int>(std::thread::hardware_concurrency()) * 2);
+
+    removeBenchmarkCatalog();
+    bool passed = true;
+    {
+        ProductManager productManager(BENCHMARK_CATALOG, storageMode);
+        std::vector<ProductImportRow> rows;
+        for (int i = 0; i < hotProducts; ++i) {
+            rows.push_back({ ProductCategory::FOOD, "抢购商品" + std::to_string(i), Money::fromCents(100), initialStock, 1.0 });
+        }
+        int firstProductId = 0;
+        productManager.importProducts("bench_a", rows, firstProductId);
+
+        // sold[t][p]: 线程 t 成功买到商品 p 的件数
+        std::vector<std::vector<long long>> sold(threadCount, std::vector<long long>(hotProducts, 0));
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> buyers;
+        for (int t = 0; t < threadCount; ++t) {
+            buyers.emplace_back([&, t]() {
+                unsigned int seed = static_cast<unsigned int>(t) * 2654435761u + 1;
+                for (int i = 0; i < attemptsPerThread; ++i) {
+                    seed = seed * 1103515245u + 12345u;
+                    int first = static_cast<int>((seed >> 16) % hotProducts);
+                    if (i % 4 == 0) {
+                        // 整单购买两个不同的商品，各 1-3 件
+                        int second = (first + 1 + static_cast<int>((seed >> 8) % (hotProducts - 1))) % hotProducts;
+                        int firstQuantity = 1 + static_cast<int>(seed % 3);
+                        int secondQuantity = 1 + static_cast<int>((seed >> 4) % 3);
+                        std::vector<std::pair<int, int>> items = {
+                            { firstProductId + first, firstQuantity }, { firstProductId + second, secondQuantity } };
+                        int failedProductId = 0;
+                        if (productManager.reserveStock(items, failedProductId)) {
+                            sold[t][first] += firstQuantity;
+                            sold[t][second] += secondQuantity;
+                        }
+                    }
+                    else if (productManager.adjustStock(firstProductId + first, -1)) {
+                        sold[t][first] += 1;
+                    }
+                }
+            });
+        }
+        for (auto& buyer : buyers) {
+            buyer.join();
+        }
+        long long elapsed = elapsedMicroseconds(start);
+
+        long long totalSold = 0;
+        for (int p = 0; p < hotProducts; ++p) {
+            long long soldCount = 0;
+            for (int t = 0; t < threadCount; ++t) {
+                soldCount += sold[t][p];
+            }
+            totalSold += soldCount;
+            int remaining = productManager.getProductById(firstProductId + p)->getStock();
+            if (remaining < 0 || soldCount != initialStock - remaining) {
+                std::cout << "[基准] 商品 " << (firstProductId + p) << " 超卖: 售出 " << soldCount
+                    << "，剩余库存 " << remaining << std::endl;
+                passed = false;
+            }
+        }
+        std::cout << "[基准] " << threadCount << " 个线程共 " << static_cast<long long>(threadCount) * attemptsPerThread
+            << " 次抢购，售出 " << totalSold << " 件（总库存 " << static_cast<long long>(hotProducts) * initialStock
+            << "），耗时 " << elapsed / 1000 << " ms，超卖检查" << (passed ? "通过" : "失败") << std::endl;
+    }
+    removeBenchmarkCatalog();
+    return passed;
+}
+
+static const char* BENCHMARK_USERS = "benchmark_users.dat";
+
+static void removeBenchmarkUsers() {
+    const std::string base = BENCHMARK_USERS;
+    const char* suffixes[] = { "", ".tmp", ".log" };
+    for (const char* suffix : suffixes) {
+        std::remove((base + suffix).c_str());
+    }
+}
+
+// 登录耗时与用户数的关系：按用户名哈希定位，平均耗时应与用户数无关。
+// 注册和登录都会逐条打印日志，测量期间关闭标准输出，避免控制台输出掩盖查找耗时
+static void benchmarkLogin() {
+    const size_t userCounts[] = { 1000, 10000, 100000, 1000000 };
+    const int logins = 100000;
+    for (size_t userCount : userCounts) {
+        removeBenchmarkUsers();
+        {
+            UserManager userManager(BENCHMARK_USERS);
+            std::cout.setstate(std::ios::badbit);
+            for (size_t i = 0; i < userCount; ++i) {
+                userManager.registerUser("user" + std::to_string(i), "password", UserType::CONSUMER);
+            }
+
+            size_t succeeded = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < logins; ++i) {
+                size_t index = (static_cast<size_t>(i) * 7919) % userCount;
+                if (userManager.authenticateUser("user" + std::to_string(index), "password")) {
+                    succeeded++;
+                }
+            }
+            long long elapsed = elapsedMicroseconds(start);
+            std::cout.clear();
+            std::cout << "[基准] " << userCount << " 个用户: " << logins << " 次登录（成功 " << succeeded << "）平均每次 "
+                << static_cast<double>(elapsed) / logins << " us" << std::endl;
+        }
+        removeBenchmarkUsers();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== 电商交易平台服务器 ===" << std::endl;
+    std::cout << "正在初始化服务器..." << std::endl;
+
+    // --mapped-store: 使用内存映射的定长商品记录存储
+    // --benchmark-startup: 只加载商品目录并输出耗时，不启动网络服务
+    // --benchmark-mutations: 在临时目录上测量单次库存修改的耗时
+    // --benchmark-filter: 在 1M/10M 行列数据上测量价格区间与有货筛选
+    // --benchmark-oversell: 多线程抢购压力测试，检查库存没有超卖（失败时返回非0）
+    // --benchmark-login: 不同用户数下的登录耗时
+    ProductStorageMode storageMode = ProductStorageMode::SNAPSHOT_LOG;
+    std::string benchmark;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--mapped-store") {
+            storageMode = ProductStorageMode::MAPPED_RECORDS;
+            std::cout << "商品存储: 内存映射定长记录" << std::endl;
+        }
+        else if (arg.compare(0, 12, "--benchmark-") == 0) {
+            benchmark = arg.substr(12);
+        }
+    }
+
+    if (benchmark == "mutations") {
+        benchmarkMutations(storageMode);
+        return 0;
+    }
+    if (benchmark == "filter") {
+        benchmarkFilter();
+        return 0;
+    }
+    if (benchmark == "oversell") {
+        return benchmarkOversell(storageMode) ? 0 : 1;
+    }
+    if (benchmark == "login") {
+        benchmarkLogin();
+        return 0;
+    }
+    if (benchmark == "startup") {
+        auto start = std::chrono::steady_clock::now();
+        ProductManager productManager("products.txt", storageMode);
+        auto loaded = std::chrono::steady_clock::now();
+        std::cout << "商品目录加载完成: " << productManager.getProductCount() << " 个商品，耗时 "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(loaded - start).count() << " ms" << std::endl;
+        return 0;
+    }
+
+    Server server(8080, storageMode);
 
     if (!server.start()) {
-        std::cerr << "ʧ!" << std::endl;
-        std::cout << "˿8080Ƿռ" << std::endl;
+        std::cerr << "服务器启动失败!" << std::endl;
+        std::cout << "请检查端口8080是否被占用" << std::endl;
         return -1;
     }
 
-    std::cout << "ɹ! Enterֹͣ" << std::endl;
-    std::cout << "˿: 8080" << std::endl;
-    std::cout << "ȴͻ..." << std::endl;
+    std::cout << "服务器启动成功! 按Enter键停止服务器" << std::endl;
+    std::cout << "服务器监听端口: 8080" << std::endl;
+    std::cout << "等待客户端连接..." << std::endl;
 
-    // һ߳з
+    // 启动一个线程运行服务器
     std::thread serverThread(&Server::run, &server);
 
     //server.run();
 
-    // ȴûֹͣ
+    // 等待用户输入来停止服务器
     std::string input;
     std::getline(std::cin, input);
 
-    std::cout << "ֹͣ..." << std::endl;
+    std::cout << "正在停止服务器..." << std::endl;
     server.stop();
 
     if (serverThread.joinable()) {
         serverThread.join();
     }
 
-    std::cout << "ֹͣ" << std::endl;
+    std::cout << "服务器已停止" << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "snapshot_file.h"
+#include "crc32c.h"
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+uint32_t headerChecksum(const SnapshotFileHeader& header) {
+    return crc32c(0, &header, offsetof(SnapshotFileHeader, headerCrc));
+}
+
+uint32_t blockChecksum(const SnapshotBlockHeader& blockHeader, const char* payload) {
+    uint32_t crc = crc32c(0, &blockHeader, offsetof(SnapshotBlockHeader, crc));
+    return crc32c(crc, payload, blockHeader.payloadSize);
+}
+
+// 用临时文件替换目标文件，Windows 下 rename 不能覆盖已存在的文件
+bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+}
+
+bool syncFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool synced = FlushFileBuffers(handle) != 0;
+    CloseHandle(handle);
+    return synced;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+#endif
+}
+
+// ==================== SnapshotWriter 实现 ====================
+
+SnapshotWriter::SnapshotWriter(const std::string& filename, const char* kind, uint32_t kindVersion,
+    uint32_t recordsPerBlock)
+    : filename(filename), tempFilename(filename + ".tmp"), header(),
+    recordsPerBlock(recordsPerBlock), blockRecords(0), committed(false) {
+    std::memcpy(header.magic, "ESNP", 4);
+    header.formatVersion = FORMAT_VERSION;
+    std::memcpy(header.kind, kind, 4);
+    header.kindVersion = kindVersion;
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (!committed) {
+        if (out.is_open()) {
+            out.close();
+        }
+        std::remove(tempFilename.c_str());
+    }
+}
+
+bool SnapshotWriter::open() {
+    out.open(tempFilename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "无法打开临时文件进行写入: " << tempFilename << std::endl;
+        return false;
+    }
+    // 文件头在 commit 时回填
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return true;
+}
+
+void SnapshotWriter::putString(const std::string& value) {
+    uint32_t length = static_cast<uint32_t>(value.size());
+    put(length);
+    block.append(value);
+}
+
+void SnapshotWriter::putBytes(const std::string& bytes) {
+    block.append(bytes);
+}
+
+void SnapshotWriter::putBytes(const char* data, size_t size) {
+    block.append(data, size);
+}
+
+void SnapshotWriter::endRecord() {
+    blockRecords++;
+    header.recordCount++;
+    if (blockRecords >= recordsPerBlock || block.size() >= BLOCK_BYTES) {
+        flushBlock();
+    }
+}
+
+void SnapshotWriter::flushBlock() {
+    if (blockRecords == 0) {
+        return;
+    }
+    SnapshotBlockHeader blockHeader = {};
+    blockHeader.payloadSize = static_cast<uint32_t>(block.size());
+    blockHeader.recordCount = blockRecords;
+    blockHeader.crc = blockChecksum(blockHeader, block.data());
+    out.write(reinterpret_cast<const char*>(&blockHeader), sizeof(blockHeader));
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+
+    header.blockCount++;
+    block.clear();
+    blockRecords = 0;
+}
+
+bool SnapshotWriter::commit() {
+    if (!out.is_open()) {
+        return false;
+    }
+    flushBlock();
+    header.headerCrc = headerChecksum(header);
+    out.seekp(0, std::ios::beg);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    if (out.fail()) {
+        std::cerr << "写入快照文件失败: " << tempFilename << std::endl;
+        return false;
+    }
+    out.close();
+
+    // 临时文件落盘之后再替换，保证替换进来的快照是完整的
+    if (!syncFile(tempFilename)) {
+        std::cerr << "无法将快照文件写入磁盘: " << tempFilename << std::endl;
+        return false;
+    }
+    if (!replaceFile(tempFilename, filename)) {
+        std::cerr << "无法替换快照文件: " << filename << std::endl;
+        return false;
+    }
+    committed = true;
+    return true;
+}
+
+// ==================== SnapshotReader 实现 ====================
+
+SnapshotReader::Status SnapshotReader::open(const std::string& filename, const char* kind) {
+    close();
+
+    if (!file.openReadOnly(filename)) {
+        std::ifstream probe(filename, std::ios::binary);
+        if (!probe.is_open()) {
+            return Status::MISSING;
+        }
+        errors.push_back("无法映射快照文件: " + filename);
+        return Status::DAMAGED;
+    }
+    const char* data = file.getData();
+    size_t size = file.getSize();
+    if (size == 0) {
+        return Status::MISSING;
+    }
+    if (size < sizeof(header) || std::memcmp(data, "ESNP", 4) != 0) {
+        return Status::LEGACY;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+    if (header.headerCrc != headerChecksum(header)) {
+        errors.push_back("快照文件头校验失败");
+        header = SnapshotFileHeader();
+        return Status::DAMAGED;
+    }
+    if (std::memcmp(header.kind, kind, 4) != 0) {
+        errors.push_back("快照内容类型不符: " + std::string(header.kind, 4) + "，应为 " + std::string(kind, 4));
+        return Status::DAMAGED;
+    }
+    if (header.formatVersion != SnapshotWriter::FORMAT_VERSION) {
+        errors.push_back("不支持的快照格式版本: " + std::to_string(header.formatVersion));
+        return Status::DAMAGED;
+    }
+
+    // 一遍扫描所有块：校验通过的块直接引用映射内存
+    bool damaged = false;
+    size_t offset = sizeof(header);
+    uint64_t recordIndex = 0;
+    uint32_t blockIndex = 0;
+    while (offset < size) {
+        if (size - offset < sizeof(SnapshotBlockHeader)) {
+            errors.push_back("第 " + std::to_string(blockIndex + 1) + " 块的块头不完整，文件被截断");
+            damaged = true;
+            break;
+        }
+        SnapshotBlockHeader blockHeader;
+        std::memcpy(&blockHeader, data + offset, sizeof(blockHeader));
+        const char* payload = data + offset + sizeof(blockHeader);
+        if (blockHeader.payloadSize > size - offset - sizeof(blockHeader)) {
+            errors.push_back("第 " + std::to_string(blockIndex + 1) + " 块长度超出文件末尾，文件被截断");
+            damaged = true;
+            break;
+        }
+        if (blockHeader.crc != blockChecksum(blockHeader, payload)) {
+            errors.push_back("第 " + std::to_string(blockIndex + 1) + " 块（偏移 " + std::to_string(offset) +
+                "）校验失败，已跳过");
+            damaged = true;
+        }
+        else {
+            blocks.push_back({ payload, blockHeader.payloadSize, blockHeader.recordCount, recordIndex });
+        }
+        recordIndex += blockHeader.recordCount;
+        offset += sizeof(blockHeader) + blockHeader.payloadSize;
+        blockIndex++;
+    }
+
+    if (!damaged && (blockIndex != header.blockCount || recordIndex != header.recordCount)) {
+        errors.push_back("快照共有 " + std::to_string(blockIndex) + " 块 " + std::to_string(recordIndex) +
+            " 条记录，与文件头记载的 " + std::to_string(header.blockCount) + " 块 " +
+            std::to_string(header.recordCount) + " 条不符");
+        damaged = true;
+    }
+    return damaged ? Status::DAMAGED : Status::VALID;
+}
+
+void SnapshotReader::close() {
+    file.close();
+    header = SnapshotFileHeader();
+    blocks.clear();
+    errors.clear();
+}
+
+std::string SnapshotReader::preserveDamaged(const std::string& filename) {
+    std::string backupName = filename + ".damaged-" + std::to_string(
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    if (std::rename(filename.c_str(), backupName.c_str()) != 0) {
+        return "";
+    }
+    return backupName;
+}
+
+// ==================== SnapshotRecordReader 实现 ====================
+
+void SnapshotRecordReader::readString(std::string& value, uint32_t maxLength, const char* field) {
+    uint32_t length = read<uint32_t>(field);
+    if (length > maxLength) {
+        throw std::runtime_error(std::string(field) + "长度异常: " + std::to_string(length));
+    }
+    if (static_cast<size_t>(end - data) < length) {
+        throw std::runtime_error(std::string("读取") + field + "失败，记录不完整");
+    }
+    value.assign(data, length);
+    data += length;
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#ifndef SNAPSHOT_FILE_H
+#define SNAPSHOT_FILE_H
+
+#include "product_record_store.h"   // MappedFile
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// 快照容器文件头（40字节）
+struct SnapshotFileHeader {
+    char magic[4];              // "ESNP"
+    uint32_t formatVersion;     // 容器格式版本
+    char kind[4];               // 内容类型: "PROD" / "USER" / "CART"
+    uint32_t kindVersion;       // 记录格式版本，由内容类型自行解释
+    uint64_t recordCount;
+    uint64_t extra;             // 附加字段，由内容类型自行解释（商品快照中为下一个商品ID）
+    uint32_t blockCount;
+    uint32_t headerCrc;         // 以上字段的 CRC32C
+};
+
+// 块头（16字节），crc 覆盖 payloadSize、recordCount 两个字段和整个负载
+struct SnapshotBlockHeader {
+    uint32_t payloadSize;
+    uint32_t recordCount;
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+// 校验通过的一个块，data 指向映射内存，SnapshotReader 关闭前有效
+struct SnapshotBlock {
+    const char* data;
+    size_t size;
+    uint32_t recordCount;
+    uint64_t firstRecord;       // 块内第一条记录在整个快照中的序号（从0开始）
+};
+
+// 把文件内容刷到磁盘。流的 flush 只交给操作系统缓存，断电后可能丢失或只剩一部分。
+// 快照在改名前调用，用户日志在写入余额记录后调用
+bool syncFile(const std::string& path);
+
+/**
+ * @brief 快照容器的写入
+ * 记录先攒在内存中，满 recordsPerBlock 条或 BLOCK_BYTES 字节时带校验和写出一块。
+ * 全部内容写入临时文件，commit 时回填文件头再整体替换原文件，写到一半崩溃不会破坏旧快照。
+ */
+class SnapshotWriter {
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+    static const size_t BLOCK_BYTES = 1 << 20;
+
+    SnapshotWriter(const std::string& filename, const char* kind, uint32_t kindVersion, uint32_t recordsPerBlock);
+    ~SnapshotWriter();      // 没有 commit 时删除临时文件
+
+    bool open();
+
+    template <typename T>
+    void put(const T& value) {
+        block.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void putString(const std::string& value);   // uint32 长度 + 内容
+    void putBytes(const std::string& bytes);
+    void putBytes(const char* data, size_t size);
+    void endRecord();
+
+    void setExtra(uint64_t value) { header.extra = value; }
+
+    // 写出最后一块、回填文件头并替换原文件
+    bool commit();
+
+private:
+    std::string filename;
+    std::string tempFilename;
+    std::ofstream out;
+    SnapshotFileHeader header;
+    uint32_t recordsPerBlock;
+    std::string block;
+    uint32_t blockRecords;
+    bool committed;
+
+    void flushBlock();
+};
+
+/**
+ * @brief 快照容器的读取与校验
+ * 只读映射整个文件，一遍扫描校验文件头和每个块的 CRC32C，之后直接从映射内存解析记录。
+ * 校验失败的块跳过并记录原因；块头越界（写到一半被截断）时停止扫描。
+ */
+class SnapshotReader {
+public:
+    enum class Status {
+        MISSING,    // 文件不存在或为空
+        LEGACY,     // 不是容器格式，由调用方按旧格式读取
+        VALID,      // 全部校验通过
+        DAMAGED     // 有损坏，getBlocks 中只有校验通过的块
+    };
+
+    Status open(const std::string& filename, const char* kind);
+    void close();
+
+    uint32_t getKindVersion() const { return header.kindVersion; }
+    uint64_t getRecordCount() const { return header.recordCount; }
+    uint64_t getExtra() const { return header.extra; }
+    const std::vector<SnapshotBlock>& getBlocks() const { return blocks; }
+    const std::vector<std::string>& getErrors() const { return errors; }
+
+    // 把损坏的文件改名保留（追加 .damaged-时间戳），之后写入的新快照不会覆盖它；返回新文件名，失败返回空串
+    static std::string preserveDamaged(const std::string& filename);
+
+private:
+    MappedFile file;
+    SnapshotFileHeader header = {};
+    std::vector<SnapshotBlock> blocks;
+    std::vector<std::string> errors;
+};
+
+// 从块中按顺序读取字段，越界时抛出 std::runtime_error
+class SnapshotRecordReader {
+public:
+    SnapshotRecordReader(const SnapshotBlock& block) : data(block.data), end(block.data + block.size) {}
+
+    template <typename T>
+    T read(const char* field);
+    void readString(std::string& value, uint32_t maxLength, const char* field);
+    bool atEnd() const { return data == end; }
+
+private:
+    const char* data;
+    const char* end;
+};
+
+template <typename T>
+T SnapshotRecordReader::read(const char* field) {
+    if (static_cast<size_t>(end - data) < sizeof(T)) {
+        throw std::runtime_error(std::string("读取") + field + "失败，记录不完整");
+    }
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+#endif
\ No newline at end of file
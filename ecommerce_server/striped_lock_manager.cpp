@@ -0,0 +1,27 @@
+#include "striped_lock_manager.h"
+#include <algorithm>
+
+size_t StripedLockManager::stripeOf(int productId) const {
+    return static_cast<size_t>(static_cast<unsigned int>(productId)) % STRIPE_COUNT;
+}
+
+std::unique_lock<std::mutex> StripedLockManager::lockProduct(int productId) {
+    return std::unique_lock<std::mutex>(stripes[stripeOf(productId)]);
+}
+
+std::vector<std::unique_lock<std::mutex>> StripedLockManager::lockProducts(const std::vector<int>& productIds) {
+    std::vector<size_t> indexes;
+    indexes.reserve(productIds.size());
+    for (int productId : productIds) {
+        indexes.push_back(stripeOf(productId));
+    }
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+
+    std::vector<std::unique_lock<std::mutex>> guards;
+    guards.reserve(indexes.size());
+    for (size_t index : indexes) {
+        guards.emplace_back(stripes[index]);
+    }
+    return guards;
+}
\ No newline at end of file
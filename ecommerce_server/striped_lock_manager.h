@@ -0,0 +1,28 @@
+#ifndef STRIPED_LOCK_MANAGER_H
+#define STRIPED_LOCK_MANAGER_H
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+/**
+ * @brief 按商品ID分段的锁
+ * 商品ID映射到固定数量的分段锁上，涉及不同分段的操作可以并行。
+ * 一次锁多个商品时按分段编号升序加锁，所有调用方顺序一致，不会互相等待形成死锁。
+ */
+class StripedLockManager {
+public:
+    static const size_t STRIPE_COUNT = 64;
+
+    size_t stripeOf(int productId) const;
+
+    std::unique_lock<std::mutex> lockProduct(int productId);
+
+    // 锁住一组商品所在的全部分段（重复的分段只锁一次），返回值析构时释放
+    std::vector<std::unique_lock<std::mutex>> lockProducts(const std::vector<int>& productIds);
+
+private:
+    std::mutex stripes[STRIPE_COUNT];
+};
+
+#endif
\ No newline at end of file
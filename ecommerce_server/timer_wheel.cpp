@@ -0,0 +1,70 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel(uint64_t currentTick) : currentTick(currentTick), timerCount(0) {
+}
+
+void TimerWheel::schedule(uint64_t timerId, uint64_t expireTick) {
+    Timer timer = { timerId, expireTick };
+    if (expireTick <= currentTick) {
+        // 当前 tick 的槽位已经处理过，放进去要再等一圈
+        due.push_back(timer);
+    }
+    else {
+        place(timer);
+    }
+    timerCount++;
+}
+
+void TimerWheel::place(const Timer& timer) {
+    // 按距离到期的 tick 数选层：第 l 层容纳距离小于 SLOTS^(l+1) 的定时器。
+    // 超出顶层范围的先放在顶层最远的槽位，转到时按实际到期时间重新分配
+    uint64_t delta = timer.expireTick > currentTick ? timer.expireTick - currentTick : 0;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (SLOTS << (SLOT_BITS * level))) {
+        level++;
+    }
+    uint64_t expireTick = timer.expireTick;
+    uint64_t span = 1ULL << (SLOT_BITS * LEVELS);
+    if (delta >= span) {
+        expireTick = currentTick + span - 1;
+    }
+    size_t slot = static_cast<size_t>((expireTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    slots[level][slot].push_back(timer);
+}
+
+void TimerWheel::cascade(int level) {
+    size_t slot = static_cast<size_t>((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    std::vector<Timer> timers;
+    timers.swap(slots[level][slot]);
+    for (const Timer& timer : timers) {
+        place(timer);
+    }
+}
+
+void TimerWheel::advance(uint64_t tick, std::vector<uint64_t>& expired) {
+    for (const Timer& timer : due) {
+        expired.push_back(timer.timerId);
+    }
+    timerCount -= due.size();
+    due.clear();
+
+    while (currentTick < tick) {
+        currentTick++;
+
+        // 低层转完一圈（低位全为0）时从高到低逐层下放，保证先分配的定时器还能落到本 tick 的槽位
+        int top = 0;
+        while (top < LEVELS - 1 && (currentTick & ((SLOTS << (SLOT_BITS * top)) - 1)) == 0) {
+            top++;
+        }
+        for (int level = top; level >= 1; --level) {
+            cascade(level);
+        }
+
+        std::vector<Timer>& slot = slots[0][currentTick & (SLOTS - 1)];
+        for (const Timer& timer : slot) {
+            expired.push_back(timer.timerId);
+        }
+        timerCount -= slot.size();
+        slot.clear();
+    }
+}
\ No newline at end of file
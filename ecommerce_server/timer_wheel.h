@@ -0,0 +1,47 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 分层时间轮
+ * 时间以 tick 为单位（绝对值，由调用方决定一个 tick 的长度）。共 LEVELS 层，每层 SLOTS 个槽位：
+ * 第 l 层的一个槽位覆盖 SLOTS^l 个 tick，低一层转完一圈时把上一层当前槽位的定时器重新分配到下层。
+ * 添加和到期都是 O(1)，每个定时器最多被搬移 LEVELS-1 次，与定时器总数无关。
+ * 不支持取消：调用方按定时器ID自行忽略已经作废的到期事件。
+ */
+class TimerWheel {
+public:
+    static const int SLOT_BITS = 6;
+    static const uint64_t SLOTS = 1ULL << SLOT_BITS;
+    static const int LEVELS = 5;        // 共覆盖 64^5 个 tick，更远的定时器到顶层后会继续重新分配
+
+    explicit TimerWheel(uint64_t currentTick);
+
+    // 添加定时器；expireTick 不晚于当前 tick 时在下一次 advance 立即到期
+    void schedule(uint64_t timerId, uint64_t expireTick);
+
+    // 推进到 tick（含），把到期的定时器ID按到期先后追加到 expired
+    void advance(uint64_t tick, std::vector<uint64_t>& expired);
+
+    uint64_t getCurrentTick() const { return currentTick; }
+    size_t size() const { return timerCount; }
+
+private:
+    struct Timer {
+        uint64_t timerId;
+        uint64_t expireTick;
+    };
+
+    std::vector<Timer> slots[LEVELS][SLOTS];
+    std::vector<Timer> due;             // 添加时已经到期的定时器
+    uint64_t currentTick;
+    size_t timerCount;
+
+    void place(const Timer& timer);
+    void cascade(int level);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "user_log.h"
+#include "snapshot_file.h"
+#include <iostream>
+#include <filesystem>
+
+namespace {
+    void appendString(std::string& record, const std::string& value) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        record.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        record.append(value);
+    }
+}
+
+UserLog::UserLog(const std::string& filename)
+    : filename(filename), recordCount(0), size(0) {
+}
+
+UserLog::~UserLog() {
+    close();
+}
+
+bool UserLog::open() {
+    out.open(filename, std::ios::binary | std::ios::app);
+    if (!out.is_open()) {
+        std::cerr << "无法打开用户日志文件: " << filename << std::endl;
+        return false;
+    }
+    std::error_code ec;
+    size = std::filesystem::file_size(filename, ec);
+    if (ec) {
+        size = 0;
+    }
+    return true;
+}
+
+void UserLog::close() {
+    if (out.is_open()) {
+        out.close();
+    }
+}
+
+bool UserLog::write(const std::string& record, bool durable) {
+    if (!out.is_open()) {
+        std::cerr << "用户日志未打开: " << filename << std::endl;
+        return false;
+    }
+    out.write(record.data(), static_cast<std::streamsize>(record.size()));
+    out.flush();
+    if (out.fail() || (durable && !syncFile(filename))) {
+        std::cerr << "写入用户日志失败: " << filename << std::endl;
+        // 截掉可能写了一半的记录，之后追加的记录不会落在无法解析的内容后面
+        out.clear();
+        close();
+        truncateTo(size);
+        open();
+        return false;
+    }
+    size += record.size();
+    recordCount++;
+    return true;
+}
+
+bool UserLog::appendRegister(const User& user) {
+    std::string record(1, static_cast<char>(UserLogOp::REGISTER));
+    user.appendRecord(record);
+    return write(record, false);
+}
+
+bool UserLog::appendBalance(const std::string& username, Money balance) {
+    std::string record(1, static_cast<char>(UserLogOp::BALANCE));
+    appendString(record, username);
+    int64_t cents = balance.getCents();
+    record.append(reinterpret_cast<const char*>(&cents), sizeof(cents));
+    return write(record, true);
+}
+
+bool UserLog::appendPassword(const std::string& username, const std::string& password) {
+    std::string record(1, static_cast<char>(UserLogOp::PASSWORD));
+    appendString(record, username);
+    appendString(record, password);
+    return write(record, false);
+}
+
+void UserLog::reset() {
+    close();
+    // 以截断模式重新打开即清空日志
+    out.open(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "无法截断用户日志文件: " << filename << std::endl;
+        return;
+    }
+    recordCount = 0;
+    size = 0;
+}
+
+uint64_t UserLog::getSize() {
+    if (out.is_open()) {
+        out.flush();
+    }
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(filename, ec);
+    return ec ? 0 : size;
+}
+
+void UserLog::discardPrefix(uint64_t offset, size_t records) {
+    uint64_t size = getSize();
+    if (size <= offset) {
+        reset();
+        return;
+    }
+
+    // 快照写入期间追加的记录搬到新文件，再整体替换日志，中途崩溃时旧日志仍然完整
+    std::string tail;
+    {
+        std::ifstream in(filename, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(offset));
+        tail.resize(static_cast<size_t>(size - offset));
+        in.read(&tail[0], static_cast<std::streamsize>(tail.size()));
+        if (!in) {
+            std::cerr << "读取用户日志失败，保留完整日志: " << filename << std::endl;
+            return;
+        }
+    }
+
+    std::string tempFilename = filename + ".tmp";
+    {
+        std::ofstream temp(tempFilename, std::ios::binary | std::ios::trunc);
+        temp.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+        temp.flush();
+        if (!temp) {
+            std::cerr << "写入用户日志失败，保留完整日志: " << tempFilename << std::endl;
+            return;
+        }
+    }
+
+    close();
+    std::error_code ec;
+    std::filesystem::rename(tempFilename, filename, ec);
+    if (ec) {
+        std::cerr << "替换用户日志失败，保留完整日志: " << ec.message() << std::endl;
+        std::filesystem::remove(tempFilename, ec);
+    }
+    else {
+        recordCount = recordCount > records ? recordCount - records : 0;
+    }
+    open();
+}
+
+bool UserLog::truncateTo(uint64_t size) {
+    std::error_code ec;
+    std::filesystem::resize_file(filename, size, ec);
+    if (ec) {
+        std::cerr << "无法截断用户日志文件: " << filename << " (" << ec.message() << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef USER_LOG_H
+#define USER_LOG_H
+
+#include "user.h"
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+// 用户变更日志记录类型
+enum class UserLogOp : uint8_t {
+    REGISTER = 1,       // 新用户（负载为一条完整的快照记录）
+    BALANCE = 2,        // 修改余额（负载为 用户名 + int64 分，记录的是修改后的值）
+    PASSWORD = 3        // 修改密码（负载为 用户名 + 新密码）
+};
+
+/**
+ * @brief 用户变更日志（只追加）
+ * 每条记录格式: op(1字节) | 负载，字符串为 uint32 长度 + 内容。
+ * 一条记录先在内存中拼好再一次写出并刷到操作系统；余额记录还会刷到磁盘后才返回，
+ * 结算已应答的扣款在断电后也不会丢失（注册和改密码记录只保证进程崩溃时不丢）。
+ * 写入失败时把文件截回写入前的长度，不在日志中间留下残缺记录。
+ * 所有记录都是修改后的绝对值，快照写完但日志尚未截断时崩溃，重复回放结果不变。
+ */
+class UserLog {
+private:
+    std::string filename;
+    std::ofstream out;
+    size_t recordCount;     // 自上次截断以来追加的记录数
+    uint64_t size;          // 已写入的字节数，写入失败时截回这个长度
+
+    // durable 为 true 时写出后刷到磁盘；失败时返回false，日志保持写入前的内容
+    bool write(const std::string& record, bool durable);
+
+public:
+    UserLog(const std::string& filename);
+    ~UserLog();
+
+    // 以追加模式打开日志文件
+    bool open();
+    void close();
+
+    // 记录写入失败时返回false，调用方不应修改内存中的用户
+    bool appendRegister(const User& user);
+    bool appendBalance(const std::string& username, Money balance);
+    bool appendPassword(const std::string& username, const std::string& password);
+
+    // 快照落盘后清空日志
+    void reset();
+
+    // 把日志文件截到 size 字节，丢掉崩溃留下的残缺尾部（须在 open 之前调用）
+    bool truncateTo(uint64_t size);
+
+    // 当前已写入的字节数，快照复制用户表时记下，作为快照覆盖到的日志位置
+    uint64_t getSize();
+    // 快照写完后丢掉前 offset 字节（共 records 条记录），保留快照复制之后追加的记录
+    void discardPrefix(uint64_t offset, size_t records);
+
+    size_t getRecordCount() const { return recordCount; }
+    const std::string& getFilename() const { return filename; }
+};
+
+#endif
\ No newline at end of file
@@ -1,167 +1,446 @@
 #include "user_manager.h"
+#include "snapshot_file.h"
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
 
-UserManager::UserManager(const std::string& filename) : filename(filename) {
+const int UserManager::COMPACTION_INTERVAL_SECONDS;
+
+UserManager::UserManager(const std::string& filename)
+    : filename(filename), userLog(filename + ".log"), stopCompaction(false) {
     loadUsers();
+    replayLog();
+    userLog.open();
+    compactionThread = std::thread(&UserManager::compactionLoop, this);
 }
 
 UserManager::~UserManager() {
+    {
+        std::lock_guard<std::mutex> lock(compactionMutex);
+        stopCompaction = true;
+    }
+    compactionCv.notify_all();
+    if (compactionThread.joinable()) {
+        compactionThread.join();
+    }
+
+    // 退出前写一次完整快照并清空日志
     saveUsers();
 }
 
 bool UserManager::registerUser(const std::string& username, const std::string& password, UserType userType) {
     std::lock_guard<std::mutex> lock(usersMutex);
 
-    // ûǷѴ
-    for (const auto& user : users) {
-        if (user->getUsername() == username) {
-            std::cout << "ûѴ: " << username << std::endl;
-            return false;
-        }
+    // 检查用户名是否已存在
+    if (findUser(username)) {
+        std::cout << "用户名已存在: " << username << std::endl;
+        return false;
     }
 
-    // ʹùû
+    // 使用工厂方法创建新用户
     std::unique_ptr<User> newUser(User::createUser(username, password, userType));
     if (!newUser) {
-        std::cout << "ûʧ: " << username << std::endl;
+        std::cout << "创建用户失败: " << username << std::endl;
         return false;
     }
 
-    // Ϊóʼ
+    // 为消费者设置初始余额
     if (userType == UserType::CONSUMER) {
-        newUser->setBalance(1000.0); // 1000Ԫʼ
+        newUser->setBalance(Money::fromCents(100000)); // 给消费者1000元初始余额
     }
 
+    // 先写日志，写入失败时不加入用户表，调用方按注册失败处理
+    if (!userLog.appendRegister(*newUser)) {
+        std::cout << "注册失败，无法写入用户日志: " << username << std::endl;
+        return false;
+    }
+    userIndex.emplace(username, users.size());
     users.push_back(std::move(newUser));
-    saveUsers(); // 浽ļ
+    notifyChangeRecorded();
 
-    std::cout << "ûעɹ: " << username << " (: " <<
-        (userType == UserType::CONSUMER ? "" : "̼") << ")" << std::endl;
+    std::cout << "用户注册成功: " << username << " (类型: " <<
+        (userType == UserType::CONSUMER ? "消费者" : "商家") << ")" << std::endl;
     return true;
 }
 
 User* UserManager::authenticateUser(const std::string& username, const std::string& password) {
     std::lock_guard<std::mutex> lock(usersMutex);
 
-    for (auto& user : users) {
-        if (user->getUsername() == username && user->verifyPassword(password)) {
-            std::cout << "û¼֤ɹ: " << username << std::endl;
-            return user.get();
-        }
+    User* user = findUser(username);
+    if (user && user->verifyPassword(password)) {
+        std::cout << "用户登录验证成功: " << username << std::endl;
+        return user;
     }
 
-    std::cout << "û¼֤ʧ: " << username << std::endl;
+    std::cout << "用户登录验证失败: " << username << std::endl;
     return nullptr;
 }
 
 bool UserManager::userExists(const std::string& username) {
     std::lock_guard<std::mutex> lock(usersMutex);
 
-    for (const auto& user : users) {
-        if (user->getUsername() == username) {
-            return true;
-        }
-    }
-    return false;
+    return findUser(username) != nullptr;
 }
 
 bool UserManager::updateUser(const User& updatedUser) {
     std::lock_guard<std::mutex> lock(usersMutex);
 
-    for (auto& user : users) {
-        if (user->getUsername() == updatedUser.getUsername()) {
-            // ûϢ
-            user->setBalance(updatedUser.getBalance());
-            saveUsers();
-            return true;
-        }
+    User* user = findUser(updatedUser.getUsername());
+    if (!user) {
+        return false;
+    }
+
+    // 更新用户信息：余额记录落盘后才修改内存中的余额
+    if (!userLog.appendBalance(user->getUsername(), updatedUser.getBalance())) {
+        return false;
+    }
+    user->setBalance(updatedUser.getBalance());
+    notifyChangeRecorded();
+    return true;
+}
+
+bool UserManager::updateBalance(const std::string& username, Money newBalance) {
+    std::lock_guard<std::mutex> lock(usersMutex);
+
+    User* user = findUser(username);
+    if (!user) {
+        return false;
+    }
+    if (user->getBalance() == newBalance) {
+        return true;
+    }
+
+    // 余额记录落盘后才修改内存中的余额，写入失败时余额不变并返回false
+    if (!userLog.appendBalance(username, newBalance)) {
+        return false;
     }
-    return false;
+    user->setBalance(newBalance);
+    notifyChangeRecorded();
+    return true;
 }
 
 bool UserManager::changePassword(const std::string& username, const std::string& oldPassword, const std::string& newPassword) {
     std::lock_guard<std::mutex> lock(usersMutex);
 
-    for (auto& user : users) {
-        if (user->getUsername() == username) {
-            if (user->changePassword(oldPassword, newPassword)) {
-                saveUsers(); // 
-                std::cout << "û " << username << " ޸ĳɹ" << std::endl;
-                return true;
+    User* user = findUser(username);
+    if (!user) {
+        std::cout << "用户 " << username << " 不存在" << std::endl;
+        return false;
+    }
+
+    if (!user->verifyPassword(oldPassword)) {
+        std::cout << "用户 " << username << " 旧密码验证失败" << std::endl;
+        return false;
+    }
+    if (!userLog.appendPassword(username, newPassword)) {
+        std::cout << "用户 " << username << " 密码修改失败，无法写入用户日志" << std::endl;
+        return false;
+    }
+    user->setPassword(newPassword);
+    notifyChangeRecorded();
+    std::cout << "用户 " << username << " 密码修改成功" << std::endl;
+    return true;
+}
+
+User* UserManager::findUser(const std::string& username) {
+    auto it = userIndex.find(username);
+    return it == userIndex.end() ? nullptr : users[it->second].get();
+}
+
+void UserManager::rebuildIndex() {
+    userIndex.clear();
+    userIndex.reserve(users.size());
+    for (size_t i = 0; i < users.size(); ++i) {
+        userIndex.emplace(users[i]->getUsername(), i);
+    }
+}
+
+void UserManager::loadUsers() {
+    users.clear();
+    userIndex.clear();
+
+    bool intact = true;
+    bool migrated = false;
+    {
+        SnapshotReader snapshot;
+        SnapshotReader::Status status = snapshot.open(filename, "USER");
+        if (status == SnapshotReader::Status::MISSING) {
+            std::cout << "用户文件不存在，将创建新文件: " << filename << std::endl;
+            return;
+        }
+        if (status == SnapshotReader::Status::LEGACY) {
+            intact = loadLegacyUsers();
+        }
+        else {
+            intact = status == SnapshotReader::Status::VALID;
+            for (const auto& error : snapshot.getErrors()) {
+                std::cerr << error << std::endl;
             }
-            else {
-                std::cout << "û " << username << " ֤ʧ" << std::endl;
-                return false;
+            uint32_t version = snapshot.getKindVersion();
+            if (version == USER_RECORD_VERSION || version == LEGACY_BALANCE_VERSION) {
+                bool legacyBalance = version == LEGACY_BALANCE_VERSION;
+                migrated = legacyBalance;
+                for (const auto& block : snapshot.getBlocks()) {
+                    const char* data = block.data;
+                    const char* end = block.data + block.size;
+                    try {
+                        for (uint32_t i = 0; i < block.recordCount; ++i) {
+                            users.emplace_back(User::readRecord(data, end, legacyBalance));
+                        }
+                        if (data != end) {
+                            throw std::runtime_error("块末尾有多余数据");
+                        }
+                    }
+                    catch (const std::exception& e) {
+                        std::cerr << "解析第 " << (block.firstRecord + 1) << " 个用户起的记录块出错: " << e.what() << std::endl;
+                        intact = false;
+                    }
+                }
+            }
+            else if (intact) {
+                std::cerr << "不支持的用户记录版本: " << snapshot.getKindVersion() << std::endl;
+                intact = false;
             }
         }
     }
 
-    std::cout << "û " << username << " " << std::endl;
-    return false;
+    rebuildIndex();
+    std::cout << "成功加载 " << users.size() << " 个用户" << std::endl;
+    if (!intact) {
+        // 原文件改名保留，之后保存的新文件不会覆盖它
+        std::string backupName = SnapshotReader::preserveDamaged(filename);
+        std::cerr << "用户文件已损坏，" << (backupName.empty() ? "且无法改名保留原文件" : "原文件保留为 " + backupName)
+            << std::endl;
+    }
+    else if (migrated) {
+        std::cout << "用户余额已从浮点数换算为分，按新格式重写用户文件" << std::endl;
+        saveUsersToFile();
+    }
 }
 
-void UserManager::loadUsers() {
+bool UserManager::loadLegacyUsers() {
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
-        std::cout << "ûļڣļ: " << filename << std::endl;
-        return;
+        return false;
     }
 
-    users.clear();
-
     try {
         size_t userCount;
         file.read(reinterpret_cast<char*>(&userCount), sizeof(userCount));
+        if (file.fail()) {
+            throw std::runtime_error("读取用户数量失败");
+        }
 
         for (size_t i = 0; i < userCount; ++i) {
-            // ȶȡûȷҪû
+            // 先读取用户类型来确定要创建哪种用户
             int type;
             file.read(reinterpret_cast<char*>(&type), sizeof(type));
 
-            // ļָ
+            // 回退文件指针
             file.seekg(-static_cast<std::streamoff>(sizeof(type)), std::ios::cur);
 
             UserType userType = static_cast<UserType>(type);
 
-            // ʱûȡ
+            // 创建临时用户对象来读取数据
             std::unique_ptr<User> user(User::createUser("temp", "temp", userType));
-            if (user) {
-                user->deserialize(file);
-                users.push_back(std::move(user));
+            if (!user) {
+                throw std::runtime_error("未知的用户类型: " + std::to_string(type));
+            }
+            user->deserialize(file);
+            if (file.fail()) {
+                throw std::runtime_error("第 " + std::to_string(i + 1) + " 个用户记录不完整");
             }
+            users.push_back(std::move(user));
         }
-
-        std::cout << "ɹ " << users.size() << " û" << std::endl;
     }
     catch (const std::exception& e) {
-        std::cerr << "ûļʱ: " << e.what() << std::endl;
-        users.clear();
+        std::cerr << "加载用户文件时出错: " << e.what() << std::endl;
+        return false;
     }
 
-    file.close();
+    std::cout << "已读取旧格式用户文件，下次保存时转换为新格式" << std::endl;
+    return true;
 }
 
-void UserManager::saveUsers() {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "޷ûļд: " << filename << std::endl;
+void UserManager::replayLog() {
+    std::ifstream log(userLog.getFilename(), std::ios::binary);
+    if (!log.is_open()) {
         return;
     }
+    std::string content((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+    log.close();
+
+    const char* data = content.data();
+    const char* end = data + content.size();
+    auto readString = [&data, end](std::string& value) {
+        uint32_t length;
+        if (static_cast<size_t>(end - data) < sizeof(length)) {
+            throw std::runtime_error("记录不完整");
+        }
+        std::memcpy(&length, data, sizeof(length));
+        data += sizeof(length);
+        if (static_cast<size_t>(end - data) < length) {
+            throw std::runtime_error("记录不完整");
+        }
+        value.assign(data, length);
+        data += length;
+    };
+
+    size_t replayed = 0;
+    std::ptrdiff_t validEnd = -1;       // 残缺记录的起始位置，-1 表示日志完整
+    while (data != end) {
+        const char* recordStart = data;
+        try {
+            UserLogOp op = static_cast<UserLogOp>(*data++);
+            if (op == UserLogOp::REGISTER) {
+                std::unique_ptr<User> user(User::readRecord(data, end));
+                if (!findUser(user->getUsername())) {
+                    userIndex.emplace(user->getUsername(), users.size());
+                    users.push_back(std::move(user));
+                }
+            }
+            else if (op == UserLogOp::BALANCE || op == UserLogOp::PASSWORD) {
+                std::string username;
+                readString(username);
+                std::string password;
+                int64_t cents = 0;
+                if (op == UserLogOp::BALANCE) {
+                    if (static_cast<size_t>(end - data) < sizeof(cents)) {
+                        throw std::runtime_error("记录不完整");
+                    }
+                    std::memcpy(&cents, data, sizeof(cents));
+                    data += sizeof(cents);
+                }
+                else {
+                    readString(password);
+                }
+
+                User* user = findUser(username);
+                if (!user) {
+                    std::cerr << "日志引用了不存在的用户 " << username << "，跳过" << std::endl;
+                    continue;
+                }
+                if (op == UserLogOp::BALANCE) {
+                    user->setBalance(Money::fromCents(cents));
+                }
+                else {
+                    user->setPassword(password);
+                }
+            }
+            else {
+                throw std::runtime_error("未知的日志记录类型: " + std::to_string(static_cast<int>(op)));
+            }
+            replayed++;
+        }
+        catch (const std::exception& e) {
+            // 崩溃可能留下写了一半的记录，之后的内容一律丢弃
+            std::cerr << "回放用户日志时出错: " << e.what() << "，停止回放" << std::endl;
+            validEnd = recordStart - content.data();
+            break;
+        }
+    }
 
-    try {
-        size_t userCount = users.size();
-        file.write(reinterpret_cast<const char*>(&userCount), sizeof(userCount));
+    // 先截掉残缺尾部：即使没有回放任何记录或下面的合并失败，
+    // 之后追加的记录也不会落在无法解析的内容后面
+    if (validEnd >= 0 && userLog.truncateTo(static_cast<uint64_t>(validEnd))) {
+        std::cout << "用户日志已截断到最后一条完整记录 (" << validEnd << " 字节)" << std::endl;
+    }
 
-        for (const auto& user : users) {
-            user->serialize(file);
+    if (replayed > 0) {
+        std::cout << "已从用户日志回放 " << replayed << " 条记录" << std::endl;
+        // 立即合并，日志清空
+        if (saveUsersToFile()) {
+            userLog.reset();
+            userLog.close();
         }
+    }
+}
 
-        std::cout << "ɹ " << users.size() << " ûļ" << std::endl;
+void UserManager::notifyChangeRecorded() {
+    if (userLog.getRecordCount() >= COMPACTION_THRESHOLD) {
+        compactionCv.notify_one();
     }
-    catch (const std::exception& e) {
-        std::cerr << "ûļʱ: " << e.what() << std::endl;
+}
+
+void UserManager::compactionLoop() {
+    std::unique_lock<std::mutex> lock(compactionMutex);
+    while (!stopCompaction) {
+        compactionCv.wait_for(lock, std::chrono::seconds(COMPACTION_INTERVAL_SECONDS));
+        if (stopCompaction) {
+            break;
+        }
+        lock.unlock();
+        compactLog();
+        lock.lock();
+    }
+}
+
+void UserManager::compactLog(bool force) {
+    std::lock_guard<std::mutex> snapshotLock(snapshotMutex);
+
+    std::string records;
+    std::vector<size_t> recordEnds;
+    uint64_t logOffset = 0;
+    size_t logRecords = 0;
+    {
+        std::lock_guard<std::mutex> lock(usersMutex);
+        if (!force && userLog.getRecordCount() == 0) {
+            return;
+        }
+
+        // 持锁期间只复制记录并记下快照覆盖到的日志位置，写盘在锁外进行
+        copySnapshot(records, recordEnds);
+        logOffset = userLog.getSize();
+        logRecords = userLog.getRecordCount();
+    }
+
+    // 快照写入成功后才截掉已并入快照的日志，写快照期间追加的记录保留
+    if (writeSnapshot(records, recordEnds)) {
+        std::lock_guard<std::mutex> lock(usersMutex);
+        userLog.discardPrefix(logOffset, logRecords);
     }
+}
+
+void UserManager::saveUsers() {
+    compactLog(true);
+}
+
+bool UserManager::saveUsersToFile() {
+    std::string records;
+    std::vector<size_t> recordEnds;
+    copySnapshot(records, recordEnds);
+    return writeSnapshot(records, recordEnds);
+}
 
-    file.close();
-}
\ No newline at end of file
+void UserManager::copySnapshot(std::string& records, std::vector<size_t>& recordEnds) const {
+    recordEnds.reserve(users.size());
+    for (const auto& user : users) {
+        user->appendRecord(records);
+        recordEnds.push_back(records.size());
+    }
+}
+
+bool UserManager::writeSnapshot(const std::string& records, const std::vector<size_t>& recordEnds) {
+    // 写入临时文件，完成后整体替换原文件
+    SnapshotWriter writer(filename, "USER", USER_RECORD_VERSION, USERS_PER_BLOCK);
+    if (!writer.open()) {
+        return false;
+    }
+
+    size_t recordStart = 0;
+    for (size_t recordEnd : recordEnds) {
+        writer.putBytes(records.data() + recordStart, recordEnd - recordStart);
+        writer.endRecord();
+        recordStart = recordEnd;
+    }
+    if (!writer.commit()) {
+        std::cerr << "保存用户文件失败: " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "成功保存 " << recordEnds.size() << " 个用户到文件" << std::endl;
+    return true;
+}
@@ -2,10 +2,15 @@
 #define USER_MANAGER_H
 
 #include "user.h"
+#include "user_log.h"
 #include <vector>
+#include <unordered_map>
 #include <string>
 #include <mutex>
 #include <memory>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
 
 class UserManager {
 private:
@@ -13,9 +18,42 @@ private:
     std::string filename;
     std::mutex usersMutex;
 
+    // 用户名 -> users 下标，登录、注册和修改都按用户名直接定位，不再逐个比较
+    std::unordered_map<std::string, size_t> userIndex;
+
+    // 变更日志：注册、改余额、改密码只追加一条记录，由后台线程定期合并为快照
+    UserLog userLog;
+    std::thread compactionThread;
+    std::mutex compactionMutex;
+    std::condition_variable compactionCv;
+    bool stopCompaction;
+
+    // 串行化快照写入；写快照期间不持有usersMutex。锁顺序: snapshotMutex -> usersMutex
+    std::mutex snapshotMutex;
+
+    static const size_t COMPACTION_THRESHOLD = 1000;    // 日志记录数达到该值时立即合并
+    static const int COMPACTION_INTERVAL_SECONDS = 30;  // 定期合并间隔
+
+    // 用户文件为快照容器，旧格式（长度为 size_t 的裸二进制）只读不写。
+    // 第2版起余额为 int64 分，读到第1版（double 元）时换算后立即重写
+    static const uint32_t USER_RECORD_VERSION = 2;
+    static const uint32_t LEGACY_BALANCE_VERSION = 1;
+    static const uint32_t USERS_PER_BLOCK = 4096;
+
     void loadUsers();
+    bool loadLegacyUsers();     // 读取失败时返回false，已读出的用户保留
+    void replayLog();
+    bool saveUsersToFile();     // 复制并写出快照，仅在启动期间（没有其他线程）调用
+    void copySnapshot(std::string& records, std::vector<size_t>& recordEnds) const; // 调用方需持有usersMutex
+    bool writeSnapshot(const std::string& records, const std::vector<size_t>& recordEnds);
+    void compactionLoop();
+    void compactLog(bool force = false);    // force: 即使日志为空也写快照
+    void notifyChangeRecorded();
+    void rebuildIndex();        // 文件中用户名重复时保留第一个，与原先按顺序查找的结果一致
+    User* findUser(const std::string& username); // 调用方需持有usersMutex
 
 public:
+    // 写一次完整快照并清空日志
     void saveUsers();
     UserManager(const std::string& filename);
     ~UserManager();
@@ -24,6 +62,9 @@ public:
     User* authenticateUser(const std::string& username, const std::string& password);
     bool userExists(const std::string& username);
     bool updateUser(const User& user);
+    // 修改余额并追加一条日志记录（落盘后才返回），余额未变化时不写日志。
+    // 注册、改余额、改密码在日志写入失败时都返回false，内存中的用户不变
+    bool updateBalance(const std::string& username, Money newBalance);
     bool changePassword(const std::string& username, const std::string& oldPassword, const std::string& newPassword);
 };
 